@@ -4,7 +4,7 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
-C:/StellarisWare/boards/ek-lm3s8962/drivers/rit128x96x4.c 
+../drivers/rit128x96x4.c 
 
 OBJS += \
 ./drivers/rit128x96x4.obj 
@@ -19,6 +19,6 @@ OBJS__QUOTED += \
 "drivers\rit128x96x4.obj" 
 
 C_SRCS__QUOTED += \
-"C:/StellarisWare/boards/ek-lm3s8962/drivers/rit128x96x4.c" 
+"../drivers/rit128x96x4.c" 
 
 
@@ -7,26 +7,56 @@ CMD_SRCS += \
 ../hello_ccs.cmd 
 
 C_SRCS += \
+../hal_lm3s8962.c \
+../profile.c \
+../trace.c \
+../clock.c \
+../boot.c \
 ../pong.c \
 ../startup_ccs.c 
 
 OBJS += \
+./hal_lm3s8962.obj \
+./profile.obj \
+./trace.obj \
+./clock.obj \
+./boot.obj \
 ./pong.obj \
 ./startup_ccs.obj 
 
 C_DEPS += \
+./hal_lm3s8962.pp \
+./profile.pp \
+./trace.pp \
+./clock.pp \
+./boot.pp \
 ./pong.pp \
 ./startup_ccs.pp 
 
 C_DEPS__QUOTED += \
+"hal_lm3s8962.pp" \
+"profile.pp" \
+"trace.pp" \
+"clock.pp" \
+"boot.pp" \
 "pong.pp" \
 "startup_ccs.pp" 
 
 OBJS__QUOTED += \
+"hal_lm3s8962.obj" \
+"profile.obj" \
+"trace.obj" \
+"clock.obj" \
+"boot.obj" \
 "pong.obj" \
 "startup_ccs.obj" 
 
 C_SRCS__QUOTED += \
+"../hal_lm3s8962.c" \
+"../profile.c" \
+"../trace.c" \
+"../clock.c" \
+"../boot.c" \
 "../pong.c" \
 "../startup_ccs.c" 
 
@@ -0,0 +1,134 @@
+//*****************************************************************************
+//
+// boot.c - Timing of the boot, from reset to the first frame.
+//
+// Each point in the boot is stamped with the cycle counter and the processor
+// clock at the time.  The processor runs from the internal oscillator until
+// HalInit() switches to the PLL, so the clock changes part way through the
+// boot; each phase is converted to microseconds at the clock it started with.
+// The internal oscillator is only accurate to 30%, and HalInit() waits for the
+// PLL partly at one clock and partly at the other, so the times of the first
+// two phases are rough.  The cycles are exact.
+//
+// The report looks like:
+//
+//     boot: 14730us to the first frame
+//       c_int00            2310 cycles      192us      192us
+//       clock             16105 cycles     1342us     1534us
+//       ...
+//
+// with the cycles and the time of each phase, then the time since reset.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "boot.h"
+
+//*****************************************************************************
+//
+// The names of the phases that end at each mark.
+//
+//*****************************************************************************
+static const char * const g_ppcBootNames[BOOT_MARKS] =
+{
+    "c_int00",
+    "clock",
+    "display",
+    "setup",
+    "first tick",
+    "first frame"
+};
+
+//*****************************************************************************
+//
+// The cycle counter and the processor clock at each mark, and which marks
+// have been reached.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL unsigned long g_pulBootCycles[BOOT_MARKS];
+static HAL_THREAD_LOCAL unsigned long g_pulBootClock[BOOT_MARKS];
+static HAL_THREAD_LOCAL unsigned long g_ulBootMarked;
+
+//*****************************************************************************
+//
+// Records that the boot has reached a mark.  Only the first time that each
+// mark is reached is kept.
+//
+//*****************************************************************************
+void
+BootMark(unsigned long ulMark)
+{
+    if(g_ulBootMarked & (1 << ulMark))
+    {
+        return;
+    }
+
+    g_pulBootCycles[ulMark] = HalCycleCount();
+    g_pulBootClock[ulMark] = HalClockGet();
+    g_ulBootMarked |= 1 << ulMark;
+}
+
+//*****************************************************************************
+//
+// Returns true if the boot has reached a mark.
+//
+//*****************************************************************************
+tBoolean
+BootMarked(unsigned long ulMark)
+{
+    return((g_ulBootMarked & (1 << ulMark)) ? true : false);
+}
+
+//*****************************************************************************
+//
+// Prints the cycles and time taken by each phase of the boot, up to the last
+// mark that has been reached.
+//
+//*****************************************************************************
+void
+BootReport(tBootPrintf pfnPrintf)
+{
+    unsigned long ulMark, ulLast, ulCycles, ulClock, ulTime;
+    unsigned long pulTime[BOOT_MARKS];
+
+    //
+    // Work out the time of each mark since reset, in microseconds.  The
+    // phase up to BOOT_MAIN started at reset, at the clock that was still
+    // running when main() was entered.
+    //
+    ulLast = 0;
+    ulClock = g_pulBootClock[BOOT_MAIN];
+    ulTime = 0;
+    for(ulMark = 0; ulMark < BOOT_MARKS; ulMark++)
+    {
+        if(!BootMarked(ulMark))
+        {
+            break;
+        }
+
+        ulCycles = g_pulBootCycles[ulMark] - ulLast;
+        ulTime += ulCycles / (ulClock / 1000000);
+        pulTime[ulMark] = ulTime;
+
+        ulLast = g_pulBootCycles[ulMark];
+        ulClock = g_pulBootClock[ulMark];
+    }
+    if(ulMark == 0)
+    {
+        return;
+    }
+
+    pfnPrintf("boot: %uus to the %s\n", pulTime[ulMark - 1],
+              g_ppcBootNames[ulMark - 1]);
+
+    ulLast = 0;
+    for(ulMark = 0; (ulMark < BOOT_MARKS) && BootMarked(ulMark); ulMark++)
+    {
+        pfnPrintf("  %12s %10u cycles %8uus %8uus\n", g_ppcBootNames[ulMark],
+                  g_pulBootCycles[ulMark] - (ulMark ?
+                                             g_pulBootCycles[ulMark - 1] : 0),
+                  pulTime[ulMark] - ulLast, pulTime[ulMark]);
+        ulLast = pulTime[ulMark];
+    }
+}
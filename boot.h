@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// boot.h - Timing of the boot, from reset to the first frame.
+//
+//*****************************************************************************
+
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+//*****************************************************************************
+//
+// The points in the boot that are timed.  Each one ends the phase of the same
+// name, which started at the point before it.  Reset is at cycle 0, since the
+// cycle counter is started by ResetISR().
+//
+// * BOOT_MAIN: main() was entered, once _c_int00 had set up the C runtime.
+// * BOOT_CLOCK: HalInit() had set up the clock.
+// * BOOT_DISPLAY: HalDisplayInit() had set up the display.
+// * BOOT_START: the game was set up and the tick started.
+// * BOOT_FIRST_TICK: the first tick began.
+// * BOOT_FIRST_FRAME: the first frame had been sent to the display.
+//
+//*****************************************************************************
+#define BOOT_MAIN               0
+#define BOOT_CLOCK              1
+#define BOOT_DISPLAY            2
+#define BOOT_START              3
+#define BOOT_FIRST_TICK         4
+#define BOOT_FIRST_FRAME        5
+#define BOOT_MARKS              6
+
+//*****************************************************************************
+//
+// The function that the report is printed with, such as UARTprintf().  Only
+// the %s and %u conversions are used, and they are passed unsigned long
+// values.
+//
+//*****************************************************************************
+typedef void (*tBootPrintf)(const char *pcFormat, ...);
+
+//*****************************************************************************
+//
+// Prototypes for the boot timing.
+//
+//*****************************************************************************
+extern void BootMark(unsigned long ulMark);
+extern tBoolean BootMarked(unsigned long ulMark);
+extern void BootReport(tBootPrintf pfnPrintf);
+
+#endif // __BOOT_H__
@@ -0,0 +1,178 @@
+//*****************************************************************************
+//
+// clock.c - Processor clock policy for the game's phases.
+//
+// The game only needs the 50MHz PLL clock while a match is being played.  The
+// countdown between points and the result at the end of a match draw very
+// little, so they can run from the crystal with the PLL turned off, which
+// draws much less current.  The game tells the policy which phase it is in on
+// every tick, and the policy picks the clock level for that phase.
+//
+// The switch itself is made from the main loop by ClockPolicyApply(), since it
+// has to wait for the display and UART to finish sending at the old clock.
+// HalClockLevelSet() works out the SysTick period and the SSI and UART
+// dividers again for the new clock, so the ticks and the UART keep their
+// rates, and the display runs as fast as the new clock allows.
+//
+// The policy counts the ticks spent at each clock level.  Ticks are always a
+// fixed time apart, so this is the time spent at each level, apart from deep
+// sleep, where the tick is stopped.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "clock.h"
+#include "trace.h"
+
+//*****************************************************************************
+//
+// The current drawn at each clock level, in tenths of a milliamp.
+//
+//*****************************************************************************
+static const unsigned long g_pulClockCurrent[HAL_CLOCK_LEVELS] =
+{
+    CLOCK_CURRENT_FULL,
+    CLOCK_CURRENT_LOW,
+    CLOCK_CURRENT_MIN
+};
+
+//*****************************************************************************
+//
+// The clock level for each phase of the game.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL const unsigned long *g_pulClockPhaseLevels;
+static HAL_THREAD_LOCAL unsigned long g_ulClockPhases;
+
+//*****************************************************************************
+//
+// The clock level that the processor is running at, and the one that the
+// current phase of the game wants.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL volatile unsigned long g_ulClockLevel;
+static HAL_THREAD_LOCAL volatile unsigned long g_ulClockWanted;
+
+//*****************************************************************************
+//
+// The number of ticks spent at each clock level, and the number of times that
+// the clock has been switched.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL volatile unsigned long g_pulClockTicks[HAL_CLOCK_LEVELS];
+static HAL_THREAD_LOCAL unsigned long g_ulClockSwitches;
+
+//*****************************************************************************
+//
+// Starts the policy.  pulPhaseLevels holds the clock level for each of the
+// game's phases, 0 to ulPhases - 1.  The processor is running at
+// HAL_CLOCK_FULL, which HalInit() sets up.
+//
+//*****************************************************************************
+void
+ClockPolicyInit(const unsigned long *pulPhaseLevels, unsigned long ulPhases)
+{
+    unsigned long ulLevel;
+
+    g_pulClockPhaseLevels = pulPhaseLevels;
+    g_ulClockPhases = ulPhases;
+
+    g_ulClockLevel = HAL_CLOCK_FULL;
+    g_ulClockWanted = HAL_CLOCK_FULL;
+
+    for(ulLevel = 0; ulLevel < HAL_CLOCK_LEVELS; ulLevel++)
+    {
+        g_pulClockTicks[ulLevel] = 0;
+    }
+    g_ulClockSwitches = 0;
+}
+
+//*****************************************************************************
+//
+// Counts a tick at the current clock level, and records the level that the
+// game's phase wants for the ticks after it.  It is called from the SysTick
+// handler.
+//
+//*****************************************************************************
+void
+ClockPolicyTick(unsigned long ulPhase)
+{
+    g_pulClockTicks[g_ulClockLevel]++;
+
+    if(ulPhase < g_ulClockPhases)
+    {
+        g_ulClockWanted = g_pulClockPhaseLevels[ulPhase];
+    }
+}
+
+//*****************************************************************************
+//
+// Switches the clock to the level that the game's phase wants, if it is not
+// already running at it.  Returns true if the clock was switched, in which
+// case the cycle counter now counts at a different rate.
+//
+// This must only be called from the main loop, with interrupts turned off so
+// that the caller can catch up with the new clock before the next tick.
+//
+//*****************************************************************************
+tBoolean
+ClockPolicyApply(void)
+{
+    unsigned long ulLevel;
+
+    ulLevel = g_ulClockWanted;
+    if(ulLevel == g_ulClockLevel)
+    {
+        return(false);
+    }
+
+    HalClockLevelSet(ulLevel);
+    g_ulClockLevel = ulLevel;
+    g_ulClockSwitches++;
+
+    TraceEvent(TRACE_CLOCK, ulLevel, HalClockGet() / 1000);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Prints the time spent at each clock level, with the current drawn there,
+// and the average current over all of them.  The currents are marked as
+// estimates unless they were given when the game was built.
+//
+//*****************************************************************************
+void
+ClockPolicyReport(tClockPrintf pfnPrintf)
+{
+    unsigned long ulLevel, ulTicks, ulTotal, ulCharge;
+
+    ulTotal = 0;
+    ulCharge = 0;
+    for(ulLevel = 0; ulLevel < HAL_CLOCK_LEVELS; ulLevel++)
+    {
+        ulTotal += g_pulClockTicks[ulLevel];
+        ulCharge += g_pulClockTicks[ulLevel] * g_pulClockCurrent[ulLevel];
+    }
+    if(ulTotal == 0)
+    {
+        return;
+    }
+
+    for(ulLevel = 0; ulLevel < HAL_CLOCK_LEVELS; ulLevel++)
+    {
+        ulTicks = g_pulClockTicks[ulLevel];
+        pfnPrintf("clock %uMHz: %u ticks (%u.%u%%) at %u.%u"
+                  CLOCK_CURRENT_UNITS "\n",
+                  HalClockLevelRate(ulLevel) / 1000000, ulTicks,
+                  (ulTicks * 1000 / ulTotal) / 10,
+                  (ulTicks * 1000 / ulTotal) % 10,
+                  g_pulClockCurrent[ulLevel] / 10,
+                  g_pulClockCurrent[ulLevel] % 10);
+    }
+
+    pfnPrintf("clock: %u switches, %u.%u" CLOCK_CURRENT_UNITS " average\n",
+              g_ulClockSwitches,
+              (ulCharge / ulTotal) / 10, (ulCharge / ulTotal) % 10);
+}
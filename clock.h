@@ -0,0 +1,55 @@
+//*****************************************************************************
+//
+// clock.h - Processor clock policy for the game's phases.
+//
+//*****************************************************************************
+
+#ifndef __CLOCK_H__
+#define __CLOCK_H__
+
+//*****************************************************************************
+//
+// The supply current drawn at each clock level, in tenths of a milliamp, which
+// the report works out the average current from.  The board has no way to
+// measure its own current, so these are rough figures for the LM3S8962 with
+// the peripherals that the game uses; define them on the command line with
+// readings taken with a meter in series with the board's supply.  Unless all
+// three are given, the report marks the currents as estimates.
+//
+//*****************************************************************************
+#if defined(CLOCK_CURRENT_FULL) && defined(CLOCK_CURRENT_LOW) &&             \
+    defined(CLOCK_CURRENT_MIN)
+#define CLOCK_CURRENT_UNITS     "mA"
+#else
+#define CLOCK_CURRENT_UNITS     "mA est."
+#endif
+#ifndef CLOCK_CURRENT_FULL
+#define CLOCK_CURRENT_FULL      600
+#endif
+#ifndef CLOCK_CURRENT_LOW
+#define CLOCK_CURRENT_LOW       180
+#endif
+#ifndef CLOCK_CURRENT_MIN
+#define CLOCK_CURRENT_MIN       100
+#endif
+
+//*****************************************************************************
+//
+// The function that the report is printed with, such as UARTprintf().  Only
+// the %u conversion is used, and it is passed unsigned long values.
+//
+//*****************************************************************************
+typedef void (*tClockPrintf)(const char *pcFormat, ...);
+
+//*****************************************************************************
+//
+// Prototypes for the clock policy.
+//
+//*****************************************************************************
+extern void ClockPolicyInit(const unsigned long *pulPhaseLevels,
+                            unsigned long ulPhases);
+extern void ClockPolicyTick(unsigned long ulPhase);
+extern tBoolean ClockPolicyApply(void);
+extern void ClockPolicyReport(tClockPrintf pfnPrintf);
+
+#endif // __CLOCK_H__
@@ -29,12 +29,14 @@
 //
 //*****************************************************************************
 
+#include "inc/hw_ints.h"
 #include "inc/hw_ssi.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_sysctl.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/ssi.h"
 #include "driverlib/sysctl.h"
 #include "drivers/rit128x96x4.h"
@@ -58,6 +60,8 @@
 static volatile unsigned long g_ulSSIFlags;
 #define FLAG_SSI_ENABLED        0
 #define FLAG_DC_HIGH            1
+#define FLAG_WINDOW_VALID       2
+#define FLAG_REMAP_VALID        3
 
 //*****************************************************************************
 //
@@ -66,6 +70,150 @@ static volatile unsigned long g_ulSSIFlags;
 //*****************************************************************************
 static unsigned char g_pucBuffer[8];
 
+//*****************************************************************************
+//
+// The queue of bytes waiting to be sent to the display.  Each entry holds one
+// byte in the lower eight bits, and has RIT_QUEUE_DATA set if it is a data
+// byte (D/C high) rather than a command byte.  An entry with RIT_QUEUE_REPEAT
+// set is followed by an entry that holds the number of times its byte is
+// still to be sent, so that a long run of the same byte, such as clearing the
+// display, only takes two entries.  Bytes are added at the head by the drawing
+// functions and removed from the tail by the SSI interrupt handler.  The size
+// must be a power of two.
+//
+//*****************************************************************************
+#define RIT_QUEUE_SIZE          1024
+#define RIT_QUEUE_DATA          0x100
+#define RIT_QUEUE_REPEAT        0x200
+#define RIT_QUEUE_REPEAT_MAX    0xffff
+static unsigned short g_pusQueue[RIT_QUEUE_SIZE];
+static volatile unsigned long g_ulQueueHead;
+static volatile unsigned long g_ulQueueTail;
+
+//*****************************************************************************
+//
+// The SSI clock that the display is being sent to at.
+//
+//*****************************************************************************
+static unsigned long g_ulSSIClock;
+
+//*****************************************************************************
+//
+// A mirror of the addressing state of the SSD1329: the column and row window
+// and the remap setting that were last sent, and the number of data bytes
+// written into the window since then (modulo the size of the window).  While
+// the address pointer is known to be back at the start of the window, window
+// and remap commands that would not change anything are not sent.  The window
+// and remap parts of the mirror are only used while FLAG_WINDOW_VALID and
+// FLAG_REMAP_VALID are set, respectively.
+//
+//*****************************************************************************
+static unsigned char g_pucWindow[4];
+static unsigned char g_ucRemap;
+static unsigned long g_ulWindowSize = 1;
+static unsigned long g_ulWindowOffset;
+
+//*****************************************************************************
+//
+// The number of window and remap commands that have been sent to the display,
+// and the number that were skipped because of the mirror above.
+//
+//*****************************************************************************
+static unsigned long g_ulCommandsSent;
+static unsigned long g_ulCommandsSkipped;
+
+//*****************************************************************************
+//
+// SSI bus accounting.  The bytes and commands are counted as they are queued,
+// and the D/C toggles and SSIBusy() spins as they happen, into the current
+// frame and the current section of the frame.  RIT128x96x4BusFrameEnd() folds
+// the frame into the peaks and totals, and starts a new frame.
+//
+//*****************************************************************************
+static const tRITBusStats g_sBusZero;
+static tRITBusStats g_sBusFrame;
+static tRITBusStats g_sBusLast;
+static tRITBusStats g_sBusPeak;
+static tRITBusStats g_sBusTotal;
+static unsigned long g_ulBusFrames;
+
+static struct
+{
+    const char *pcName;
+    tRITBusStats sFrame;
+    tRITBusStats sPeak;
+    tRITBusStats sTotal;
+}
+g_psBusSection[RIT_BUS_SECTIONS];
+
+static unsigned long g_ulBusSection;
+
+#define RIT_BUS_COUNT(field, ulCount)                                         \
+    do                                                                        \
+    {                                                                         \
+        g_sBusFrame.field += (ulCount);                                       \
+        g_psBusSection[g_ulBusSection].sFrame.field += (ulCount);             \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// A local copy of the visible portion of the display RAM.  Each byte holds two
+// pixels, with the leftmost pixel in bits 7:4, and the rows are laid out the
+// same way the SSD1329 is filled in horizontal increment mode.  The drawing
+// functions only update this copy; RIT128x96x4Flush() sends the bytes that
+// have changed to the display.
+//
+//*****************************************************************************
+static unsigned char g_pucFrame[96][64];
+
+//*****************************************************************************
+//
+// A copy of what was last sent to the display RAM.  The game tends to erase
+// an object and then draw it again in the same place, so a byte that was
+// written during a frame may well end up with the value the display already
+// holds.  Comparing against this copy when flushing keeps those bytes off the
+// SSI bus.
+//
+//*****************************************************************************
+static unsigned char g_pucPanel[96][64];
+
+//*****************************************************************************
+//
+// The range of byte columns in each row of the frame buffer that have been
+// written since the last flush.  The end column is exclusive, so a row with an
+// end of zero is clean.
+//
+//*****************************************************************************
+static unsigned char g_pucDirtyStart[96];
+static unsigned char g_pucDirtyEnd[96];
+
+//*****************************************************************************
+//
+// A row of blank pixels, used to erase the parts of a sprite's old position
+// that its new position does not cover.
+//
+//*****************************************************************************
+static const unsigned char g_pucBlank[64];
+
+//*****************************************************************************
+//
+// Get the value of one pixel from a row of image data that is packed two
+// pixels to a byte, with the leftmost pixel in bits 7:4.
+//
+//*****************************************************************************
+#define RIT_PIXEL(pucData, ulPixel)                                           \
+    (((pucData)[(ulPixel) / 2] >> (((ulPixel) & 1) ? 0 : 4)) & 0x0f)
+
+//*****************************************************************************
+//
+// The number of bytes needed to set up a window and address increment mode on
+// the SSD1329.  When flushing, adjacent dirty rows are merged into a single
+// window as long as the unchanged bytes that get resent cost less than this.
+//
+//*****************************************************************************
+#define RIT_WINDOW_COST         8
+
 //*****************************************************************************
 //
 // Define the SSD1329 128x96x4 Remap Setting(s).  This will be used in
@@ -98,7 +246,6 @@ static unsigned char g_pucBuffer[8];
 //*****************************************************************************
 #define RIT_INIT_REMAP      0x52 // app note says 0x51
 #define RIT_INIT_OFFSET     0x00
-static const unsigned char g_pucRIT128x96x4VerticalInc[]   = { 0xA0, 0x56 };
 static const unsigned char g_pucRIT128x96x4HorizontalInc[] = { 0xA0, 0x52 };
 
 //*****************************************************************************
@@ -112,105 +259,160 @@ static const unsigned char g_pucRIT128x96x4HorizontalInc[] = { 0xA0, 0x52 };
 // osram96x16x1 driver.  The single bit-per-pixel is expaned in the StringDraw
 // function to the appropriate four bit-per-pixel gray scale format.
 //
+// The font is written as a list of invocations of a macro that is given the
+// five columns of each character, so that the same data can build both the
+// table below and the pre-expanded tables that follow it.
+//
 //*****************************************************************************
+#define RIT_FONT(CHAR)                                                        \
+    CHAR(0x00, 0x00, 0x00, 0x00, 0x00) /* " " */                              \
+    CHAR(0x00, 0x00, 0x4f, 0x00, 0x00) /* ! */                                \
+    CHAR(0x00, 0x07, 0x00, 0x07, 0x00) /* " */                                \
+    CHAR(0x14, 0x7f, 0x14, 0x7f, 0x14) /* # */                                \
+    CHAR(0x24, 0x2a, 0x7f, 0x2a, 0x12) /* $ */                                \
+    CHAR(0x23, 0x13, 0x08, 0x64, 0x62) /* % */                                \
+    CHAR(0x36, 0x49, 0x55, 0x22, 0x50) /* & */                                \
+    CHAR(0x00, 0x05, 0x03, 0x00, 0x00) /* ' */                                \
+    CHAR(0x00, 0x1c, 0x22, 0x41, 0x00) /* ( */                                \
+    CHAR(0x00, 0x41, 0x22, 0x1c, 0x00) /* ) */                                \
+    CHAR(0x14, 0x08, 0x3e, 0x08, 0x14) /* * */                                \
+    CHAR(0x08, 0x08, 0x3e, 0x08, 0x08) /* + */                                \
+    CHAR(0x00, 0x50, 0x30, 0x00, 0x00) /* , */                                \
+    CHAR(0x08, 0x08, 0x08, 0x08, 0x08) /* - */                                \
+    CHAR(0x00, 0x60, 0x60, 0x00, 0x00) /* . */                                \
+    CHAR(0x20, 0x10, 0x08, 0x04, 0x02) /* / */                                \
+    CHAR(0x3e, 0x51, 0x49, 0x45, 0x3e) /* 0 */                                \
+    CHAR(0x00, 0x42, 0x7f, 0x40, 0x00) /* 1 */                                \
+    CHAR(0x42, 0x61, 0x51, 0x49, 0x46) /* 2 */                                \
+    CHAR(0x21, 0x41, 0x45, 0x4b, 0x31) /* 3 */                                \
+    CHAR(0x18, 0x14, 0x12, 0x7f, 0x10) /* 4 */                                \
+    CHAR(0x27, 0x45, 0x45, 0x45, 0x39) /* 5 */                                \
+    CHAR(0x3c, 0x4a, 0x49, 0x49, 0x30) /* 6 */                                \
+    CHAR(0x01, 0x71, 0x09, 0x05, 0x03) /* 7 */                                \
+    CHAR(0x36, 0x49, 0x49, 0x49, 0x36) /* 8 */                                \
+    CHAR(0x06, 0x49, 0x49, 0x29, 0x1e) /* 9 */                                \
+    CHAR(0x00, 0x36, 0x36, 0x00, 0x00) /* : */                                \
+    CHAR(0x00, 0x56, 0x36, 0x00, 0x00) /* ; */                                \
+    CHAR(0x08, 0x14, 0x22, 0x41, 0x00) /* < */                                \
+    CHAR(0x14, 0x14, 0x14, 0x14, 0x14) /* = */                                \
+    CHAR(0x00, 0x41, 0x22, 0x14, 0x08) /* > */                                \
+    CHAR(0x02, 0x01, 0x51, 0x09, 0x06) /* ? */                                \
+    CHAR(0x32, 0x49, 0x79, 0x41, 0x3e) /* @ */                                \
+    CHAR(0x7e, 0x11, 0x11, 0x11, 0x7e) /* A */                                \
+    CHAR(0x7f, 0x49, 0x49, 0x49, 0x36) /* B */                                \
+    CHAR(0x3e, 0x41, 0x41, 0x41, 0x22) /* C */                                \
+    CHAR(0x7f, 0x41, 0x41, 0x22, 0x1c) /* D */                                \
+    CHAR(0x7f, 0x49, 0x49, 0x49, 0x41) /* E */                                \
+    CHAR(0x7f, 0x09, 0x09, 0x09, 0x01) /* F */                                \
+    CHAR(0x3e, 0x41, 0x49, 0x49, 0x7a) /* G */                                \
+    CHAR(0x7f, 0x08, 0x08, 0x08, 0x7f) /* H */                                \
+    CHAR(0x00, 0x41, 0x7f, 0x41, 0x00) /* I */                                \
+    CHAR(0x20, 0x40, 0x41, 0x3f, 0x01) /* J */                                \
+    CHAR(0x7f, 0x08, 0x14, 0x22, 0x41) /* K */                                \
+    CHAR(0x7f, 0x40, 0x40, 0x40, 0x40) /* L */                                \
+    CHAR(0x7f, 0x02, 0x0c, 0x02, 0x7f) /* M */                                \
+    CHAR(0x7f, 0x04, 0x08, 0x10, 0x7f) /* N */                                \
+    CHAR(0x3e, 0x41, 0x41, 0x41, 0x3e) /* O */                                \
+    CHAR(0x7f, 0x09, 0x09, 0x09, 0x06) /* P */                                \
+    CHAR(0x3e, 0x41, 0x51, 0x21, 0x5e) /* Q */                                \
+    CHAR(0x7f, 0x09, 0x19, 0x29, 0x46) /* R */                                \
+    CHAR(0x46, 0x49, 0x49, 0x49, 0x31) /* S */                                \
+    CHAR(0x01, 0x01, 0x7f, 0x01, 0x01) /* T */                                \
+    CHAR(0x3f, 0x40, 0x40, 0x40, 0x3f) /* U */                                \
+    CHAR(0x1f, 0x20, 0x40, 0x20, 0x1f) /* V */                                \
+    CHAR(0x3f, 0x40, 0x38, 0x40, 0x3f) /* W */                                \
+    CHAR(0x63, 0x14, 0x08, 0x14, 0x63) /* X */                                \
+    CHAR(0x07, 0x08, 0x70, 0x08, 0x07) /* Y */                                \
+    CHAR(0x61, 0x51, 0x49, 0x45, 0x43) /* Z */                                \
+    CHAR(0x00, 0x7f, 0x41, 0x41, 0x00) /* [ */                                \
+    CHAR(0x02, 0x04, 0x08, 0x10, 0x20) /* "\" */                              \
+    CHAR(0x00, 0x41, 0x41, 0x7f, 0x00) /* ] */                                \
+    CHAR(0x04, 0x02, 0x01, 0x02, 0x04) /* ^ */                                \
+    CHAR(0x40, 0x40, 0x40, 0x40, 0x40) /* _ */                                \
+    CHAR(0x00, 0x01, 0x02, 0x04, 0x00) /* ` */                                \
+    CHAR(0x20, 0x54, 0x54, 0x54, 0x78) /* a */                                \
+    CHAR(0x7f, 0x48, 0x44, 0x44, 0x38) /* b */                                \
+    CHAR(0x38, 0x44, 0x44, 0x44, 0x20) /* c */                                \
+    CHAR(0x38, 0x44, 0x44, 0x48, 0x7f) /* d */                                \
+    CHAR(0x38, 0x54, 0x54, 0x54, 0x18) /* e */                                \
+    CHAR(0x08, 0x7e, 0x09, 0x01, 0x02) /* f */                                \
+    CHAR(0x0c, 0x52, 0x52, 0x52, 0x3e) /* g */                                \
+    CHAR(0x7f, 0x08, 0x04, 0x04, 0x78) /* h */                                \
+    CHAR(0x00, 0x44, 0x7d, 0x40, 0x00) /* i */                                \
+    CHAR(0x20, 0x40, 0x44, 0x3d, 0x00) /* j */                                \
+    CHAR(0x7f, 0x10, 0x28, 0x44, 0x00) /* k */                                \
+    CHAR(0x00, 0x41, 0x7f, 0x40, 0x00) /* l */                                \
+    CHAR(0x7c, 0x04, 0x18, 0x04, 0x78) /* m */                                \
+    CHAR(0x7c, 0x08, 0x04, 0x04, 0x78) /* n */                                \
+    CHAR(0x38, 0x44, 0x44, 0x44, 0x38) /* o */                                \
+    CHAR(0x7c, 0x14, 0x14, 0x14, 0x08) /* p */                                \
+    CHAR(0x08, 0x14, 0x14, 0x18, 0x7c) /* q */                                \
+    CHAR(0x7c, 0x08, 0x04, 0x04, 0x08) /* r */                                \
+    CHAR(0x48, 0x54, 0x54, 0x54, 0x20) /* s */                                \
+    CHAR(0x04, 0x3f, 0x44, 0x40, 0x20) /* t */                                \
+    CHAR(0x3c, 0x40, 0x40, 0x20, 0x7c) /* u */                                \
+    CHAR(0x1c, 0x20, 0x40, 0x20, 0x1c) /* v */                                \
+    CHAR(0x3c, 0x40, 0x30, 0x40, 0x3c) /* w */                                \
+    CHAR(0x44, 0x28, 0x10, 0x28, 0x44) /* x */                                \
+    CHAR(0x0c, 0x50, 0x50, 0x50, 0x3c) /* y */                                \
+    CHAR(0x44, 0x64, 0x54, 0x4c, 0x44) /* z */                                \
+    CHAR(0x00, 0x08, 0x36, 0x41, 0x00) /* { */                                \
+    CHAR(0x00, 0x00, 0x7f, 0x00, 0x00) /* | */                                \
+    CHAR(0x00, 0x41, 0x36, 0x08, 0x00) /* } */                                \
+    CHAR(0x02, 0x01, 0x02, 0x04, 0x02) /* ~ */                                \
+    CHAR(0x00, 0x00, 0x00, 0x00, 0x00)
+
+#define RIT_FONT_COLUMNS(c0, c1, c2, c3, c4)                                  \
+    { c0, c1, c2, c3, c4 },
+
 static const unsigned char g_pucFont[96][5] =
 {
-    { 0x00, 0x00, 0x00, 0x00, 0x00 }, // " "
-    { 0x00, 0x00, 0x4f, 0x00, 0x00 }, // !
-    { 0x00, 0x07, 0x00, 0x07, 0x00 }, // "
-    { 0x14, 0x7f, 0x14, 0x7f, 0x14 }, // #
-    { 0x24, 0x2a, 0x7f, 0x2a, 0x12 }, // $
-    { 0x23, 0x13, 0x08, 0x64, 0x62 }, // %
-    { 0x36, 0x49, 0x55, 0x22, 0x50 }, // &
-    { 0x00, 0x05, 0x03, 0x00, 0x00 }, // '
-    { 0x00, 0x1c, 0x22, 0x41, 0x00 }, // (
-    { 0x00, 0x41, 0x22, 0x1c, 0x00 }, // )
-    { 0x14, 0x08, 0x3e, 0x08, 0x14 }, // *
-    { 0x08, 0x08, 0x3e, 0x08, 0x08 }, // +
-    { 0x00, 0x50, 0x30, 0x00, 0x00 }, // ,
-    { 0x08, 0x08, 0x08, 0x08, 0x08 }, // -
-    { 0x00, 0x60, 0x60, 0x00, 0x00 }, // .
-    { 0x20, 0x10, 0x08, 0x04, 0x02 }, // /
-    { 0x3e, 0x51, 0x49, 0x45, 0x3e }, // 0
-    { 0x00, 0x42, 0x7f, 0x40, 0x00 }, // 1
-    { 0x42, 0x61, 0x51, 0x49, 0x46 }, // 2
-    { 0x21, 0x41, 0x45, 0x4b, 0x31 }, // 3
-    { 0x18, 0x14, 0x12, 0x7f, 0x10 }, // 4
-    { 0x27, 0x45, 0x45, 0x45, 0x39 }, // 5
-    { 0x3c, 0x4a, 0x49, 0x49, 0x30 }, // 6
-    { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 7
-    { 0x36, 0x49, 0x49, 0x49, 0x36 }, // 8
-    { 0x06, 0x49, 0x49, 0x29, 0x1e }, // 9
-    { 0x00, 0x36, 0x36, 0x00, 0x00 }, // :
-    { 0x00, 0x56, 0x36, 0x00, 0x00 }, // ;
-    { 0x08, 0x14, 0x22, 0x41, 0x00 }, // <
-    { 0x14, 0x14, 0x14, 0x14, 0x14 }, // =
-    { 0x00, 0x41, 0x22, 0x14, 0x08 }, // >
-    { 0x02, 0x01, 0x51, 0x09, 0x06 }, // ?
-    { 0x32, 0x49, 0x79, 0x41, 0x3e }, // @
-    { 0x7e, 0x11, 0x11, 0x11, 0x7e }, // A
-    { 0x7f, 0x49, 0x49, 0x49, 0x36 }, // B
-    { 0x3e, 0x41, 0x41, 0x41, 0x22 }, // C
-    { 0x7f, 0x41, 0x41, 0x22, 0x1c }, // D
-    { 0x7f, 0x49, 0x49, 0x49, 0x41 }, // E
-    { 0x7f, 0x09, 0x09, 0x09, 0x01 }, // F
-    { 0x3e, 0x41, 0x49, 0x49, 0x7a }, // G
-    { 0x7f, 0x08, 0x08, 0x08, 0x7f }, // H
-    { 0x00, 0x41, 0x7f, 0x41, 0x00 }, // I
-    { 0x20, 0x40, 0x41, 0x3f, 0x01 }, // J
-    { 0x7f, 0x08, 0x14, 0x22, 0x41 }, // K
-    { 0x7f, 0x40, 0x40, 0x40, 0x40 }, // L
-    { 0x7f, 0x02, 0x0c, 0x02, 0x7f }, // M
-    { 0x7f, 0x04, 0x08, 0x10, 0x7f }, // N
-    { 0x3e, 0x41, 0x41, 0x41, 0x3e }, // O
-    { 0x7f, 0x09, 0x09, 0x09, 0x06 }, // P
-    { 0x3e, 0x41, 0x51, 0x21, 0x5e }, // Q
-    { 0x7f, 0x09, 0x19, 0x29, 0x46 }, // R
-    { 0x46, 0x49, 0x49, 0x49, 0x31 }, // S
-    { 0x01, 0x01, 0x7f, 0x01, 0x01 }, // T
-    { 0x3f, 0x40, 0x40, 0x40, 0x3f }, // U
-    { 0x1f, 0x20, 0x40, 0x20, 0x1f }, // V
-    { 0x3f, 0x40, 0x38, 0x40, 0x3f }, // W
-    { 0x63, 0x14, 0x08, 0x14, 0x63 }, // X
-    { 0x07, 0x08, 0x70, 0x08, 0x07 }, // Y
-    { 0x61, 0x51, 0x49, 0x45, 0x43 }, // Z
-    { 0x00, 0x7f, 0x41, 0x41, 0x00 }, // [
-    { 0x02, 0x04, 0x08, 0x10, 0x20 }, // "\"
-    { 0x00, 0x41, 0x41, 0x7f, 0x00 }, // ]
-    { 0x04, 0x02, 0x01, 0x02, 0x04 }, // ^
-    { 0x40, 0x40, 0x40, 0x40, 0x40 }, // _
-    { 0x00, 0x01, 0x02, 0x04, 0x00 }, // `
-    { 0x20, 0x54, 0x54, 0x54, 0x78 }, // a
-    { 0x7f, 0x48, 0x44, 0x44, 0x38 }, // b
-    { 0x38, 0x44, 0x44, 0x44, 0x20 }, // c
-    { 0x38, 0x44, 0x44, 0x48, 0x7f }, // d
-    { 0x38, 0x54, 0x54, 0x54, 0x18 }, // e
-    { 0x08, 0x7e, 0x09, 0x01, 0x02 }, // f
-    { 0x0c, 0x52, 0x52, 0x52, 0x3e }, // g
-    { 0x7f, 0x08, 0x04, 0x04, 0x78 }, // h
-    { 0x00, 0x44, 0x7d, 0x40, 0x00 }, // i
-    { 0x20, 0x40, 0x44, 0x3d, 0x00 }, // j
-    { 0x7f, 0x10, 0x28, 0x44, 0x00 }, // k
-    { 0x00, 0x41, 0x7f, 0x40, 0x00 }, // l
-    { 0x7c, 0x04, 0x18, 0x04, 0x78 }, // m
-    { 0x7c, 0x08, 0x04, 0x04, 0x78 }, // n
-    { 0x38, 0x44, 0x44, 0x44, 0x38 }, // o
-    { 0x7c, 0x14, 0x14, 0x14, 0x08 }, // p
-    { 0x08, 0x14, 0x14, 0x18, 0x7c }, // q
-    { 0x7c, 0x08, 0x04, 0x04, 0x08 }, // r
-    { 0x48, 0x54, 0x54, 0x54, 0x20 }, // s
-    { 0x04, 0x3f, 0x44, 0x40, 0x20 }, // t
-    { 0x3c, 0x40, 0x40, 0x20, 0x7c }, // u
-    { 0x1c, 0x20, 0x40, 0x20, 0x1c }, // v
-    { 0x3c, 0x40, 0x30, 0x40, 0x3c }, // w
-    { 0x44, 0x28, 0x10, 0x28, 0x44 }, // x
-    { 0x0c, 0x50, 0x50, 0x50, 0x3c }, // y
-    { 0x44, 0x64, 0x54, 0x4c, 0x44 }, // z
-    { 0x00, 0x08, 0x36, 0x41, 0x00 }, // {
-    { 0x00, 0x00, 0x7f, 0x00, 0x00 }, // |
-    { 0x00, 0x41, 0x36, 0x08, 0x00 }, // }
-    { 0x02, 0x01, 0x02, 0x04, 0x02 }, // ~
-    { 0x00, 0x00, 0x00, 0x00, 0x00 }
+    RIT_FONT(RIT_FONT_COLUMNS)
+};
+
+//*****************************************************************************
+//
+// The font expanded to four bits per pixel for the gray levels used by the
+// game, so that drawing a string at one of these levels copies bytes instead
+// of converting the font bit by bit.  Each character is stored as 8 rows of 3
+// bytes, in the same layout as the frame buffer.  The compiler builds these
+// tables from the font above.
+//
+//*****************************************************************************
+#define RIT_GLYPH_BYTE(ucLeft, ucRight, ulRow, ucLevel)                       \
+    (((((ucLeft) >> (ulRow)) & 1) ? ((ucLevel) << 4) : 0) |                   \
+     ((((ucRight) >> (ulRow)) & 1) ? (ucLevel) : 0))
+
+#define RIT_GLYPH_ROW(c0, c1, c2, c3, c4, ulRow, ucLevel)                    \
+    RIT_GLYPH_BYTE(c0, c1, ulRow, ucLevel),                                   \
+    RIT_GLYPH_BYTE(c2, c3, ulRow, ucLevel),                                   \
+    RIT_GLYPH_BYTE(c4, 0, ulRow, ucLevel)
+
+#define RIT_GLYPH(c0, c1, c2, c3, c4, ucLevel)                                \
+    {                                                                         \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 0, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 1, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 2, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 3, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 4, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 5, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 6, ucLevel),                        \
+        RIT_GLYPH_ROW(c0, c1, c2, c3, c4, 7, ucLevel)                         \
+    },
+
+#define RIT_GLYPH_LEVEL11(c0, c1, c2, c3, c4)                                 \
+    RIT_GLYPH(c0, c1, c2, c3, c4, 11)
+#define RIT_GLYPH_LEVEL15(c0, c1, c2, c3, c4)                                 \
+    RIT_GLYPH(c0, c1, c2, c3, c4, 15)
+
+static const unsigned char g_pucGlyph11[96][24] =
+{
+    RIT_FONT(RIT_GLYPH_LEVEL11)
+};
+
+static const unsigned char g_pucGlyph15[96][24] =
+{
+    RIT_FONT(RIT_GLYPH_LEVEL15)
 };
 
 //*****************************************************************************
@@ -317,59 +519,100 @@ static const unsigned char g_pucRIT128x96x4Init[] =
 //
 //! \internal
 //!
-//! Write a sequence of command bytes to the SSD1329 controller.
+//! Move bytes from the transmit queue into the SSI transmit FIFO.
 //!
-//! The data is written in a polled fashion; this function will not return
-//! until the entire byte sequence has been written to the controller.
+//! Bytes are moved until either the queue is empty or the FIFO is full.  When
+//! the next byte in the queue is of a different type (command versus data)
+//! than the previous one, this waits for the SSI to finish shifting out what
+//! is already in the FIFO before changing the D/C line.  Since the FIFO is
+//! only eight entries deep, this wait is short.
+//!
+//! This must not be interrupted by another call to itself; it is called either
+//! from the SSI interrupt handler or with the SSI transmit interrupt disabled.
 //!
 //! \return None.
 //
 //*****************************************************************************
 static void
-RITWriteCommand(const unsigned char *pucBuffer, unsigned long ulCount)
+RITQueueService(void)
 {
-    //
-    // Return if SSI port is not enabled for RIT display.
-    //
-    if(!HWREGBITW(&g_ulSSIFlags, FLAG_SSI_ENABLED))
-    {
-        return;
-    }
+    unsigned long ulTail, ulNext;
+    unsigned short usEntry;
 
     //
-    // See if data mode is enabled.
+    // Loop while there are more bytes in the queue.
     //
-    if(HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH))
+    ulTail = g_ulQueueTail;
+    while(ulTail != g_ulQueueHead)
     {
+        usEntry = g_pusQueue[ulTail];
+
+        //
+        // See if the D/C line needs to change for this byte.
+        //
+        if(((usEntry & RIT_QUEUE_DATA) != 0) !=
+           HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH))
+        {
+            //
+            // Wait until the SSI is not busy, meaning that all previous bytes
+            // have been transmitted.
+            //
+            while(SSIBusy(SSI0_BASE))
+            {
+                RIT_BUS_COUNT(ulBusySpins, 1);
+            }
+
+            //
+            // Switch between command and data mode.
+            //
+            RIT_BUS_COUNT(ulDCToggles, 1);
+            if(usEntry & RIT_QUEUE_DATA)
+            {
+                GPIOPinWrite(GPIO_OLEDDC_BASE, GPIO_OLEDDC_PIN,
+                             GPIO_OLEDDC_PIN);
+                HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH) = 1;
+            }
+            else
+            {
+                GPIOPinWrite(GPIO_OLEDDC_BASE, GPIO_OLEDDC_PIN, 0);
+                HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH) = 0;
+            }
+        }
+
         //
-        // Wait until the SSI is not busy, meaning that all previous data has
-        // been transmitted.
+        // Write the byte to the SSI, stopping if the FIFO is full.
         //
-        while(SSIBusy(SSI0_BASE))
+        if(SSIDataPutNonBlocking(SSI0_BASE, usEntry & 0xff) == 0)
         {
+            break;
         }
 
         //
-        // Clear the command/control bit to enable command mode.
+        // A repeated byte stays at the tail until it has been sent as many
+        // times as the entry after it says, and then both entries are
+        // removed.
         //
-        GPIOPinWrite(GPIO_OLEDDC_BASE, GPIO_OLEDDC_PIN, 0);
-        HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH) = 0;
+        if(usEntry & RIT_QUEUE_REPEAT)
+        {
+            ulNext = (ulTail + 1) & (RIT_QUEUE_SIZE - 1);
+            if(--g_pusQueue[ulNext] != 0)
+            {
+                continue;
+            }
+            ulTail = ulNext;
+        }
+
+        ulTail = (ulTail + 1) & (RIT_QUEUE_SIZE - 1);
+        g_ulQueueTail = ulTail;
     }
 
     //
-    // Loop while there are more bytes left to be transferred.
+    // Stop the transmit interrupt once the queue has been emptied.  It is
+    // turned back on when more bytes are queued.
     //
-    while(ulCount != 0)
+    if(ulTail == g_ulQueueHead)
     {
-        //
-        // Write the next byte to the controller.
-        //
-        SSIDataPut(SSI0_BASE, *pucBuffer++);
-
-        //
-        // Decrement the BYTE counter.
-        //
-        ulCount--;
+        SSIIntDisable(SSI0_BASE, SSI_TXFF);
     }
 }
 
@@ -377,17 +620,27 @@ RITWriteCommand(const unsigned char *pucBuffer, unsigned long ulCount)
 //
 //! \internal
 //!
-//! Write a sequence of data bytes to the SSD1329 controller.
+//! Add a sequence of bytes to the SSI transmit queue.
 //!
-//! The data is written in a polled fashion; this function will not return
-//! until the entire byte sequence has been written to the controller.
+//! \param pucBuffer is a pointer to the bytes to send.
+//! \param ulCount is the number of bytes to send.
+//! \param usType is \b RIT_QUEUE_DATA for data bytes or zero for command
+//! bytes.
+//!
+//! This returns as soon as the bytes are in the queue.  If the queue fills up,
+//! the bytes at its head are moved into the SSI FIFO by polling until there is
+//! room for the rest; this keeps working even when called from an interrupt
+//! handler that the SSI interrupt cannot preempt.
 //!
 //! \return None.
 //
 //*****************************************************************************
 static void
-RITWriteData(const unsigned char *pucBuffer, unsigned long ulCount)
+RITQueueWrite(const unsigned char *pucBuffer, unsigned long ulCount,
+              unsigned short usType)
 {
+    unsigned long ulHead, ulNext;
+
     //
     // Return if SSI port is not enabled for RIT display.
     //
@@ -397,318 +650,1470 @@ RITWriteData(const unsigned char *pucBuffer, unsigned long ulCount)
     }
 
     //
-    // See if command mode is enabled.
+    // Count the bytes, and the command if these are command bytes.
+    //
+    RIT_BUS_COUNT(ulBytes, ulCount);
+    if(usType == 0)
+    {
+        RIT_BUS_COUNT(ulCommands, 1);
+    }
+
+    //
+    // Loop while there are more bytes left to be queued.
     //
-    if(!HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH))
+    ulHead = g_ulQueueHead;
+    while(ulCount != 0)
     {
         //
-        // Wait until the SSI is not busy, meaning that all previous commands
-        // have been transmitted.
+        // If the queue is full, drain it into the SSI FIFO by polling.  The
+        // interrupt is disabled while doing so, since the handler would
+        // otherwise race with this code for the queue tail.
         //
-        while(SSIBusy(SSI0_BASE))
+        ulNext = (ulHead + 1) & (RIT_QUEUE_SIZE - 1);
+        if(ulNext == g_ulQueueTail)
         {
+            IntDisable(INT_SSI0);
+            while(ulNext == g_ulQueueTail)
+            {
+                RITQueueService();
+            }
+            IntEnable(INT_SSI0);
         }
 
         //
-        // Set the command/control bit to enable data mode.
+        // Add the next byte to the queue.
+        //
+        g_pusQueue[ulHead] = *pucBuffer++ | usType;
+        ulHead = ulNext;
+        g_ulQueueHead = ulHead;
+
+        //
+        // Decrement the BYTE counter.
         //
-        GPIOPinWrite(GPIO_OLEDDC_BASE, GPIO_OLEDDC_PIN, GPIO_OLEDDC_PIN);
-        HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH) = 1;
+        ulCount--;
     }
 
     //
-    // Loop while there are more bytes left to be transferred.
+    // Let the SSI interrupt handler send the queued bytes.
     //
+    SSIIntEnable(SSI0_BASE, SSI_TXFF);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Add a run of the same byte to the SSI transmit queue.
+//!
+//! \param ucByte is the byte to send.
+//! \param ulCount is the number of times to send it.
+//! \param usType is \b RIT_QUEUE_DATA for data bytes or zero for command
+//! bytes.
+//!
+//! Each run of up to \b RIT_QUEUE_REPEAT_MAX bytes takes two entries in the
+//! queue, however long it is, so this returns without waiting for the SSI
+//! unless the queue is full.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITQueueRepeat(unsigned char ucByte, unsigned long ulCount,
+               unsigned short usType)
+{
+    unsigned long ulHead, ulRun;
+
+    //
+    // Return if SSI port is not enabled for RIT display.
+    //
+    if(!HWREGBITW(&g_ulSSIFlags, FLAG_SSI_ENABLED))
+    {
+        return;
+    }
+
+    RIT_BUS_COUNT(ulBytes, ulCount);
+
+    ulHead = g_ulQueueHead;
     while(ulCount != 0)
     {
+        ulRun = ((ulCount > RIT_QUEUE_REPEAT_MAX) ? RIT_QUEUE_REPEAT_MAX :
+                 ulCount);
+
         //
-        // Write the next byte to the controller.
+        // Wait for room for both entries, draining the queue by polling as
+        // RITQueueWrite() does.
         //
-        SSIDataPut(SSI0_BASE, *pucBuffer++);
+        if(((g_ulQueueTail - ulHead - 1) & (RIT_QUEUE_SIZE - 1)) < 2)
+        {
+            IntDisable(INT_SSI0);
+            while(((g_ulQueueTail - ulHead - 1) & (RIT_QUEUE_SIZE - 1)) < 2)
+            {
+                RITQueueService();
+            }
+            IntEnable(INT_SSI0);
+        }
 
         //
-        // Decrement the BYTE counter.
+        // Add both entries before moving the head past them, so that the
+        // interrupt handler never sees the byte without its count.
         //
-        ulCount--;
+        g_pusQueue[ulHead] = ucByte | usType | RIT_QUEUE_REPEAT;
+        g_pusQueue[(ulHead + 1) & (RIT_QUEUE_SIZE - 1)] = ulRun;
+        ulHead = (ulHead + 2) & (RIT_QUEUE_SIZE - 1);
+        g_ulQueueHead = ulHead;
+
+        ulCount -= ulRun;
     }
+
+    //
+    // Let the SSI interrupt handler send the queued bytes.
+    //
+    SSIIntEnable(SSI0_BASE, SSI_TXFF);
 }
 
 //*****************************************************************************
 //
-//! Clears the OLED display.
+//! \internal
 //!
-//! This function will clear the display RAM.  All pixels in the display will
-//! be turned off.
+//! Wait until the SSI transmit queue is empty.
 //!
 //! \return None.
 //
 //*****************************************************************************
-void
-RIT128x96x4Clear(void)
+static void
+RITQueueWait(void)
 {
-    static const unsigned char pucCommand1[] = { 0x15, 0, 63 };
-    static const unsigned char pucCommand2[] = { 0x75, 0, 127 };
-    unsigned long ulRow, ulColumn;
-
     //
-    // Clear out the buffer used for sending bytes to the display.
+    // Drain the queue by polling, as the caller may be an interrupt handler
+    // that the SSI interrupt cannot preempt.
     //
-    *(unsigned long *)&g_pucBuffer[0] = 0;
-    *(unsigned long *)&g_pucBuffer[4] = 0;
+    IntDisable(INT_SSI0);
+    while(g_ulQueueTail != g_ulQueueHead)
+    {
+        RITQueueService();
+    }
+    IntEnable(INT_SSI0);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write a sequence of command bytes to the SSD1329 controller.
+//!
+//! The bytes are placed in the transmit queue and sent by the SSI interrupt
+//! handler; this function does not wait for them to be transmitted.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITWriteCommand(const unsigned char *pucBuffer, unsigned long ulCount)
+{
+    RITQueueWrite(pucBuffer, ulCount, 0);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write a sequence of data bytes to the SSD1329 controller.
+//!
+//! The bytes are placed in the transmit queue and sent by the SSI interrupt
+//! handler; this function does not wait for them to be transmitted.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITWriteData(const unsigned char *pucBuffer, unsigned long ulCount)
+{
+    RITQueueWrite(pucBuffer, ulCount, RIT_QUEUE_DATA);
 
     //
-    // Set the window to fill the entire display.
+    // Keep track of where the address pointer is within the window.
     //
-    RITWriteCommand(pucCommand1, sizeof(pucCommand1));
-    RITWriteCommand(pucCommand2, sizeof(pucCommand2));
-    RITWriteCommand(g_pucRIT128x96x4HorizontalInc,
-                    sizeof(g_pucRIT128x96x4HorizontalInc));
+    g_ulWindowOffset = (g_ulWindowOffset + ulCount) % g_ulWindowSize;
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write the same data byte to the SSD1329 controller a number of times.
+//!
+//! The run is placed in the transmit queue and sent by the SSI interrupt
+//! handler; this function does not wait for it to be transmitted.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITWriteDataRepeat(unsigned char ucByte, unsigned long ulCount)
+{
+    RITQueueRepeat(ucByte, ulCount, RIT_QUEUE_DATA);
 
     //
-    // Loop through the rows
+    // Keep track of where the address pointer is within the window.
     //
-    for(ulRow = 0; ulRow < 96; ulRow++)
-    {
-        //
-        // Loop through the columns.  Each byte is two pixels,
-        // and the buffer hold 8 bytes, so 16 pixels are cleared
-        // at a time.
-        //
-        for(ulColumn = 0; ulColumn < 128; ulColumn += 8 * 2)
-        {
-            //
-            // Write 8 clearing bytes to the display, which will
-            // clear 16 pixels across.
-            //
-            RITWriteData(g_pucBuffer, sizeof(g_pucBuffer));
-        }
-    }
+    g_ulWindowOffset = (g_ulWindowOffset + ulCount) % g_ulWindowSize;
 }
 
 //*****************************************************************************
 //
-//! Displays a string on the OLED display.
-//!
-//! \param pcStr is a pointer to the string to display.
-//! \param ulX is the horizontal position to display the string, specified in
-//! columns from the left edge of the display.
-//! \param ulY is the vertical position to display the string, specified in
-//! rows from the top edge of the display.
-//! \param ucLevel is the 4-bit gray scale value to be used for displayed text.
+//! \internal
 //!
-//! This function will draw a string on the display.  Only the ASCII characters
-//! between 32 (space) and 126 (tilde) are supported; other characters will
-//! result in random data being draw on the display (based on whatever appears
-//! before/after the font in memory).  The font is mono-spaced, so characters
-//! such as ``i'' and ``l'' have more white space around them than characters
-//! such as ``m'' or ``w''.
+//! Set the column and row window of the SSD1329 controller.
 //!
-//! If the drawing of the string reaches the right edge of the display, no more
-//! characters will be drawn.  Therefore, special care is not required to avoid
-//! supplying a string that is ``too long'' to display.
+//! \param ulColumnStart is the first byte column of the window.
+//! \param ulColumnEnd is the last byte column of the window.
+//! \param ulRowStart is the first row of the window.
+//! \param ulRowEnd is the last row of the window.
 //!
-//! \note Because the OLED display packs 2 pixels of data in a single byte, the
-//! parameter \e ulX must be an even column number (for example, 0, 2, 4, and
-//! so on).
+//! On return, the address pointer of the controller is at the start of the
+//! window.  A command is not sent if the controller already has that part of
+//! the window and its address pointer is already at the start of the window.
 //!
 //! \return None.
 //
 //*****************************************************************************
-void
-RIT128x96x4StringDraw(const char *pcStr, unsigned long ulX,
-                      unsigned long ulY, unsigned char ucLevel)
+static void
+RITSetWindow(unsigned long ulColumnStart, unsigned long ulColumnEnd,
+             unsigned long ulRowStart, unsigned long ulRowEnd)
 {
-    unsigned long ulIdx1, ulIdx2;
-    unsigned char ucTemp;
+    tBoolean bAtStart;
 
     //
-    // Check the arguments.
+    // The commands can only be skipped if the address pointer is known to be
+    // at the start of the window.
     //
-    ASSERT(ulX < 128);
-    ASSERT((ulX & 1) == 0);
-    ASSERT(ulY < 96);
-    ASSERT(ucLevel < 16);
+    bAtStart = (HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) &&
+                (g_ulWindowOffset == 0));
 
     //
-    // Setup a window starting at the specified column and row, ending
-    // at the right edge of the display and 8 rows down (single character row).
+    // Set the column range, unless it is already set.
     //
-    g_pucBuffer[0] = 0x15;
-    g_pucBuffer[1] = ulX / 2;
-    g_pucBuffer[2] = 63;
-    RITWriteCommand(g_pucBuffer, 3);
-    g_pucBuffer[0] = 0x75;
-    g_pucBuffer[1] = ulY;
-    g_pucBuffer[2] = ulY + 7;
-    RITWriteCommand(g_pucBuffer, 3);
-    RITWriteCommand(g_pucRIT128x96x4VerticalInc,
-                    sizeof(g_pucRIT128x96x4VerticalInc));
+    if(bAtStart && (g_pucWindow[0] == ulColumnStart) &&
+       (g_pucWindow[1] == ulColumnEnd))
+    {
+        g_ulCommandsSkipped++;
+    }
+    else
+    {
+        g_pucBuffer[0] = 0x15;
+        g_pucBuffer[1] = ulColumnStart;
+        g_pucBuffer[2] = ulColumnEnd;
+        RITWriteCommand(g_pucBuffer, 3);
+        g_pucWindow[0] = ulColumnStart;
+        g_pucWindow[1] = ulColumnEnd;
+        g_ulCommandsSent++;
+    }
 
     //
-    // Loop while there are more characters in the string.
+    // Set the row range, unless it is already set.
     //
-    while(*pcStr != 0)
+    if(bAtStart && (g_pucWindow[2] == ulRowStart) &&
+       (g_pucWindow[3] == ulRowEnd))
+    {
+        g_ulCommandsSkipped++;
+    }
+    else
+    {
+        g_pucBuffer[0] = 0x75;
+        g_pucBuffer[1] = ulRowStart;
+        g_pucBuffer[2] = ulRowEnd;
+        RITWriteCommand(g_pucBuffer, 3);
+        g_pucWindow[2] = ulRowStart;
+        g_pucWindow[3] = ulRowEnd;
+        g_ulCommandsSent++;
+    }
+
+    //
+    // The address pointer is now at the start of the new window.
+    //
+    g_ulWindowSize = ((ulColumnEnd - ulColumnStart + 1) *
+                      (ulRowEnd - ulRowStart + 1));
+    g_ulWindowOffset = 0;
+    HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) = 1;
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Set the remap (address increment) mode of the SSD1329 controller.
+//!
+//! \param pucCommand is the two byte remap command to send.
+//!
+//! The command is not sent if the controller is already in that mode.  The
+//! address pointer is only tracked across a change in mode if it is at the
+//! start of the window; otherwise the next window is always sent in full.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITSetRemap(const unsigned char *pucCommand)
+{
+    //
+    // Nothing to do if the controller is already in this mode.
+    //
+    if(HWREGBITW(&g_ulSSIFlags, FLAG_REMAP_VALID) &&
+       (g_ucRemap == pucCommand[1]))
+    {
+        g_ulCommandsSkipped++;
+        return;
+    }
+
+    //
+    // Send the new mode.
+    //
+    RITWriteCommand(pucCommand, 2);
+    g_ucRemap = pucCommand[1];
+    HWREGBITW(&g_ulSSIFlags, FLAG_REMAP_VALID) = 1;
+    g_ulCommandsSent++;
+
+    //
+    // The start of the window is the same in either mode, but any other
+    // position of the address pointer is not.
+    //
+    if(g_ulWindowOffset != 0)
+    {
+        HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write a run of bytes into one row of the frame buffer.
+//!
+//! \param ulRow is the row of the frame buffer to write.
+//! \param ulColumn is the first byte column of the frame buffer to write.
+//! \param pucData is a pointer to the new values for the bytes.
+//! \param ulCount is the number of bytes to write.
+//!
+//! Only the bytes whose values change are marked as dirty.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITFrameWriteSpan(unsigned long ulRow, unsigned long ulColumn,
+                  const unsigned char *pucData, unsigned long ulCount)
+{
+    unsigned char *pucFrame;
+    unsigned long ulIdx, ulFirst, ulLast;
+
+    //
+    // Find the first and last bytes that change.  Nothing is to be done if
+    // the pixels already have these values.
+    //
+    pucFrame = &g_pucFrame[ulRow][ulColumn];
+    for(ulFirst = 0; ulFirst < ulCount; ulFirst++)
+    {
+        if(pucFrame[ulFirst] != pucData[ulFirst])
+        {
+            break;
+        }
+    }
+    if(ulFirst == ulCount)
+    {
+        return;
+    }
+    for(ulLast = ulCount; pucFrame[ulLast - 1] == pucData[ulLast - 1];
+        ulLast--)
+    {
+    }
+
+    //
+    // Copy the bytes between them.
+    //
+    for(ulIdx = ulFirst; ulIdx < ulLast; ulIdx++)
+    {
+        pucFrame[ulIdx] = pucData[ulIdx];
+    }
+
+    //
+    // Grow the dirty range of this row to include the changed bytes.
+    //
+    ulFirst += ulColumn;
+    ulLast += ulColumn;
+    if(g_pucDirtyEnd[ulRow] == 0)
+    {
+        g_pucDirtyStart[ulRow] = ulFirst;
+        g_pucDirtyEnd[ulRow] = ulLast;
+    }
+    else
+    {
+        if(ulFirst < g_pucDirtyStart[ulRow])
+        {
+            g_pucDirtyStart[ulRow] = ulFirst;
+        }
+        if(ulLast > g_pucDirtyEnd[ulRow])
+        {
+            g_pucDirtyEnd[ulRow] = ulLast;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write a run of pixels into one row of the frame buffer.
+//!
+//! \param ulRow is the row of the frame buffer to write.
+//! \param ulX is the first pixel column of the frame buffer to write.
+//! \param pucData is a pointer to the new values for the pixels, packed two
+//! to a byte with the first pixel in bits 7:4.
+//! \param ulWidth is the number of pixels to write.
+//!
+//! The run may start and end on any column.  A byte that is only partly
+//! covered by the run keeps the value of its other pixel from the frame
+//! buffer, so nothing next to the run is disturbed.  Pixels that fall past the
+//! right side of the display are not written.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITFrameWritePixels(unsigned long ulRow, unsigned long ulX,
+                    const unsigned char *pucData, unsigned long ulWidth)
+{
+    unsigned char pucMerged[64];
+    unsigned long ulColumn, ulCount, ulIdx, ulPixel;
+    unsigned char ucByte;
+
+    //
+    // Leave off whatever falls past the right side of the display.
+    //
+    if(ulX >= 128)
+    {
+        return;
+    }
+    if(ulWidth > (128 - ulX))
+    {
+        ulWidth = 128 - ulX;
+    }
+
+    //
+    // A run that starts and ends on a byte boundary can be copied as is.
+    //
+    if(((ulX | ulWidth) & 1) == 0)
+    {
+        RITFrameWriteSpan(ulRow, ulX / 2, pucData, ulWidth / 2);
+        return;
+    }
+
+    //
+    // Otherwise, build the bytes covered by the run one pixel at a time,
+    // starting from what the frame buffer already holds so that the pixels
+    // on either side of the run are kept.
+    //
+    ulColumn = ulX / 2;
+    ulCount = ((ulX + ulWidth + 1) / 2) - ulColumn;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ucByte = g_pucFrame[ulRow][ulColumn + ulIdx];
+        ulPixel = (ulColumn + ulIdx) * 2;
+        if(ulPixel >= ulX)
+        {
+            ucByte = ((ucByte & 0x0f) |
+                      (RIT_PIXEL(pucData, ulPixel - ulX) << 4));
+        }
+        if((ulPixel + 1) < (ulX + ulWidth))
+        {
+            ucByte = ((ucByte & 0xf0) |
+                      RIT_PIXEL(pucData, ulPixel + 1 - ulX));
+        }
+        pucMerged[ulIdx] = ucByte;
+    }
+    RITFrameWriteSpan(ulRow, ulColumn, pucMerged, ulCount);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Expand one row of a character of the font to four bits per pixel.
+//!
+//! \param ulChar is the index of the character in the font.
+//! \param ulRow is the row of the character, from 0 at the top to 7.
+//! \param ucLevel is the 4-bit gray scale value to use.
+//! \param pucBytes is a pointer to 3 bytes of storage for the row.
+//!
+//! This is used for gray levels that do not have a pre-expanded font table.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITGlyphRowExpand(unsigned long ulChar, unsigned long ulRow,
+                  unsigned char ucLevel, unsigned char *pucBytes)
+{
+    unsigned long ulIdx;
+    unsigned char ucByte;
+
+    for(ulIdx = 0; ulIdx < 6; ulIdx += 2)
     {
         //
-        // Get a working copy of the current character and convert to an
-        // index into the character bit-map array.
+        // Convert two columns of 1-bit font data into a single data
+        // byte of 4-bit font data.
         //
-        ucTemp = *pcStr++ & 0x7f;
+        ucByte = 0;
+        if(g_pucFont[ulChar][ulIdx] & (1 << ulRow))
+        {
+            ucByte = (ucLevel << 4) & 0xf0;
+        }
+        if((ulIdx < 4) && (g_pucFont[ulChar][ulIdx + 1] & (1 << ulRow)))
+        {
+            ucByte |= (ucLevel << 0) & 0x0f;
+        }
+        pucBytes[ulIdx / 2] = ucByte;
+    }
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Send a rectangle of the frame buffer to the display.
+//!
+//! \param ulTop is the first row of the rectangle.
+//! \param ulBottom is the last row of the rectangle.
+//! \param ulStart is the first byte column of the rectangle.
+//! \param ulEnd is one past the last byte column of the rectangle.
+//!
+//! The rows that are sent are marked as clean.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITFrameSend(unsigned long ulTop, unsigned long ulBottom,
+             unsigned long ulStart, unsigned long ulEnd)
+{
+    unsigned long ulRow, ulColumn;
+
+    //
+    // Setup a window covering the rectangle.
+    //
+    RITSetWindow(ulStart, ulEnd - 1, ulTop, ulBottom);
+    RITSetRemap(g_pucRIT128x96x4HorizontalInc);
+
+    //
+    // Send each row of the rectangle.
+    //
+    for(ulRow = ulTop; ulRow <= ulBottom; ulRow++)
+    {
+        RITWriteData(&g_pucFrame[ulRow][ulStart], ulEnd - ulStart);
+        for(ulColumn = ulStart; ulColumn < ulEnd; ulColumn++)
+        {
+            g_pucPanel[ulRow][ulColumn] = g_pucFrame[ulRow][ulColumn];
+        }
+        g_pucDirtyEnd[ulRow] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! Clears the OLED display.
+//!
+//! This function will clear the display RAM.  All pixels in the display will
+//! be turned off.  The local frame buffer is cleared as well, and any pending
+//! changes in it are discarded.
+//!
+//! The display RAM is cleared in the background, so this returns without
+//! waiting for it.  Anything drawn and flushed afterwards is sent once the
+//! clear is done.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4Clear(void)
+{
+    unsigned long ulRow, ulColumn;
+
+    //
+    // Clear the frame buffer to match the display.
+    //
+    for(ulRow = 0; ulRow < 96; ulRow++)
+    {
+        for(ulColumn = 0; ulColumn < 64; ulColumn++)
+        {
+            g_pucFrame[ulRow][ulColumn] = 0;
+            g_pucPanel[ulRow][ulColumn] = 0;
+        }
+        g_pucDirtyEnd[ulRow] = 0;
+    }
+
+    //
+    // Set the window to fill the entire display, and clear it with one run of
+    // zero bytes.  This returns as soon as the run is queued; the SSI
+    // interrupt handler sends it while the caller gets on with drawing.
+    //
+    RITSetWindow(0, 63, 0, 127);
+    RITSetRemap(g_pucRIT128x96x4HorizontalInc);
+    RITWriteDataRepeat(0, 64 * 96);
+}
+
+//*****************************************************************************
+//
+// The most characters of a string that can be on the display at once, the
+// last of them cut off by the right side of the display.
+//
+//*****************************************************************************
+#define RIT_STRING_MAX          ((128 + 5) / 6)
+
+//*****************************************************************************
+//
+//! Displays a string on the OLED display.
+//!
+//! \param pcStr is a pointer to the string to display.
+//! \param ulX is the horizontal position to display the string, specified in
+//! columns from the left edge of the display.
+//! \param ulY is the vertical position to display the string, specified in
+//! rows from the top edge of the display.
+//! \param ucLevel is the 4-bit gray scale value to be used for displayed text.
+//!
+//! This function will draw a string on the display.  Only the ASCII characters
+//! between 32 (space) and 126 (tilde) are supported; other characters will
+//! result in random data being draw on the display (based on whatever appears
+//! before/after the font in memory).  The font is mono-spaced, so characters
+//! such as ``i'' and ``l'' have more white space around them than characters
+//! such as ``m'' or ``w''.
+//!
+//! If the drawing of the string reaches the right edge of the display, no more
+//! characters will be drawn.  Therefore, special care is not required to avoid
+//! supplying a string that is ``too long'' to display.  Rows that fall below
+//! the bottom edge of the display are likewise skipped.
+//!
+//! The string is drawn into the local frame buffer; it appears on the display
+//! the next time RIT128x96x4Flush() is called.
+//!
+//! The OLED display packs 2 pixels of data in a single byte.  When \e ulX is
+//! an odd column number, the pixels that share a byte with the edges of the
+//! string keep their current values.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4StringDraw(const char *pcStr, unsigned long ulX,
+                      unsigned long ulY, unsigned char ucLevel)
+{
+    const unsigned char (*ppucFont)[24];
+    const unsigned char *pucGlyph;
+    unsigned char pucChars[RIT_STRING_MAX];
+    unsigned char pucRow[RIT_STRING_MAX * 3];
+    unsigned long ulCount, ulRows, ulRow, ulIdx;
+    unsigned char ucTemp;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(ulX < 128);
+    ASSERT(ulY < 96);
+    ASSERT(ucLevel < 16);
+
+    //
+    // Nothing is drawn if the string starts off the edge of the display.
+    //
+    if((ulX >= 128) || (ulY >= 96))
+    {
+        return;
+    }
+
+    //
+    // Use the pre-expanded font if there is one for this gray level.
+    //
+    if(ucLevel == 11)
+    {
+        ppucFont = g_pucGlyph11;
+    }
+    else if(ucLevel == 15)
+    {
+        ppucFont = g_pucGlyph15;
+    }
+    else
+    {
+        ppucFont = 0;
+    }
+
+    //
+    // Look up the characters of the string up to the right side of the
+    // display, converting each to an index into the character bit-map array.
+    //
+    for(ulCount = 0; (pcStr[ulCount] != 0) && ((ulX + (ulCount * 6)) < 128);
+        ulCount++)
+    {
+        ucTemp = pcStr[ulCount] & 0x7f;
         if(ucTemp < ' ')
         {
-            ucTemp = 0;
+            ucTemp = 0;
+        }
+        else
+        {
+            ucTemp -= ' ';
+        }
+        pucChars[ulCount] = ucTemp;
+    }
+
+    //
+    // Characters are cut off at the bottom edge of the display.
+    //
+    ulRows = 96 - ulY;
+    if(ulRows > 8)
+    {
+        ulRows = 8;
+    }
+
+    //
+    // Build each row of the string from the 4-bit version of its characters,
+    // and copy it into the frame buffer in one go.
+    //
+    for(ulRow = 0; ulRow < ulRows; ulRow++)
+    {
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+            if(ppucFont)
+            {
+                pucGlyph = ppucFont[pucChars[ulIdx]] + (ulRow * 3);
+                pucRow[(ulIdx * 3) + 0] = pucGlyph[0];
+                pucRow[(ulIdx * 3) + 1] = pucGlyph[1];
+                pucRow[(ulIdx * 3) + 2] = pucGlyph[2];
+            }
+            else
+            {
+                RITGlyphRowExpand(pucChars[ulIdx], ulRow, ucLevel,
+                                  pucRow + (ulIdx * 3));
+            }
+        }
+        RITFrameWritePixels(ulY + ulRow, ulX, pucRow, ulCount * 6);
+    }
+}
+
+//*****************************************************************************
+//
+//! Displays an image on the OLED display.
+//!
+//! \param pucImage is a pointer to the image data.
+//! \param ulX is the horizontal position to display this image, specified in
+//! columns from the left edge of the display.
+//! \param ulY is the vertical position to display this image, specified in
+//! rows from the top of the display.
+//! \param ulWidth is the width of the image, specified in columns.
+//! \param ulHeight is the height of the image, specified in rows.
+//!
+//! This function will display a bitmap graphic on the display.  Because of the
+//! format of the image data, the number of columns (\e ulWidth) must be an
+//! integer multiple of two.  The starting column (\e ulX) may be odd, in which
+//! case the pixels that share a byte with the left and right edges of the
+//! image keep their current values.
+//!
+//! The image is drawn into the local frame buffer; it appears on the display
+//! the next time RIT128x96x4Flush() is called.
+//!
+//! The image data is organized with the first row of image data appearing left
+//! to right, followed immediately by the second row of image data.  Each byte
+//! contains the data for two columns in the current row, with the leftmost
+//! column being contained in bits 7:4 and the rightmost column being contained
+//! in bits 3:0.
+//!
+//! For example, an image six columns wide and seven scan lines tall would
+//! be arranged as follows (showing how the twenty one bytes of the image would
+//! appear on the display):
+//!
+//! \verbatim
+//!     +-------------------+-------------------+-------------------+
+//!     |      Byte 0       |      Byte 1       |      Byte 2       |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 3       |      Byte 4       |      Byte 5       |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 6       |      Byte 7       |      Byte 8       |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 9       |      Byte 10      |      Byte 11      |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 12      |      Byte 13      |      Byte 14      |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 15      |      Byte 16      |      Byte 17      |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     |      Byte 18      |      Byte 19      |      Byte 20      |
+//!     +---------+---------+---------+---------+---------+---------+
+//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
+//!     +---------+---------+---------+---------+---------+---------+
+//! \endverbatim
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4ImageDraw(const unsigned char *pucImage, unsigned long ulX,
+                     unsigned long ulY, unsigned long ulWidth,
+                     unsigned long ulHeight)
+{
+    unsigned long ulRow;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(ulX < 128);
+    ASSERT(ulY < 96);
+    ASSERT((ulX + ulWidth) <= 128);
+    ASSERT((ulY + ulHeight) <= 96);
+    ASSERT((ulWidth & 1) == 0);
+
+    //
+    // Loop while there are more rows to display.
+    //
+    for(ulRow = ulY; (ulRow < (ulY + ulHeight)) && (ulRow < 96); ulRow++)
+    {
+        //
+        // Copy this row of image data into the frame buffer.
+        //
+        RITFrameWritePixels(ulRow, ulX, pucImage, ulWidth);
+
+        //
+        // Advance to the next row of the image.
+        //
+        pucImage += (ulWidth / 2);
+    }
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Find the part of the frame buffer covered by a sprite at a given position.
+//!
+//! \param psSprite is a pointer to the sprite.
+//! \param ulX is the horizontal position of the sprite, in columns.
+//! \param ulY is the vertical position of the sprite, in rows.
+//! \param pulTop is a pointer to storage for the first row.
+//! \param pulBottom is a pointer to storage for one past the last row.
+//! \param pulStart is a pointer to storage for the first column.
+//! \param pulEnd is a pointer to storage for one past the last column.
+//!
+//! The rectangle is clipped to the edges of the display, and may be empty.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITSpriteBounds(const tRITSprite *psSprite, unsigned long ulX,
+                unsigned long ulY, unsigned long *pulTop,
+                unsigned long *pulBottom, unsigned long *pulStart,
+                unsigned long *pulEnd)
+{
+    *pulTop = (ulY < 96) ? ulY : 96;
+    *pulBottom = ((ulY + psSprite->ulHeight) < 96) ?
+                 (ulY + psSprite->ulHeight) : 96;
+    *pulStart = (ulX < 128) ? ulX : 128;
+    *pulEnd = ((ulX + psSprite->ulWidth) < 128) ?
+              (ulX + psSprite->ulWidth) : 128;
+}
+
+//*****************************************************************************
+//
+//! Prepares a sprite for drawing on the OLED display.
+//!
+//! \param psSprite is a pointer to the sprite to initialize.
+//! \param pucImage is a pointer to the image data for the sprite, in the same
+//! format as used by RIT128x96x4ImageDraw().
+//! \param ulWidth is the width of the image, specified in columns.
+//! \param ulHeight is the height of the image, specified in rows.
+//!
+//! The sprite starts out hidden; it appears the first time it is moved with
+//! RIT128x96x4SpriteMove().  The image data is not copied, so it must remain
+//! valid for as long as the sprite is in use.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4SpriteInit(tRITSprite *psSprite, const unsigned char *pucImage,
+                      unsigned long ulWidth, unsigned long ulHeight)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT((ulWidth & 1) == 0);
+
+    psSprite->pucImage = pucImage;
+    psSprite->ulWidth = ulWidth;
+    psSprite->ulHeight = ulHeight;
+    psSprite->ulX = 0;
+    psSprite->ulY = 0;
+    psSprite->bVisible = false;
+}
+
+//*****************************************************************************
+//
+//! Draws a sprite at a new position on the OLED display.
+//!
+//! \param psSprite is a pointer to the sprite to move.
+//! \param ulX is the new horizontal position of the sprite, specified in
+//! columns from the left edge of the display.
+//! \param ulY is the new vertical position of the sprite, specified in rows
+//! from the top edge of the display.
+//!
+//! The parts of the sprite's previous position that are not covered by the
+//! new position are erased, and the image is then drawn at the new position.
+//! The image is always drawn, even if the sprite has not moved, so that it is
+//! repaired if something else was drawn over it; the frame buffer keeps any
+//! bytes that do not change off the SSI bus.  Whatever falls past the right
+//! or bottom edge of the display is not drawn.
+//!
+//! The sprite is drawn into the local frame buffer; it appears on the display
+//! the next time RIT128x96x4Flush() is called.
+//!
+//! The sprite can be placed at any column.  Pixels that share a byte with the
+//! edges of the sprite, but are not part of it, keep their current values.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4SpriteMove(tRITSprite *psSprite, unsigned long ulX,
+                      unsigned long ulY)
+{
+    unsigned long ulOldTop, ulOldBottom, ulOldStart, ulOldEnd;
+    unsigned long ulTop, ulBottom, ulStart, ulEnd, ulRow, ulCut;
+    const unsigned char *pucImage;
+
+    //
+    // Find where the sprite is going.
+    //
+    RITSpriteBounds(psSprite, ulX, ulY, &ulTop, &ulBottom, &ulStart, &ulEnd);
+
+    //
+    // Erase the part of the old position that the new one does not cover.
+    //
+    if(psSprite->bVisible)
+    {
+        RITSpriteBounds(psSprite, psSprite->ulX, psSprite->ulY, &ulOldTop,
+                        &ulOldBottom, &ulOldStart, &ulOldEnd);
+        for(ulRow = ulOldTop; ulRow < ulOldBottom; ulRow++)
+        {
+            //
+            // Rows outside of the new position are erased completely.
+            //
+            if((ulRow < ulTop) || (ulRow >= ulBottom) || (ulStart >= ulEnd))
+            {
+                RITFrameWritePixels(ulRow, ulOldStart, g_pucBlank,
+                                    ulOldEnd - ulOldStart);
+                continue;
+            }
+
+            //
+            // Otherwise, only the columns to the left and right of the new
+            // position are erased.
+            //
+            if(ulOldStart < ulStart)
+            {
+                ulCut = (ulOldEnd < ulStart) ? ulOldEnd : ulStart;
+                RITFrameWritePixels(ulRow, ulOldStart, g_pucBlank,
+                                    ulCut - ulOldStart);
+            }
+            if(ulOldEnd > ulEnd)
+            {
+                ulCut = (ulOldStart > ulEnd) ? ulOldStart : ulEnd;
+                RITFrameWritePixels(ulRow, ulCut, g_pucBlank,
+                                    ulOldEnd - ulCut);
+            }
+        }
+    }
+
+    //
+    // Draw the image at the new position.
+    //
+    pucImage = psSprite->pucImage;
+    for(ulRow = ulTop; ulRow < ulBottom; ulRow++)
+    {
+        RITFrameWritePixels(ulRow, ulStart, pucImage, ulEnd - ulStart);
+        pucImage += (psSprite->ulWidth / 2);
+    }
+
+    //
+    // Remember where the sprite was drawn.
+    //
+    psSprite->ulX = ulX;
+    psSprite->ulY = ulY;
+    psSprite->bVisible = true;
+}
+
+//*****************************************************************************
+//
+//! Removes a sprite from the OLED display.
+//!
+//! \param psSprite is a pointer to the sprite to remove.
+//!
+//! The sprite is erased from its last position.  It is drawn again the next
+//! time it is moved with RIT128x96x4SpriteMove().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4SpriteHide(tRITSprite *psSprite)
+{
+    unsigned long ulTop, ulBottom, ulStart, ulEnd, ulRow;
+
+    //
+    // Nothing to do if the sprite is not on the display.
+    //
+    if(!psSprite->bVisible)
+    {
+        return;
+    }
+
+    //
+    // Erase the sprite from its last position.
+    //
+    RITSpriteBounds(psSprite, psSprite->ulX, psSprite->ulY, &ulTop, &ulBottom,
+                    &ulStart, &ulEnd);
+    for(ulRow = ulTop; ulRow < ulBottom; ulRow++)
+    {
+        RITFrameWritePixels(ulRow, ulStart, g_pucBlank, ulEnd - ulStart);
+    }
+    psSprite->bVisible = false;
+}
+
+//*****************************************************************************
+//
+//! Sends the changes in the frame buffer to the OLED display.
+//!
+//! This function sends every byte that differs between the local frame buffer
+//! and the display.  Adjacent changed rows are grouped into a single window
+//! when doing so costs fewer bytes on the SSI bus than setting up a separate
+//! window for each row.
+//!
+//! This is intended to be called once per frame, after all drawing for the
+//! frame has been done.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4Flush(void)
+{
+    unsigned long ulRow, ulTop, ulStart, ulEnd, ulCount;
+    unsigned long ulNewStart, ulNewEnd;
+
+    //
+    // Trim the dirty range of each row down to the bytes that really differ
+    // from the display.  Rows that were written but ended up unchanged are
+    // marked as clean.
+    //
+    for(ulRow = 0; ulRow < 96; ulRow++)
+    {
+        ulStart = g_pucDirtyStart[ulRow];
+        ulEnd = g_pucDirtyEnd[ulRow];
+        while((ulStart < ulEnd) &&
+              (g_pucFrame[ulRow][ulStart] == g_pucPanel[ulRow][ulStart]))
+        {
+            ulStart++;
         }
-        else
+        while((ulEnd > ulStart) &&
+              (g_pucFrame[ulRow][ulEnd - 1] == g_pucPanel[ulRow][ulEnd - 1]))
         {
-            ucTemp -= ' ';
+            ulEnd--;
         }
+        g_pucDirtyStart[ulRow] = ulStart;
+        g_pucDirtyEnd[ulRow] = (ulStart < ulEnd) ? ulEnd : 0;
+    }
 
+    //
+    // Loop through the rows of the frame buffer.
+    //
+    ulRow = 0;
+    while(ulRow < 96)
+    {
         //
-        // Build and display the character buffer.
+        // Skip over rows that have not changed.
         //
-        for(ulIdx1 = 0; ulIdx1 < 6; ulIdx1 += 2)
+        if(g_pucDirtyEnd[ulRow] == 0)
         {
-            //
-            // Convert two columns of 1-bit font data into a single data
-            // byte column of 4-bit font data.
-            //
-            for(ulIdx2 = 0; ulIdx2 < 8; ulIdx2++)
-            {
-                g_pucBuffer[ulIdx2] = 0;
-                if(g_pucFont[ucTemp][ulIdx1] & (1 << ulIdx2))
-                {
-                    g_pucBuffer[ulIdx2] = (ucLevel << 4) & 0xf0;
-                }
-                if((ulIdx1 < 4) &&
-                   (g_pucFont[ucTemp][ulIdx1 + 1] & (1 << ulIdx2)))
-                {
-                    g_pucBuffer[ulIdx2] |= (ucLevel << 0) & 0x0f;
-                }
-            }
+            ulRow++;
+            continue;
+        }
 
-            //
-            // Send this byte column to the display.
-            //
-            RITWriteData(g_pucBuffer, 8);
-            ulX += 2;
+        //
+        // Start a new rectangle at this row.
+        //
+        ulTop = ulRow;
+        ulStart = g_pucDirtyStart[ulRow];
+        ulEnd = g_pucDirtyEnd[ulRow];
+        ulCount = ulEnd - ulStart;
 
-            //
-            // Return if the right side of the display has been reached.
-            //
-            if(ulX == 128)
+        //
+        // Grow the rectangle down through the following dirty rows, as long
+        // as resending their unchanged bytes is cheaper than a new window.
+        //
+        for(ulRow++; (ulRow < 96) && (g_pucDirtyEnd[ulRow] != 0); ulRow++)
+        {
+            ulNewStart = g_pucDirtyStart[ulRow];
+            ulNewEnd = g_pucDirtyEnd[ulRow];
+            ulCount += ulNewEnd - ulNewStart;
+            if(ulNewStart > ulStart)
+            {
+                ulNewStart = ulStart;
+            }
+            if(ulNewEnd < ulEnd)
             {
-                return;
+                ulNewEnd = ulEnd;
             }
+            if(((ulNewEnd - ulNewStart) * (ulRow - ulTop + 1)) >
+               (ulCount + RIT_WINDOW_COST))
+            {
+                break;
+            }
+            ulStart = ulNewStart;
+            ulEnd = ulNewEnd;
         }
+
+        //
+        // Send this rectangle to the display.
+        //
+        RITFrameSend(ulTop, ulRow - 1, ulStart, ulEnd);
     }
 }
 
 //*****************************************************************************
 //
-//! Displays an image on the OLED display.
+//! Gets the number of window and remap commands sent to the OLED display.
 //!
-//! \param pucImage is a pointer to the image data.
-//! \param ulX is the horizontal position to display this image, specified in
-//! columns from the left edge of the display.
-//! \param ulY is the vertical position to display this image, specified in
-//! rows from the top of the display.
-//! \param ulWidth is the width of the image, specified in columns.
-//! \param ulHeight is the height of the image, specified in rows.
+//! \param pulSent is a pointer to storage for the number of window and remap
+//! commands that have been sent to the display.
+//! \param pulSkipped is a pointer to storage for the number of window and
+//! remap commands that were not sent, because the display was already in the
+//! requested state.
 //!
-//! This function will display a bitmap graphic on the display.  Because of the
-//! format of the display RAM, the starting column (\e ulX) and the number of
-//! columns (\e ulWidth) must be an integer multiple of two.
+//! Each of the column range, row range, and remap settings counts as one
+//! command.  The counts are accumulated from the time the driver starts.
 //!
-//! The image data is organized with the first row of image data appearing left
-//! to right, followed immediately by the second row of image data.  Each byte
-//! contains the data for two columns in the current row, with the leftmost
-//! column being contained in bits 7:4 and the rightmost column being contained
-//! in bits 3:0.
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4CommandCountGet(unsigned long *pulSent, unsigned long *pulSkipped)
+{
+    *pulSent = g_ulCommandsSent;
+    *pulSkipped = g_ulCommandsSkipped;
+}
+
+//*****************************************************************************
+//
+//! \internal
 //!
-//! For example, an image six columns wide and seven scan lines tall would
-//! be arranged as follows (showing how the twenty one bytes of the image would
-//! appear on the display):
+//! Fold the counts for a frame into the peaks and totals.
 //!
-//! \verbatim
-//!     +-------------------+-------------------+-------------------+
-//!     |      Byte 0       |      Byte 1       |      Byte 2       |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 3       |      Byte 4       |      Byte 5       |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 6       |      Byte 7       |      Byte 8       |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 9       |      Byte 10      |      Byte 11      |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 12      |      Byte 13      |      Byte 14      |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 15      |      Byte 16      |      Byte 17      |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     |      Byte 18      |      Byte 19      |      Byte 20      |
-//!     +---------+---------+---------+---------+---------+---------+
-//!     | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-//!     +---------+---------+---------+---------+---------+---------+
-//! \endverbatim
+//! \param psFrame is a pointer to the counts for the frame.
+//! \param psPeak is a pointer to the peak counts.
+//! \param psTotal is a pointer to the total counts.
+//!
+//! Each field of the peak is the largest value of that field in any frame,
+//! so the peaks of different fields may come from different frames.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITBusStatsFold(const tRITBusStats *psFrame, tRITBusStats *psPeak,
+                tRITBusStats *psTotal)
+{
+    if(psFrame->ulBytes > psPeak->ulBytes)
+    {
+        psPeak->ulBytes = psFrame->ulBytes;
+    }
+    if(psFrame->ulCommands > psPeak->ulCommands)
+    {
+        psPeak->ulCommands = psFrame->ulCommands;
+    }
+    if(psFrame->ulDCToggles > psPeak->ulDCToggles)
+    {
+        psPeak->ulDCToggles = psFrame->ulDCToggles;
+    }
+    if(psFrame->ulBusySpins > psPeak->ulBusySpins)
+    {
+        psPeak->ulBusySpins = psFrame->ulBusySpins;
+    }
+
+    psTotal->ulBytes += psFrame->ulBytes;
+    psTotal->ulCommands += psFrame->ulCommands;
+    psTotal->ulDCToggles += psFrame->ulDCToggles;
+    psTotal->ulBusySpins += psFrame->ulBusySpins;
+}
+
+//*****************************************************************************
+//
+//! Selects the section of the frame that SSI bus activity is counted against.
+//!
+//! \param ulSection is the section number, less than \b RIT_BUS_SECTIONS.
+//! \param pcName is the name of the section, which is kept for reporting.
+//!
+//! Bytes are counted when they are queued, which for drawing functions is when
+//! RIT128x96x4Flush() is called.  To see what each part of a frame costs, the
+//! frame has to be flushed before the section is changed.  The section stays
+//! selected until this is called again.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void
-RIT128x96x4ImageDraw(const unsigned char *pucImage, unsigned long ulX,
-                     unsigned long ulY, unsigned long ulWidth,
-                     unsigned long ulHeight)
+RIT128x96x4BusSectionSet(unsigned long ulSection, const char *pcName)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(ulX < 128);
-    ASSERT((ulX & 1) == 0);
-    ASSERT(ulY < 96);
-    ASSERT((ulX + ulWidth) <= 128);
-    ASSERT((ulY + ulHeight) <= 96);
-    ASSERT((ulWidth & 1) == 0);
+    ASSERT(ulSection < RIT_BUS_SECTIONS);
 
-    //
-    // Setup a window starting at the specified column and row, and ending
-    // at the column + width and row+height.
-    //
-    g_pucBuffer[0] = 0x15;
-    g_pucBuffer[1] = ulX / 2;
-    g_pucBuffer[2] = (ulX + ulWidth - 2) / 2;
-    RITWriteCommand(g_pucBuffer, 3);
-    g_pucBuffer[0] = 0x75;
-    g_pucBuffer[1] = ulY;
-    g_pucBuffer[2] = ulY + ulHeight - 1;
-    RITWriteCommand(g_pucBuffer, 3);
-    RITWriteCommand(g_pucRIT128x96x4HorizontalInc,
-                    sizeof(g_pucRIT128x96x4HorizontalInc));
+    g_psBusSection[ulSection].pcName = pcName;
+    g_ulBusSection = ulSection;
+}
+
+//*****************************************************************************
+//
+//! Ends a frame for the SSI bus accounting.
+//!
+//! The counts for the frame that is ending, both overall and for each
+//! section, are folded into the peaks and totals, and the counts start again
+//! from zero for the next frame.  This should be called once per frame, after
+//! RIT128x96x4Flush().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4BusFrameEnd(void)
+{
+    unsigned long ulSection;
 
     //
-    // Loop while there are more rows to display.
+    // The SSI interrupt handler counts D/C toggles and busy spins, so keep it
+    // out while the counts are moved.
     //
-    while(ulHeight--)
+    IntDisable(INT_SSI0);
+
+    RITBusStatsFold(&g_sBusFrame, &g_sBusPeak, &g_sBusTotal);
+    g_sBusLast = g_sBusFrame;
+    g_sBusFrame = g_sBusZero;
+
+    for(ulSection = 0; ulSection < RIT_BUS_SECTIONS; ulSection++)
     {
-        //
-        // Write this row of image data.
-        //
-        RITWriteData(pucImage, (ulWidth / 2));
+        RITBusStatsFold(&g_psBusSection[ulSection].sFrame,
+                        &g_psBusSection[ulSection].sPeak,
+                        &g_psBusSection[ulSection].sTotal);
+        g_psBusSection[ulSection].sFrame = g_sBusZero;
+    }
 
-        //
-        // Advance to the next row of the image.
-        //
-        pucImage += (ulWidth / 2);
+    g_ulBusFrames++;
+
+    IntEnable(INT_SSI0);
+}
+
+//*****************************************************************************
+//
+//! Resets the SSI bus accounting.
+//!
+//! All of the counts, peaks, totals and section names are cleared, and the
+//! first section is selected.  This can be used to leave the bytes sent while
+//! starting up the display out of the accounting.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4BusStatsReset(void)
+{
+    unsigned long ulSection;
+
+    IntDisable(INT_SSI0);
+
+    g_sBusFrame = g_sBusZero;
+    g_sBusLast = g_sBusZero;
+    g_sBusPeak = g_sBusZero;
+    g_sBusTotal = g_sBusZero;
+    g_ulBusFrames = 0;
+
+    for(ulSection = 0; ulSection < RIT_BUS_SECTIONS; ulSection++)
+    {
+        g_psBusSection[ulSection].pcName = 0;
+        g_psBusSection[ulSection].sFrame = g_sBusZero;
+        g_psBusSection[ulSection].sPeak = g_sBusZero;
+        g_psBusSection[ulSection].sTotal = g_sBusZero;
+    }
+    g_ulBusSection = 0;
+
+    IntEnable(INT_SSI0);
+}
+
+//*****************************************************************************
+//
+//! Gets the SSI bus accounting for the OLED display.
+//!
+//! \param psLast is a pointer to storage for the counts for the last frame
+//! that was ended, or 0 if they are not needed.
+//! \param psPeak is a pointer to storage for the peak counts in any frame, or
+//! 0 if they are not needed.
+//! \param psTotal is a pointer to storage for the counts over all frames, or
+//! 0 if they are not needed.
+//!
+//! The average per frame is the total divided by the number of frames.  Each
+//! field of the peak is taken separately, so the peaks may come from different
+//! frames.
+//!
+//! \return Returns the number of frames that have been ended.
+//
+//*****************************************************************************
+unsigned long
+RIT128x96x4BusStatsGet(tRITBusStats *psLast, tRITBusStats *psPeak,
+                       tRITBusStats *psTotal)
+{
+    if(psLast)
+    {
+        *psLast = g_sBusLast;
+    }
+    if(psPeak)
+    {
+        *psPeak = g_sBusPeak;
+    }
+    if(psTotal)
+    {
+        *psTotal = g_sBusTotal;
+    }
+
+    return(g_ulBusFrames);
+}
+
+//*****************************************************************************
+//
+//! Gets the SSI bus accounting for one section of the frame.
+//!
+//! \param ulSection is the section number, less than \b RIT_BUS_SECTIONS.
+//! \param psPeak is a pointer to storage for the peak counts for the section
+//! in any frame, or 0 if they are not needed.
+//! \param psTotal is a pointer to storage for the counts for the section over
+//! all frames, or 0 if they are not needed.
+//!
+//! \return Returns the name that the section was given by
+//! RIT128x96x4BusSectionSet(), or 0 if it has never been selected.
+//
+//*****************************************************************************
+const char *
+RIT128x96x4BusSectionGet(unsigned long ulSection, tRITBusStats *psPeak,
+                         tRITBusStats *psTotal)
+{
+    ASSERT(ulSection < RIT_BUS_SECTIONS);
+
+    if(psPeak)
+    {
+        *psPeak = g_psBusSection[ulSection].sPeak;
+    }
+    if(psTotal)
+    {
+        *psTotal = g_psBusSection[ulSection].sTotal;
+    }
+
+    return(g_psBusSection[ulSection].pcName);
+}
+
+//*****************************************************************************
+//
+//! Handles the SSI interrupt for the OLED display.
+//!
+//! This function must be installed as the SSI0 interrupt handler.  It moves
+//! bytes from the transmit queue into the SSI transmit FIFO whenever the FIFO
+//! is half empty, so that drawing functions can return without waiting for
+//! the display to receive their data.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4IntHandler(void)
+{
+    RITQueueService();
+}
+
+//*****************************************************************************
+//
+//! Gets the SSI clock that the display is being sent to at.
+//!
+//! \return Returns the SSI clock in Hz, as set by RIT128x96x4Enable().
+//
+//*****************************************************************************
+unsigned long
+RIT128x96x4SSIClockGet(void)
+{
+    return(g_ulSSIClock);
+}
+
+//*****************************************************************************
+//
+//! Waits for everything that has been queued to be sent to the display.
+//!
+//! This function polls the SSI until the transmit queue is empty and the last
+//! byte has been shifted out.  It can be called from an interrupt handler
+//! that the SSI interrupt cannot preempt.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4Wait(void)
+{
+    RITQueueWait();
+
+    while(SSIBusy(SSI0_BASE))
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Works out the SSI clock to ask the SSI for.
+//!
+//! \param ulSSIClk is the clock that the SSI runs from.
+//! \param ulFrequency is the SSI clock wanted.
+//!
+//! The SSI divides its clock by an even number, and SSIConfigSetExpClk()
+//! rounds the divider down, which can make the SSI clock faster than the one
+//! asked for.  This picks the fastest SSI clock that the SSI can make exactly
+//! that is no faster than \e ulFrequency, or than \b RIT_SSI_CLOCK_MAX, the
+//! fastest that the SSD1329 takes.
+//!
+//! \return Returns the SSI clock.
+//
+//*****************************************************************************
+static unsigned long
+RITSSIClockFit(unsigned long ulSSIClk, unsigned long ulFrequency)
+{
+    unsigned long ulDivider;
+
+    if(ulFrequency > RIT_SSI_CLOCK_MAX)
+    {
+        ulFrequency = RIT_SSI_CLOCK_MAX;
     }
+
+    ulDivider = (ulSSIClk + ulFrequency - 1) / ulFrequency;
+    ulDivider += ulDivider & 1;
+
+    return(ulSSIClk / ulDivider);
 }
 
 //*****************************************************************************
@@ -717,7 +2122,11 @@ RIT128x96x4ImageDraw(const unsigned char *pucImage, unsigned long ulX,
 //!
 //! \param ulFrequency specifies the SSI Clock Frequency to be used.
 //!
-//! This function initializes the SSI interface to the OLED display.
+//! This function initializes the SSI interface to the OLED display.  The SSI
+//! clock is the fastest that can be made from the system clock that is no
+//! faster than \e ulFrequency or \b RIT_SSI_CLOCK_MAX; it can be read back
+//! with RIT128x96x4SSIClockGet().  This must be called again if the system
+//! clock changes.
 //!
 //! \return None.
 //
@@ -733,8 +2142,9 @@ RIT128x96x4Enable(unsigned long ulFrequency)
     //
     // Configure the SSI0 port for master mode.
     //
+    g_ulSSIClock = RITSSIClockFit(SysCtlClockGet(), ulFrequency);
     SSIConfigSetExpClk(SSI0_BASE, SysCtlClockGet(), SSI_FRF_MOTO_MODE_3,
-                       SSI_MODE_MASTER, ulFrequency, 8);
+                       SSI_MODE_MASTER, g_ulSSIClock, 8);
 
     //
     // (Re)Enable SSI control of the FSS pin.
@@ -749,8 +2159,18 @@ RIT128x96x4Enable(unsigned long ulFrequency)
     SSIEnable(SSI0_BASE);
 
     //
-    // Indicate that the RIT driver can use the SSI Port.
+    // Enable the SSI interrupt that drains the transmit queue.  The transmit
+    // FIFO interrupt itself is only turned on while there are bytes queued.
     //
+    SSIIntDisable(SSI0_BASE, SSI_TXFF);
+    IntEnable(INT_SSI0);
+
+    //
+    // Indicate that the RIT driver can use the SSI Port.  Commands are dropped
+    // while the port is disabled, so the addressing mirror may be stale.
+    //
+    HWREGBITW(&g_ulSSIFlags, FLAG_REMAP_VALID) = 0;
+    HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) = 0;
     HWREGBITW(&g_ulSSIFlags, FLAG_SSI_ENABLED) = 1;
 }
 
@@ -773,6 +2193,12 @@ RIT128x96x4Disable(void)
     //
     HWREGBITW(&g_ulSSIFlags, FLAG_SSI_ENABLED) = 0;
 
+    //
+    // Send anything that is still in the transmit queue.
+    //
+    RITQueueWait();
+    IntDisable(INT_SSI0);
+
     //
     // Wait until the SSI port is no longer busy.
     //
@@ -866,6 +2292,13 @@ RIT128x96x4Init(unsigned long ulFrequency)
         RITWriteCommand(g_pucRIT128x96x4Init + ulIdx + 1,
                         g_pucRIT128x96x4Init[ulIdx] - 1);
     }
+
+    //
+    // The initialization sequence changes the remap setting behind the back
+    // of the addressing mirror.
+    //
+    HWREGBITW(&g_ulSSIFlags, FLAG_REMAP_VALID) = 0;
+    HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) = 0;
 }
 
 //*****************************************************************************
@@ -896,6 +2329,13 @@ RIT128x96x4DisplayOn(void)
         RITWriteCommand(g_pucRIT128x96x4Init + ulIdx + 1,
                         g_pucRIT128x96x4Init[ulIdx] - 1);
     }
+
+    //
+    // The initialization sequence changes the remap setting behind the back
+    // of the addressing mirror.
+    //
+    HWREGBITW(&g_ulSSIFlags, FLAG_REMAP_VALID) = 0;
+    HWREGBITW(&g_ulSSIFlags, FLAG_WINDOW_VALID) = 0;
 }
 
 //*****************************************************************************
@@ -0,0 +1,165 @@
+//*****************************************************************************
+//
+// rit128x96x4.h - Prototypes for the driver for the RITEK 128x96x4 graphical
+//                 OLED display.
+//
+// Copyright (c) 2007-2013 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 10007 of the EK-LM3S8962 Firmware Package.
+//
+//*****************************************************************************
+
+
+#ifndef __RIT128X96X4_H__
+#define __RIT128X96X4_H__
+
+//*****************************************************************************
+//
+//! An image that is moved around the display.  The driver remembers where the
+//! sprite was last drawn so that moving it only erases the part of its old
+//! position that the new position does not cover.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! A pointer to the image data, in the format used by
+    //! RIT128x96x4ImageDraw().
+    //
+    const unsigned char *pucImage;
+
+    //
+    //! The width of the image, in columns.
+    //
+    unsigned long ulWidth;
+
+    //
+    //! The height of the image, in rows.
+    //
+    unsigned long ulHeight;
+
+    //
+    //! The horizontal position at which the sprite was last drawn.
+    //
+    unsigned long ulX;
+
+    //
+    //! The vertical position at which the sprite was last drawn.
+    //
+    unsigned long ulY;
+
+    //
+    //! Indicates whether the sprite is currently drawn on the display.
+    //
+    tBoolean bVisible;
+}
+tRITSprite;
+
+//*****************************************************************************
+//
+//! Counts of the activity on the SSI bus to the display, as kept by the
+//! driver for each frame.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of bytes queued for the display, both command and data.
+    //
+    unsigned long ulBytes;
+
+    //
+    //! The number of command sequences queued for the display.
+    //
+    unsigned long ulCommands;
+
+    //
+    //! The number of times the D/C line was switched between command and
+    //! data.
+    //
+    unsigned long ulDCToggles;
+
+    //
+    //! The number of times SSIBusy() was polled while waiting to switch the
+    //! D/C line.
+    //
+    unsigned long ulBusySpins;
+}
+tRITBusStats;
+
+//*****************************************************************************
+//
+// The fastest SSI clock that the SSD1329 takes: its serial clock cycle time
+// must be at least 250ns.  RIT128x96x4Enable() never sets a faster one.
+//
+//*****************************************************************************
+#define RIT_SSI_CLOCK_MAX       4000000
+
+//*****************************************************************************
+//
+// The number of sections that a frame can be split into for the SSI bus
+// accounting.
+//
+//*****************************************************************************
+#define RIT_BUS_SECTIONS        8
+
+//*****************************************************************************
+//
+// Prototypes for the driver APIs.
+//
+//*****************************************************************************
+extern void RIT128x96x4Clear(void);
+extern void RIT128x96x4StringDraw(const char *pcStr,
+                                  unsigned long ulX,
+                                  unsigned long ulY,
+                                  unsigned char ucLevel);
+extern void RIT128x96x4ImageDraw(const unsigned char *pucImage,
+                                 unsigned long ulX,
+                                 unsigned long ulY,
+                                 unsigned long ulWidth,
+                                 unsigned long ulHeight);
+extern void RIT128x96x4SpriteInit(tRITSprite *psSprite,
+                                  const unsigned char *pucImage,
+                                  unsigned long ulWidth,
+                                  unsigned long ulHeight);
+extern void RIT128x96x4SpriteMove(tRITSprite *psSprite,
+                                  unsigned long ulX,
+                                  unsigned long ulY);
+extern void RIT128x96x4SpriteHide(tRITSprite *psSprite);
+extern void RIT128x96x4Flush(void);
+extern void RIT128x96x4Wait(void);
+extern unsigned long RIT128x96x4SSIClockGet(void);
+extern void RIT128x96x4CommandCountGet(unsigned long *pulSent,
+                                       unsigned long *pulSkipped);
+extern void RIT128x96x4BusSectionSet(unsigned long ulSection,
+                                     const char *pcName);
+extern void RIT128x96x4BusFrameEnd(void);
+extern void RIT128x96x4BusStatsReset(void);
+extern unsigned long RIT128x96x4BusStatsGet(tRITBusStats *psLast,
+                                            tRITBusStats *psPeak,
+                                            tRITBusStats *psTotal);
+extern const char *RIT128x96x4BusSectionGet(unsigned long ulSection,
+                                            tRITBusStats *psPeak,
+                                            tRITBusStats *psTotal);
+extern void RIT128x96x4Init(unsigned long ulFrequency);
+extern void RIT128x96x4Enable(unsigned long ulFrequency);
+extern void RIT128x96x4Disable(void);
+extern void RIT128x96x4DisplayOn(void);
+extern void RIT128x96x4DisplayOff(void);
+extern void RIT128x96x4IntHandler(void);
+
+#endif // __RIT128X96X4_H__
@@ -0,0 +1,95 @@
+//*****************************************************************************
+//
+// hal.h - Hardware abstraction layer for Pong.
+//
+// The game only talks to the hardware through these functions, so that the
+// same game code can run on the LM3S8962 (hal_lm3s8962.c) or on a Linux host
+// (host/hal_host.c).
+//
+// The game supplies the handlers that the HAL calls:
+//
+// * SysTickIntHandler() once per game tick.
+// * GPIOEIntHandler() when a button is pressed.
+// * PendSVIntHandler() after HalRenderRequest(), once no game tick is running.
+//
+// The host also calls GameReport() at the end of a run, to print what the game
+// has counted.
+//
+// HalPrintf() prints to UART0 on the board, at 115200 baud, and to the
+// standard output on the host.  It has the conversions of UARTprintf().
+//
+//*****************************************************************************
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+//*****************************************************************************
+//
+// The buttons returned by HalInputRead().
+//
+//*****************************************************************************
+#define HAL_BUTTON_UP           0x01
+#define HAL_BUTTON_DOWN         0x02
+#define HAL_BUTTON_LEFT         0x04
+#define HAL_BUTTON_RIGHT        0x08
+
+//*****************************************************************************
+//
+// The word that the stack is painted with at reset, so that HalStackUsed()
+// can find the deepest that it has been used.
+//
+//*****************************************************************************
+#define HAL_STACK_PAINT         0xdeadbeef
+
+//*****************************************************************************
+//
+// The processor clock levels that HalClockLevelSet() switches between.
+// HalInit() starts at HAL_CLOCK_FULL, 50MHz from the PLL.  HAL_CLOCK_LOW and
+// HAL_CLOCK_MIN run from the 8MHz crystal at 8MHz and 2MHz, with the PLL
+// turned off.
+//
+//*****************************************************************************
+#define HAL_CLOCK_FULL          0
+#define HAL_CLOCK_LOW           1
+#define HAL_CLOCK_MIN           2
+#define HAL_CLOCK_LEVELS        3
+
+//*****************************************************************************
+//
+// The storage class of the game's state.  The host's tuner plays a match on
+// each of its threads, and builds with -DHAL_THREAD_LOCAL=__thread so that
+// each thread has its own copy of the game.  Everywhere else it is empty.
+//
+//*****************************************************************************
+#ifndef HAL_THREAD_LOCAL
+#define HAL_THREAD_LOCAL
+#endif
+
+//*****************************************************************************
+//
+// Prototypes for the HAL.
+//
+//*****************************************************************************
+extern void HalCycleCountStart(void);
+extern void HalInit(void);
+extern void HalTimerInit(unsigned long ulTicksPerSecond);
+extern void HalInputInit(void);
+extern unsigned long HalInputRead(void);
+extern void HalDisplayInit(void);
+extern void HalRenderInit(void);
+extern void HalRenderRequest(void);
+extern int HalRandom(void);
+extern unsigned long HalClockGet(void);
+extern unsigned long HalClockLevelRate(unsigned long ulLevel);
+extern void HalClockLevelSet(unsigned long ulLevel);
+extern unsigned long HalCycleCount(void);
+extern unsigned long HalCriticalEnter(void);
+extern void HalCriticalExit(unsigned long ulState);
+extern void HalPrintf(const char *pcFormat, ...);
+extern unsigned long HalStackUsed(unsigned long *pulSize);
+extern void HalStart(void);
+extern void HalIdle(void);
+extern unsigned long HalSleepCycles(void);
+extern void HalDeepSleep(void);
+
+#endif // __HAL_H__
@@ -0,0 +1,526 @@
+//*****************************************************************************
+//
+// hal_lm3s8962.c - LM3S8962 implementation of the Pong HAL.
+//
+// The game tick is the SysTick interrupt, the buttons are the push buttons on
+// GPIO port E, the display is the RIT OLED and drawing is done from PendSV.
+// The main loop sleeps with WFI between interrupts.  The processor clock can
+// be switched between the PLL and the crystal while the game runs.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/systick.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "drivers/rit128x96x4.h"
+#include "utils/ustdlib.h"
+#include "hal.h"
+
+//*****************************************************************************
+//
+// The push buttons on GPIO port E.
+//
+//*****************************************************************************
+#define BUTTON_PINS             (GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 |       \
+                                 GPIO_PIN_3)
+
+//*****************************************************************************
+//
+// The SSI clock for the display, which is as fast as it takes.  The driver
+// uses the fastest clock that it can make from the system clock that is no
+// faster than this.
+//
+//*****************************************************************************
+#define DISPLAY_SSI_CLOCK       RIT_SSI_CLOCK_MAX
+
+//*****************************************************************************
+//
+// The baud rate of UART0, which HalPrintf() prints to.
+//
+//*****************************************************************************
+#define UART_BAUD               115200
+
+//*****************************************************************************
+//
+// The SysCtlClockSet() settings and the resulting clock for each clock level.
+//
+//*****************************************************************************
+static const unsigned long g_pulClockConfig[HAL_CLOCK_LEVELS] =
+{
+    SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ,
+    SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ,
+    SYSCTL_SYSDIV_4 | SYSCTL_USE_OSC | SYSCTL_OSC_MAIN | SYSCTL_XTAL_8MHZ
+};
+static const unsigned long g_pulClockRate[HAL_CLOCK_LEVELS] =
+{
+    50000000,
+    8000000,
+    2000000
+};
+
+//*****************************************************************************
+//
+// The registers used to run the DWT cycle counter.
+//
+//*****************************************************************************
+#define DEMCR                   0xE000EDFC  // Debug Exception and Monitor Ctl
+#define DEMCR_TRCENA            0x01000000  // Enable DWT and ITM
+#define DWT_CTRL                0xE0001000  // DWT Control
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable CYCCNT
+#define DWT_CYCCNT              0xE0001004  // DWT Cycle Count
+
+//*****************************************************************************
+//
+// The bottom and top of the stack, from the linker.  ResetISR() paints the
+// stack with HAL_STACK_PAINT.
+//
+//*****************************************************************************
+extern unsigned long __stack;
+extern unsigned long __STACK_TOP;
+
+//*****************************************************************************
+//
+// The clock that the processor runs from out of reset, which is the 12MHz
+// internal oscillator.
+//
+//*****************************************************************************
+#define RESET_CLOCK             12000000
+
+//*****************************************************************************
+//
+// The system clock speed.
+//
+//*****************************************************************************
+volatile unsigned long g_ulSystemClock = RESET_CLOCK;
+
+//*****************************************************************************
+//
+// The tick rate and SysTick period, and the number of cycles that HalIdle()
+// has slept for.
+//
+//*****************************************************************************
+static unsigned long g_ulTicksPerSecond;
+static unsigned long g_ulTickPeriod;
+static volatile unsigned long g_ulSleepCycles;
+
+//*****************************************************************************
+//
+// Sets UART0 to UART_BAUD at the current system clock.
+//
+//*****************************************************************************
+static void
+HalUARTConfig(void)
+{
+    UARTConfigSetExpClk(UART0_BASE, g_ulSystemClock, UART_BAUD,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+}
+
+//*****************************************************************************
+//
+// Starts the DWT cycle counter from zero.  ResetISR() calls this before the C
+// runtime has been set up, so that the boot can be timed from reset; it must
+// only touch registers.
+//
+//*****************************************************************************
+void
+HalCycleCountStart(void)
+{
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Sets the clocking to run at 50MHz from the PLL.
+//
+//*****************************************************************************
+void
+HalInit(void)
+{
+    SysCtlClockSet(g_pulClockConfig[HAL_CLOCK_FULL]);
+
+    //
+    // Get the system clock speed.
+    //
+    g_ulSystemClock = SysCtlClockGet();
+
+    //
+    // Set up UART0 on PA0 and PA1 for HalPrintf().
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    HalUARTConfig();
+}
+
+//*****************************************************************************
+//
+// Sets up the SysTick timer to interrupt ulTicksPerSecond times a second.
+// It is not started until HalStart().
+//
+//*****************************************************************************
+void
+HalTimerInit(unsigned long ulTicksPerSecond)
+{
+    g_ulTicksPerSecond = ulTicksPerSecond;
+    g_ulTickPeriod = g_ulSystemClock / ulTicksPerSecond;
+    SysTickPeriodSet(g_ulTickPeriod);
+    SysTickIntEnable();
+}
+
+//*****************************************************************************
+//
+// Configures the push buttons as inputs that interrupt on the falling edge
+// (i.e. when the push button is pressed).
+//
+//*****************************************************************************
+void
+HalInputInit(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+
+    GPIOPinTypeGPIOInput(GPIO_PORTE_BASE, BUTTON_PINS);
+    GPIOPadConfigSet(GPIO_PORTE_BASE, BUTTON_PINS, GPIO_STRENGTH_2MA,
+                     GPIO_PIN_TYPE_STD_WPU);
+    GPIOIntTypeSet(GPIO_PORTE_BASE, BUTTON_PINS, GPIO_FALLING_EDGE);
+    GPIOPinIntEnable(GPIO_PORTE_BASE, BUTTON_PINS);
+}
+
+//*****************************************************************************
+//
+// Acknowledges the button interrupt and returns the buttons that are held
+// down.  The buttons are active low.
+//
+//*****************************************************************************
+unsigned long
+HalInputRead(void)
+{
+    GPIOPinIntClear(GPIO_PORTE_BASE, BUTTON_PINS);
+
+    return((GPIOPinRead(GPIO_PORTE_BASE, BUTTON_PINS) & 0x0f) ^ 0x0f);
+}
+
+//*****************************************************************************
+//
+// Initializes the OLED display.
+//
+//*****************************************************************************
+void
+HalDisplayInit(void)
+{
+    RIT128x96x4Init(DISPLAY_SSI_CLOCK);
+}
+
+//*****************************************************************************
+//
+// Drawing happens in the PendSV handler, which must be able to be interrupted
+// by the game, so give it the lowest priority.
+//
+//*****************************************************************************
+void
+HalRenderInit(void)
+{
+    IntPrioritySet(FAULT_PENDSV, 0xe0);
+}
+
+//*****************************************************************************
+//
+// Asks for the PendSV handler to run once the current interrupt returns.
+//
+//*****************************************************************************
+void
+HalRenderRequest(void)
+{
+    IntPendSet(FAULT_PENDSV);
+}
+
+//*****************************************************************************
+//
+// Returns a random number from the C library.
+//
+//*****************************************************************************
+int
+HalRandom(void)
+{
+    return(rand());
+}
+
+//*****************************************************************************
+//
+// Returns the processor clock, which is the rate that HalCycleCount() counts
+// at.
+//
+//*****************************************************************************
+unsigned long
+HalClockGet(void)
+{
+    return(g_ulSystemClock);
+}
+
+//*****************************************************************************
+//
+// Returns the processor clock at a clock level.
+//
+//*****************************************************************************
+unsigned long
+HalClockLevelRate(unsigned long ulLevel)
+{
+    return(g_pulClockRate[ulLevel]);
+}
+
+//*****************************************************************************
+//
+// Switches the processor clock to a clock level.  The SysTick period, the SSI
+// clock divider of the display and the UART baud rate divider are all worked
+// out again for the new clock.  The ticks and the UART keep the same rates,
+// and the display runs as fast as the new clock allows.  The DWT cycle counter
+// carries on counting at the new clock.
+//
+// The display and UART finish sending what they have at the old clock first.
+// The current tick keeps the time it had left, so the ticks stay on the same
+// schedule; only the time taken by the switch itself is lost, which is at most
+// the PLL lock time when switching back to the PLL.
+//
+// This must only be called from the main loop, since it waits for the display
+// and the UART.  Interrupts are turned off while the clock is switched.
+//
+//*****************************************************************************
+void
+HalClockLevelSet(unsigned long ulLevel)
+{
+    unsigned long ulState, ulLeft, ulOldPeriod;
+
+    while(UARTBusy(UART0_BASE))
+    {
+    }
+
+    ulState = HalCriticalEnter();
+
+    RIT128x96x4Disable();
+
+    ulLeft = SysTickValueGet();
+    ulOldPeriod = g_ulTickPeriod;
+
+    SysCtlClockSet(g_pulClockConfig[ulLevel]);
+    g_ulSystemClock = SysCtlClockGet();
+    g_ulTickPeriod = g_ulSystemClock / g_ulTicksPerSecond;
+
+    //
+    // Start SysTick counting down what was left of the tick, in cycles of the
+    // new clock.  Writing the current value makes SysTick load it from the
+    // reload register on the next cycle; once it has, the reload register is
+    // put back to the full period for the ticks after this one.
+    //
+    ulLeft = (unsigned long)(((unsigned long long)ulLeft * g_ulTickPeriod) /
+                             ulOldPeriod);
+    SysTickPeriodSet((ulLeft < 2) ? 2 : ulLeft);
+    HWREG(NVIC_ST_CURRENT) = 0;
+    while(SysTickValueGet() == 0)
+    {
+    }
+    SysTickPeriodSet(g_ulTickPeriod);
+
+    RIT128x96x4Enable(DISPLAY_SSI_CLOCK);
+    HalUARTConfig();
+
+    HalCriticalExit(ulState);
+}
+
+//*****************************************************************************
+//
+// Returns the number of processor cycles since reset.  It wraps around every
+// 2^32 cycles.
+//
+// The DWT cycle counter stops while HalIdle() sleeps, so the cycles slept for
+// are added back in.  Without them, a tick that was late because of an
+// overrun would look closer to the last one than it was, whenever the main
+// loop had slept in between, and the trace's times would be squeezed up.
+// HalIdle() adds to the sleep count with interrupts turned off, so a handler
+// always sees the count for every sleep before it.  Deep sleep is not counted,
+// since the tick is stopped then.
+//
+//*****************************************************************************
+unsigned long
+HalCycleCount(void)
+{
+    return(HWREG(DWT_CYCCNT) + g_ulSleepCycles);
+}
+
+//*****************************************************************************
+//
+// Turns off interrupts, and returns whether they were already off so that
+// HalCriticalExit() can put them back the way they were.
+//
+//*****************************************************************************
+unsigned long
+HalCriticalEnter(void)
+{
+    return(IntMasterDisable());
+}
+
+//*****************************************************************************
+//
+// Turns interrupts back on, unless they were already off when the matching
+// HalCriticalEnter() was called.
+//
+//*****************************************************************************
+void
+HalCriticalExit(unsigned long ulState)
+{
+    if(!ulState)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+// Prints to UART0, waiting for room in the FIFO.  Each newline is sent as a
+// carriage return and line feed, the way UARTprintf() does.  This must only
+// be called from the main loop, since it can wait for a long time.  That also
+// means the buffer can be static, which keeps it off the small stack.
+//
+//*****************************************************************************
+void
+HalPrintf(const char *pcFormat, ...)
+{
+    static char pcBuffer[128];
+    char *pcChar;
+    va_list vaArgP;
+
+    va_start(vaArgP, pcFormat);
+    uvsnprintf(pcBuffer, sizeof(pcBuffer), pcFormat, vaArgP);
+    va_end(vaArgP);
+
+    for(pcChar = pcBuffer; *pcChar; pcChar++)
+    {
+        if(*pcChar == '\n')
+        {
+            UARTCharPut(UART0_BASE, '\r');
+        }
+        UARTCharPut(UART0_BASE, *pcChar);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the most bytes of the stack that have ever been used, which is
+// everything above the lowest word that no longer holds the paint.  The size
+// of the stack is returned in *pulSize if pulSize is not 0.
+//
+//*****************************************************************************
+unsigned long
+HalStackUsed(unsigned long *pulSize)
+{
+    unsigned long *pulStack;
+
+    if(pulSize)
+    {
+        *pulSize = (unsigned long)&__STACK_TOP - (unsigned long)&__stack;
+    }
+
+    for(pulStack = &__stack;
+        (pulStack < &__STACK_TOP) && (*pulStack == HAL_STACK_PAINT);
+        pulStack++)
+    {
+    }
+
+    return((unsigned long)&__STACK_TOP - (unsigned long)pulStack);
+}
+
+//*****************************************************************************
+//
+// Starts the game tick and enables the interrupts.  The first tick is run
+// straight away rather than a period later, so that the first frame is drawn
+// as soon as possible.
+//
+//*****************************************************************************
+void
+HalStart(void)
+{
+    SysTickEnable();
+    IntPendSet(FAULT_SYSTICK);
+    IntMasterEnable();
+    IntEnable(INT_GPIOE);
+}
+
+//*****************************************************************************
+//
+// Called over and over from the main loop.  Everything happens in interrupt
+// handlers, so this sleeps until the next interrupt.
+//
+// Interrupts are turned off around the WFI so that the time asleep can be read
+// from SysTick before the handler that woke the processor runs; WFI still
+// wakes on an interrupt that is masked this way.  The DWT cycle counter stops
+// while the processor sleeps, but SysTick does not, so HalCycleCount() adds the
+// time asleep back in from the count kept here.  The processor is never asleep
+// for longer than a tick, since SysTick wakes it.
+//
+//*****************************************************************************
+void
+HalIdle(void)
+{
+    unsigned long ulStart, ulEnd;
+
+    IntMasterDisable();
+
+    ulStart = SysTickValueGet();
+    SysCtlSleep();
+    ulEnd = SysTickValueGet();
+
+    //
+    // SysTick counts down, and may have wrapped once.
+    //
+    g_ulSleepCycles += (ulStart + g_ulTickPeriod - ulEnd) % g_ulTickPeriod;
+
+    IntMasterEnable();
+}
+
+//*****************************************************************************
+//
+// Returns the number of cycles that HalIdle() has slept for.  It wraps around
+// every 2^32 cycles.
+//
+//*****************************************************************************
+unsigned long
+HalSleepCycles(void)
+{
+    return(g_ulSleepCycles);
+}
+
+//*****************************************************************************
+//
+// Turns off the display and the game tick and puts the processor into deep
+// sleep, where the PLL is turned off, until a button is pressed.  The button
+// interrupt is the only one left enabled.  The run mode clocks are used in
+// deep sleep since automatic clock gating is not turned on, so GPIO port E
+// stays clocked and can wake the processor.  When it wakes, the hardware goes
+// back to the run mode clock, relocking the PLL if it was in use, and the
+// display and tick are turned back on.
+//
+// This must only be called from the main loop.
+//
+//*****************************************************************************
+void
+HalDeepSleep(void)
+{
+    SysTickDisable();
+    RIT128x96x4DisplayOff();
+    RIT128x96x4Disable();
+
+    SysCtlDeepSleep();
+
+    RIT128x96x4Enable(DISPLAY_SSI_CLOCK);
+    RIT128x96x4DisplayOn();
+    SysTickEnable();
+}
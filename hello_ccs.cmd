@@ -31,7 +31,7 @@
 /* modifications in your CCS project and leave this file alone.              */
 /*                                                                           */
 /* --heap_size=0                                                             */
-/* --stack_size=256                                                          */
+/* --stack_size=1536                                                         */
 /* --library=rtsv7M3_T_le_eabi.lib                                           */
 
 /* The starting address of the application.  Normally the interrupt vectors  */
@@ -67,4 +67,7 @@ SECTIONS
     .stack  :   > SRAM
 }
 
-__STACK_TOP = __stack + 256;
+/* The top of the stack, which must match --stack_size in the CCS project.   */
+/* host/tools/stackdepth.c gives 1196 bytes for the deepest nesting of the   */
+/* handlers (see README.md), and this leaves about a quarter over that.      */
+__STACK_TOP = __stack + 1536;
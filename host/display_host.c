@@ -0,0 +1,511 @@
+//*****************************************************************************
+//
+// display_host.c - Host model of the SSD1329 controller on the RIT OLED.
+//
+// The bytes that the RIT driver sends over SSI are interpreted the way the
+// SSD1329 would: command bytes (D/C low) with their parameters, and data bytes
+// (D/C high) that are written to the display RAM at the current address.  The
+// display RAM is 128 rows of 64 bytes, of which the RIT panel shows 96 rows.
+//
+// The controller state that changes what is written where, or what the panel
+// shows, is modelled:
+//
+// * 0x15 and 0x75, the column and row address windows.
+// * 0xA0, the re-map.  The address increment direction, nibble re-map and
+//   column address re-map are modelled; the COM settings are how the panel is
+//   wired, and are taken to be the ones the driver always uses.
+// * 0xA1 and 0xA2, the display start line and offset.
+// * 0xA4 to 0xA7, the display mode (normal, all on, all off, inverse).
+// * 0xAE and 0xAF, display off and on.
+// * 0xFD, the command lock.
+//
+// Every other command is skipped over along with its parameters.  The number
+// of times each command is sent, and the bytes that it takes, are counted.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include "inc/hw_types.h"
+#include "host/display_host.h"
+
+//*****************************************************************************
+//
+// The display RAM, as the bytes were stored.  With the nibble re-map off, the
+// lower nibble of a byte is the even segment and the upper nibble is the odd
+// segment.
+//
+//*****************************************************************************
+static unsigned char g_pucRAM[128][64];
+
+//*****************************************************************************
+//
+// The bits of the re-map parameter.
+//
+//*****************************************************************************
+#define REMAP_COLUMN            0x01
+#define REMAP_NIBBLE            0x02
+#define REMAP_VERTICAL_INC      0x04
+
+//*****************************************************************************
+//
+// The controller state, with the values it has after a reset.
+//
+//*****************************************************************************
+static unsigned long g_ulColumnStart = 0;
+static unsigned long g_ulColumnEnd = 63;
+static unsigned long g_ulRowStart = 0;
+static unsigned long g_ulRowEnd = 127;
+static unsigned long g_ulColumn = 0;
+static unsigned long g_ulRow = 0;
+static unsigned long g_ulRemap = 0;
+static unsigned long g_ulStartLine = 0;
+static unsigned long g_ulOffset = 0;
+static unsigned long g_ulMode = 0xA4;
+static tBoolean g_bDisplayOn = false;
+static tBoolean g_bLocked = false;
+
+//*****************************************************************************
+//
+// The command being received, and its parameters so far.
+//
+//*****************************************************************************
+static long g_lCommand = -1;
+static unsigned long g_ulParamCount;
+static unsigned long g_ulParamIndex;
+static unsigned char g_pucParams[16];
+
+//*****************************************************************************
+//
+// The number of times each command was sent, the bytes sent for each command
+// (including its parameters), the number of data bytes, and the number of
+// bytes of any kind.
+//
+//*****************************************************************************
+static unsigned long g_pulCommandCount[256];
+static unsigned long g_pulCommandBytes[256];
+static unsigned long g_ulDataBytes;
+static unsigned long g_ulBytes;
+
+//*****************************************************************************
+//
+// Returns the number of parameter bytes that follow a command byte.
+//
+//*****************************************************************************
+static unsigned long
+HostDisplayParamCount(unsigned char ucCommand)
+{
+    switch(ucCommand)
+    {
+        case 0x15:
+        case 0x75:
+        {
+            return(2);
+        }
+
+        case 0x81:
+        case 0x82:
+        case 0x94:
+        case 0xA0:
+        case 0xA1:
+        case 0xA2:
+        case 0xA8:
+        case 0xB1:
+        case 0xB2:
+        case 0xB3:
+        case 0xBB:
+        case 0xBC:
+        case 0xBE:
+        case 0xFD:
+        {
+            return(1);
+        }
+
+        case 0xB8:
+        {
+            return(15);
+        }
+
+        default:
+        {
+            return(0);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the name of a command, for the report.
+//
+//*****************************************************************************
+static const char *
+HostDisplayCommandName(unsigned char ucCommand)
+{
+    switch(ucCommand)
+    {
+        case 0x15: return("column address");
+        case 0x75: return("row address");
+        case 0x81: return("contrast");
+        case 0x82: return("pre-charge current");
+        case 0x94: return("icon");
+        case 0xA0: return("re-map");
+        case 0xA1: return("start line");
+        case 0xA2: return("display offset");
+        case 0xA4: return("normal display");
+        case 0xA5: return("all on");
+        case 0xA6: return("all off");
+        case 0xA7: return("inverse display");
+        case 0xA8: return("multiplex ratio");
+        case 0xAE: return("display off");
+        case 0xAF: return("display on");
+        case 0xB1: return("phase length");
+        case 0xB2: return("frame frequency");
+        case 0xB3: return("clock divider");
+        case 0xB7: return("default gray scale");
+        case 0xB8: return("gray scale table");
+        case 0xBB: return("second pre-charge");
+        case 0xBC: return("pre-charge voltage");
+        case 0xBE: return("VCOMH");
+        case 0xE3: return("no operation");
+        case 0xFD: return("command lock");
+        default:   return("unknown");
+    }
+}
+
+//*****************************************************************************
+//
+// Carries out a command once all of its parameters have been received.
+//
+//*****************************************************************************
+static void
+HostDisplayCommand(unsigned char ucCommand, const unsigned char *pucParams)
+{
+    //
+    // While the commands are locked, only the unlock command is accepted.
+    //
+    if(g_bLocked && (ucCommand != 0xFD))
+    {
+        return;
+    }
+
+    switch(ucCommand)
+    {
+        //
+        // Set the column address window.
+        //
+        case 0x15:
+        {
+            g_ulColumnStart = pucParams[0] & 0x3f;
+            g_ulColumnEnd = pucParams[1] & 0x3f;
+            g_ulColumn = g_ulColumnStart;
+            break;
+        }
+
+        //
+        // Set the row address window.
+        //
+        case 0x75:
+        {
+            g_ulRowStart = pucParams[0] & 0x7f;
+            g_ulRowEnd = pucParams[1] & 0x7f;
+            g_ulRow = g_ulRowStart;
+            break;
+        }
+
+        //
+        // Re-map.
+        //
+        case 0xA0:
+        {
+            g_ulRemap = pucParams[0];
+            break;
+        }
+
+        //
+        // Display start line and offset.
+        //
+        case 0xA1:
+        {
+            g_ulStartLine = pucParams[0] & 0x7f;
+            break;
+        }
+        case 0xA2:
+        {
+            g_ulOffset = pucParams[0] & 0x7f;
+            break;
+        }
+
+        //
+        // Display mode.
+        //
+        case 0xA4:
+        case 0xA5:
+        case 0xA6:
+        case 0xA7:
+        {
+            g_ulMode = ucCommand;
+            break;
+        }
+
+        //
+        // Display off and on.
+        //
+        case 0xAE:
+        case 0xAF:
+        {
+            g_bDisplayOn = (ucCommand == 0xAF) ? true : false;
+            break;
+        }
+
+        //
+        // Command lock.  0x16 locks and 0x12 unlocks.
+        //
+        case 0xFD:
+        {
+            g_bLocked = ((pucParams[0] & 0x16) == 0x16) ? true : false;
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Writes a data byte at the current address, and moves the address on to the
+// next byte in the window.
+//
+//*****************************************************************************
+static void
+HostDisplayData(unsigned char ucByte)
+{
+    //
+    // With the nibble re-map on, the upper nibble of the data goes to the even
+    // segment.
+    //
+    if(g_ulRemap & REMAP_NIBBLE)
+    {
+        ucByte = (ucByte << 4) | (ucByte >> 4);
+    }
+    g_pucRAM[g_ulRow][g_ulColumn] = ucByte;
+
+    if(g_ulRemap & REMAP_VERTICAL_INC)
+    {
+        if(++g_ulRow > g_ulRowEnd)
+        {
+            g_ulRow = g_ulRowStart;
+            if(++g_ulColumn > g_ulColumnEnd)
+            {
+                g_ulColumn = g_ulColumnStart;
+            }
+        }
+    }
+    else
+    {
+        if(++g_ulColumn > g_ulColumnEnd)
+        {
+            g_ulColumn = g_ulColumnStart;
+            if(++g_ulRow > g_ulRowEnd)
+            {
+                g_ulRow = g_ulRowStart;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Receives a byte shifted out over SSI.  bData is the state of the D/C line,
+// which is high for data bytes and low for command bytes.
+//
+//*****************************************************************************
+void
+HostDisplayWrite(tBoolean bData, unsigned char ucByte)
+{
+    g_ulBytes++;
+
+    if(bData)
+    {
+        g_ulDataBytes++;
+        HostDisplayData(ucByte);
+        return;
+    }
+
+    //
+    // Start a new command, or add a parameter to the one being received.
+    //
+    if(g_lCommand < 0)
+    {
+        g_lCommand = ucByte;
+        g_ulParamCount = HostDisplayParamCount(ucByte);
+        g_ulParamIndex = 0;
+        g_pulCommandCount[ucByte]++;
+    }
+    else
+    {
+        g_pucParams[g_ulParamIndex++] = ucByte;
+    }
+    g_pulCommandBytes[g_lCommand]++;
+
+    if(g_ulParamIndex == g_ulParamCount)
+    {
+        HostDisplayCommand(g_lCommand, g_pucParams);
+        g_lCommand = -1;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the gray level (0 to 15) that the panel shows at a pixel, with the
+// left column and top row being zero.
+//
+//*****************************************************************************
+unsigned long
+HostDisplayPixelGet(unsigned long ulX, unsigned long ulY)
+{
+    unsigned long ulRow, ulSegment;
+    unsigned char ucByte;
+
+    //
+    // A display that is off, or in one of the all off or all on modes, does
+    // not show the display RAM.
+    //
+    if(!g_bDisplayOn || (g_ulMode == 0xA6))
+    {
+        return(0);
+    }
+    if(g_ulMode == 0xA5)
+    {
+        return(15);
+    }
+
+    //
+    // Find the display RAM row and segment that are shown at the pixel.
+    //
+    ulRow = (ulY + g_ulStartLine + g_ulOffset) & 127;
+    ulSegment = (g_ulRemap & REMAP_COLUMN) ? (127 - ulX) : ulX;
+
+    ucByte = g_pucRAM[ulRow][ulSegment / 2];
+    ucByte = (ulSegment & 1) ? (ucByte >> 4) : (ucByte & 0x0f);
+
+    return((g_ulMode == 0xA7) ? (15 - ucByte) : ucByte);
+}
+
+//*****************************************************************************
+//
+// Returns an FNV-1a hash of what the panel shows, so that the frames from two
+// runs can be compared.
+//
+//*****************************************************************************
+unsigned long
+HostDisplayHash(void)
+{
+    unsigned long ulHash, ulX, ulY;
+
+    ulHash = 2166136261UL;
+    for(ulY = 0; ulY < HOST_DISPLAY_HEIGHT; ulY++)
+    {
+        for(ulX = 0; ulX < HOST_DISPLAY_WIDTH; ulX++)
+        {
+            ulHash = ((ulHash ^ HostDisplayPixelGet(ulX, ulY)) * 16777619UL) &
+                     0xffffffff;
+        }
+    }
+
+    return(ulHash);
+}
+
+//*****************************************************************************
+//
+// Writes what the panel shows to a binary PGM file with 16 gray levels.
+// Returns false if the file could not be written.
+//
+//*****************************************************************************
+tBoolean
+HostDisplayDump(const char *pcFilename)
+{
+    unsigned long ulX, ulY;
+    FILE *pFile;
+
+    pFile = fopen(pcFilename, "wb");
+    if(!pFile)
+    {
+        return(false);
+    }
+
+    fprintf(pFile, "P5\n%d %d\n15\n", HOST_DISPLAY_WIDTH, HOST_DISPLAY_HEIGHT);
+    for(ulY = 0; ulY < HOST_DISPLAY_HEIGHT; ulY++)
+    {
+        for(ulX = 0; ulX < HOST_DISPLAY_WIDTH; ulX++)
+        {
+            fputc(HostDisplayPixelGet(ulX, ulY), pFile);
+        }
+    }
+
+    return(fclose(pFile) == 0);
+}
+
+//*****************************************************************************
+//
+// Returns the number of times a command was sent, and the bytes it took
+// including its parameters.
+//
+//*****************************************************************************
+unsigned long
+HostDisplayCommandCountGet(unsigned char ucCommand, unsigned long *pulBytes)
+{
+    if(pulBytes)
+    {
+        *pulBytes = g_pulCommandBytes[ucCommand];
+    }
+
+    return(g_pulCommandCount[ucCommand]);
+}
+
+//*****************************************************************************
+//
+// Returns the number of data bytes that were sent.
+//
+//*****************************************************************************
+unsigned long
+HostDisplayDataCountGet(void)
+{
+    return(g_ulDataBytes);
+}
+
+//*****************************************************************************
+//
+// Returns the number of bytes, commands and data, that were sent.
+//
+//*****************************************************************************
+unsigned long
+HostDisplayByteCountGet(void)
+{
+    return(g_ulBytes);
+}
+
+//*****************************************************************************
+//
+// Prints the number of times each command was sent and the bytes it took,
+// followed by the data bytes.
+//
+//*****************************************************************************
+void
+HostDisplayReport(void)
+{
+    unsigned long ulCommand;
+
+    for(ulCommand = 0; ulCommand < 256; ulCommand++)
+    {
+        if(g_pulCommandCount[ulCommand] != 0)
+        {
+            printf("  0x%02lx %-20s %10lu commands %10lu bytes\n", ulCommand,
+                   HostDisplayCommandName(ulCommand),
+                   g_pulCommandCount[ulCommand],
+                   g_pulCommandBytes[ulCommand]);
+        }
+    }
+    printf("  %-25s %19s %10lu bytes\n", "data", "", g_ulDataBytes);
+}
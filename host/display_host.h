@@ -0,0 +1,34 @@
+//*****************************************************************************
+//
+// display_host.h - Prototypes for the host model of the SSD1329 OLED
+// controller.
+//
+//*****************************************************************************
+
+#ifndef __DISPLAY_HOST_H__
+#define __DISPLAY_HOST_H__
+
+//*****************************************************************************
+//
+// The size of the visible part of the display, in pixels.
+//
+//*****************************************************************************
+#define HOST_DISPLAY_WIDTH      128
+#define HOST_DISPLAY_HEIGHT     96
+
+//*****************************************************************************
+//
+// Prototypes for the host display model.
+//
+//*****************************************************************************
+extern void HostDisplayWrite(tBoolean bData, unsigned char ucByte);
+extern unsigned long HostDisplayPixelGet(unsigned long ulX, unsigned long ulY);
+extern unsigned long HostDisplayHash(void);
+extern tBoolean HostDisplayDump(const char *pcFilename);
+extern unsigned long HostDisplayCommandCountGet(unsigned char ucCommand,
+                                                unsigned long *pulBytes);
+extern unsigned long HostDisplayDataCountGet(void);
+extern unsigned long HostDisplayByteCountGet(void);
+extern void HostDisplayReport(void);
+
+#endif // __DISPLAY_HOST_H__
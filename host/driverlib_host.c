@@ -0,0 +1,329 @@
+//*****************************************************************************
+//
+// driverlib_host.c - Host emulation of the driver library calls made by the
+// RIT display driver.
+//
+// The SSI transmit FIFO is modelled as eight entries that are shifted out to
+// the display model whenever the driver would otherwise have to wait for them:
+// when the FIFO is full, when the driver polls for the SSI to be idle (which
+// then counts as one busy poll), and before the transmit interrupt handler
+// runs.  The transmit interrupt is taken
+// as soon as it is both unmasked in the SSI and enabled in the NVIC, the same
+// as it would preempt the code that enabled it on the hardware.
+//
+//*****************************************************************************
+
+#include <stdlib.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/ssi.h"
+#include "driverlib/sysctl.h"
+#include "drivers/rit128x96x4.h"
+#include "host/display_host.h"
+#include "host/driverlib_host.h"
+#include "hal.h"
+
+//*****************************************************************************
+//
+// The depth of the SSI transmit FIFO.
+//
+//*****************************************************************************
+#define SSI_FIFO_SIZE           8
+
+//*****************************************************************************
+//
+// The words that stand in for the bit-band aliases of HWREGBITW().
+//
+//*****************************************************************************
+#define BIT_BAND_WORDS          32
+
+static struct
+{
+    volatile void *pvAddress;
+    unsigned long ulBit;
+    unsigned long ulValue;
+}
+g_psBitBand[BIT_BAND_WORDS];
+
+//*****************************************************************************
+//
+// The state of the emulated SSI and of the OLED D/C line.
+//
+//*****************************************************************************
+static unsigned char g_pucSSIFifo[SSI_FIFO_SIZE];
+static unsigned long g_ulSSIFifoCount;
+static tBoolean g_bSSITxIntMasked = true;
+static tBoolean g_bSSIIntEnabled;
+static tBoolean g_bSSIInHandler;
+static tBoolean g_bDataMode;
+
+//*****************************************************************************
+//
+// The SSI clock that the SSI was last set up for.
+//
+//*****************************************************************************
+static unsigned long g_ulSSIClock;
+
+//*****************************************************************************
+//
+// Returns the word that stands in for bit ulBit of the word at pvAddress.
+//
+//*****************************************************************************
+unsigned long *
+HostBitBand(volatile void *pvAddress, unsigned long ulBit)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < BIT_BAND_WORDS; ulIdx++)
+    {
+        if(g_psBitBand[ulIdx].pvAddress == 0)
+        {
+            g_psBitBand[ulIdx].pvAddress = pvAddress;
+            g_psBitBand[ulIdx].ulBit = ulBit;
+        }
+        if((g_psBitBand[ulIdx].pvAddress == pvAddress) &&
+           (g_psBitBand[ulIdx].ulBit == ulBit))
+        {
+            return(&g_psBitBand[ulIdx].ulValue);
+        }
+    }
+
+    abort();
+}
+
+//*****************************************************************************
+//
+// Shifts everything in the SSI transmit FIFO out to the display.
+//
+//*****************************************************************************
+static void
+SSIFifoDrain(void)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < g_ulSSIFifoCount; ulIdx++)
+    {
+        HostDisplayWrite(g_bDataMode, g_pucSSIFifo[ulIdx]);
+    }
+    g_ulSSIFifoCount = 0;
+}
+
+//*****************************************************************************
+//
+// Runs the SSI interrupt handler for as long as the transmit interrupt is
+// unmasked and enabled.  The FIFO is empty every time the handler runs, which
+// is when the transmit interrupt would be asserted.
+//
+//*****************************************************************************
+static void
+SSIIntDeliver(void)
+{
+    if(g_bSSIInHandler)
+    {
+        return;
+    }
+
+    g_bSSIInHandler = true;
+    while(!g_bSSITxIntMasked && g_bSSIIntEnabled)
+    {
+        SSIFifoDrain();
+        RIT128x96x4IntHandler();
+    }
+    g_bSSIInHandler = false;
+}
+
+//*****************************************************************************
+//
+// GPIO.  Only the OLED D/C line does anything.
+//
+//*****************************************************************************
+void
+GPIOPadConfigSet(unsigned long ulPort, unsigned char ucPins,
+                 unsigned long ulStrength, unsigned long ulPadType)
+{
+}
+
+void
+GPIOPinTypeGPIOOutput(unsigned long ulPort, unsigned char ucPins)
+{
+}
+
+void
+GPIOPinTypeSSI(unsigned long ulPort, unsigned char ucPins)
+{
+}
+
+void
+GPIOPinWrite(unsigned long ulPort, unsigned char ucPins, unsigned char ucVal)
+{
+    if((ulPort == GPIO_PORTA_BASE) && (ucPins & GPIO_PIN_6))
+    {
+        g_bDataMode = (ucVal & GPIO_PIN_6) ? true : false;
+    }
+}
+
+//*****************************************************************************
+//
+// Interrupt controller.  Only the SSI interrupt is modelled.
+//
+//*****************************************************************************
+void
+IntEnable(unsigned long ulInterrupt)
+{
+    if(ulInterrupt == INT_SSI0)
+    {
+        g_bSSIIntEnabled = true;
+        SSIIntDeliver();
+    }
+}
+
+void
+IntDisable(unsigned long ulInterrupt)
+{
+    if(ulInterrupt == INT_SSI0)
+    {
+        g_bSSIIntEnabled = false;
+    }
+}
+
+//*****************************************************************************
+//
+// SSI.
+//
+//*****************************************************************************
+tBoolean
+SSIBusy(unsigned long ulBase)
+{
+    //
+    // Report a non-empty FIFO as busy once, and shift it out while the driver
+    // is waiting.
+    //
+    if(g_ulSSIFifoCount != 0)
+    {
+        SSIFifoDrain();
+        return(true);
+    }
+
+    return(false);
+}
+
+void
+SSIConfigSetExpClk(unsigned long ulBase, unsigned long ulSSIClk,
+                   unsigned long ulProtocol, unsigned long ulMode,
+                   unsigned long ulBitRate, unsigned long ulDataWidth)
+{
+    unsigned long ulMaxBitRate, ulPreDiv, ulSCR;
+
+    //
+    // Work out the dividers the same way as the driver library, and from them
+    // the SSI clock that the hardware would produce, which can be faster than
+    // the one asked for.
+    //
+    ulMaxBitRate = ulSSIClk / ulBitRate;
+    ulPreDiv = 0;
+    do
+    {
+        ulPreDiv += 2;
+        ulSCR = (ulMaxBitRate / ulPreDiv) - 1;
+    }
+    while(ulSCR > 255);
+
+    g_ulSSIClock = ulSSIClk / (ulPreDiv * (1 + ulSCR));
+}
+
+long
+SSIDataGetNonBlocking(unsigned long ulBase, unsigned long *pulData)
+{
+    return(0);
+}
+
+long
+SSIDataPutNonBlocking(unsigned long ulBase, unsigned long ulData)
+{
+    //
+    // A full FIFO refuses the byte.  It has been shifted out by the time the
+    // driver tries again.
+    //
+    if(g_ulSSIFifoCount == SSI_FIFO_SIZE)
+    {
+        SSIFifoDrain();
+        return(0);
+    }
+
+    g_pucSSIFifo[g_ulSSIFifoCount++] = ulData;
+
+    return(1);
+}
+
+void
+SSIDisable(unsigned long ulBase)
+{
+}
+
+void
+SSIEnable(unsigned long ulBase)
+{
+}
+
+void
+SSIIntDisable(unsigned long ulBase, unsigned long ulIntFlags)
+{
+    if(ulIntFlags & SSI_TXFF)
+    {
+        g_bSSITxIntMasked = true;
+    }
+}
+
+void
+SSIIntEnable(unsigned long ulBase, unsigned long ulIntFlags)
+{
+    if(ulIntFlags & SSI_TXFF)
+    {
+        g_bSSITxIntMasked = false;
+        SSIIntDeliver();
+    }
+}
+
+//*****************************************************************************
+//
+// System control.  The clock is the one that the HAL has switched to.
+//
+//*****************************************************************************
+unsigned long
+SysCtlClockGet(void)
+{
+    return(HalClockGet());
+}
+
+void
+SysCtlPeripheralEnable(unsigned long ulPeripheral)
+{
+}
+
+//*****************************************************************************
+//
+// Returns the SSI clock that the SSI was last set up for, or 0 if it has not
+// been set up.
+//
+//*****************************************************************************
+unsigned long
+HostSSIClockGet(void)
+{
+    return(g_ulSSIClock);
+}
+
+//*****************************************************************************
+//
+// Shifts out whatever is left in the SSI transmit FIFO, as the hardware does
+// in the background.  This is called between ticks.
+//
+//*****************************************************************************
+void
+HostSSIFlush(void)
+{
+    SSIFifoDrain();
+    SSIIntDeliver();
+}
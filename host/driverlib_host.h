@@ -0,0 +1,18 @@
+//*****************************************************************************
+//
+// driverlib_host.h - Prototypes for the host emulation of the driver library.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_HOST_H__
+#define __DRIVERLIB_HOST_H__
+
+//*****************************************************************************
+//
+// Prototypes for the host driver library.
+//
+//*****************************************************************************
+extern void HostSSIFlush(void);
+extern unsigned long HostSSIClockGet(void);
+
+#endif // __DRIVERLIB_HOST_H__
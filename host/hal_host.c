@@ -0,0 +1,725 @@
+//*****************************************************************************
+//
+// hal_host.c - Linux host implementation of the Pong HAL.
+//
+// This runs the unchanged game and display driver on a Linux machine.  There
+// is no timer: every call to HalIdle() from the main loop runs one simulated
+// tick, which calls the game's handlers in the order that the hardware would
+// and shifts what the driver sent over SSI into an in-memory copy of the
+// display (see display_host.c).  The buttons are pressed by a script that
+// sweeps the player's bounce board up and down.
+//
+// Build and run it from the top of the repository with:
+//
+//     gcc -O2 -Wall -Ihost/include -I. -o pong_host pong.c profile.c trace.c
+//         clock.c boot.c drivers/rit128x96x4.c utils/ustdlib.c host/*.c
+//
+//     PONG_TICKS=3000 PONG_SEED=1 ./pong_host
+//
+// PONG_TICKS is the number of ticks to run (3000 by default) and PONG_SEED
+// seeds the random numbers used by the opponent (1 by default).  When the
+// ticks have run, the program prints a hash of the display, the SSI bus
+// accounting kept by the display driver, and the bytes that the display
+// received for each command, and exits.
+//
+// The phase profile is printed too.  The host has no cycle counter, so the
+// cycles are the time the phases took on the host, counted at the clock the
+// board would be running at.  The host is taken to run as fast as the board
+// does at 50MHz, so at the lower clock levels the time is stretched to match.
+// Each tick starts on the board's schedule, one period after the last, so the
+// game sees its ticks on time.
+//
+// Every byte sent to the display is charged the time it takes on the SSI, as
+// if the processor waited for it to be sent.  PONG_DISPLAY_DELAY makes the
+// display slow instead, by charging that many cycles of the 50MHz clock for
+// every byte it receives.  A frame that is still being drawn when the next
+// tick is due holds up drawing until the first tick after it has finished, as
+// on the board, where the tick would interrupt it and the frames it published
+// in the meantime would be skipped.  This shows how the game copes with frames
+// that overrun: the counts of skipped, overrun and degraded frames are printed
+// at the end.  For example, PONG_DISPLAY_DELAY=2000 makes every byte take
+// 40us.
+//
+// The time from the end of each tick's work to the start of the next tick is
+// counted as time asleep, for the CPU load.  Deep sleep is woken at once, as
+// if a button had been pressed straight away.
+//
+// Building with -DPROFILE_BUS has the game flush each part of the frame
+// separately, so that the bus accounting shows what each part costs.
+//
+// If PONG_PGM is set, the display is also written to PGM files named with it
+// followed by the tick number: after the last tick, and every PONG_PGM_EVERY
+// ticks if that is set.  For example, PONG_PGM=/tmp/pong_ PONG_PGM_EVERY=50
+// writes /tmp/pong_000050.pgm, /tmp/pong_000100.pgm and so on.
+//
+// If PONG_TRACE is set, the event trace is dumped at the end, the same as
+// pressing the left button on the board does.  The trace only holds the last
+// TRACE_EVENTS events, which is a few dozen ticks; build with, for example,
+// -DTRACE_EVENTS=65536 to keep more.  To see it in Perfetto:
+//
+//     gcc -O2 -Wall -o trace2json host/tools/trace2json.c
+//     PONG_TRACE=1 ./pong_host | ./trace2json > pong.json
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "inc/hw_types.h"
+#include "drivers/rit128x96x4.h"
+#include "utils/ustdlib.h"
+#include "host/display_host.h"
+#include "host/driverlib_host.h"
+#include "hal.h"
+#include "pong.h"
+#include "profile.h"
+#include "trace.h"
+
+//*****************************************************************************
+//
+// The SSI clock for the display, which is as fast as it takes.  The driver
+// uses the fastest clock that it can make from the system clock that is no
+// faster than this.
+//
+//*****************************************************************************
+#define DISPLAY_SSI_CLOCK       RIT_SSI_CLOCK_MAX
+
+//*****************************************************************************
+//
+// The clock that the host runs as fast as, which is the board's PLL clock.
+//
+//*****************************************************************************
+#define HOST_CLOCK              50000000
+
+//*****************************************************************************
+//
+// The clock at each clock level, which are the board's.
+//
+//*****************************************************************************
+static const unsigned long g_pulClockRate[HAL_CLOCK_LEVELS] =
+{
+    50000000,
+    8000000,
+    2000000
+};
+
+//*****************************************************************************
+//
+// The scripted player presses a button every INPUT_PERIOD ticks, and changes
+// between up and down every INPUT_SWEEP ticks.
+//
+//*****************************************************************************
+#define INPUT_PERIOD            7
+#define INPUT_SWEEP             140
+
+//*****************************************************************************
+//
+// The simulation state.
+//
+//*****************************************************************************
+static unsigned long g_ulTicksPerSecond;
+static unsigned long g_ulTickCount;
+static unsigned long g_ulTick;
+static unsigned long g_ulButtons;
+static tBoolean g_bRenderPending;
+static const char *g_pcPGMPrefix;
+static unsigned long g_ulPGMEvery;
+static tBoolean g_bTraceDump;
+
+//*****************************************************************************
+//
+// The simulated time, in nanoseconds since HalInit(), which stands in for
+// reset.  The boot runs on the host's clock.  Tick 0 starts at g_ullTickZero,
+// when HalStart() starts the tick, and each tick starts at g_ullTickTime,
+// which is when it is due.  The time then runs on from g_ullTimeBase with the
+// host's clock and the delays charged for the display.  g_ullRenderBusy is
+// when the last frame finished drawing.
+//
+//*****************************************************************************
+static tBoolean g_bTimeStarted;
+static unsigned long long g_ullTickZero;
+static unsigned long long g_ullTickTime;
+static unsigned long long g_ullTimeBase;
+static struct timespec g_sTimeStart;
+static unsigned long g_ulTimeBytes;
+static unsigned long g_ulDisplayDelay;
+static unsigned long long g_ullRenderBusy;
+
+//*****************************************************************************
+//
+// The simulated processor clock.  The cycle count was g_ullCycleBase at the
+// time g_ullCycleTime, when the clock was last switched, and has counted at
+// g_ulClock since.
+//
+//*****************************************************************************
+static unsigned long g_ulClock = HOST_CLOCK;
+static unsigned long long g_ullCycleBase;
+static unsigned long long g_ullCycleTime;
+
+//*****************************************************************************
+//
+// The time that the last tick's work finished, and the cycles spent asleep
+// between ticks.
+//
+//*****************************************************************************
+static unsigned long long g_ullIdleStart;
+static unsigned long long g_ullSleepCycles;
+
+//*****************************************************************************
+//
+// Returns the value of an environment variable as a number, or ulDefault if it
+// is not set.
+//
+//*****************************************************************************
+static unsigned long
+HostEnvGet(const char *pcName, unsigned long ulDefault)
+{
+    const char *pcValue;
+
+    pcValue = getenv(pcName);
+
+    return(pcValue ? strtoul(pcValue, 0, 0) : ulDefault);
+}
+
+//*****************************************************************************
+//
+// Writes the display to the PGM file for the current tick.
+//
+//*****************************************************************************
+static void
+HostFrameDump(void)
+{
+    char pcFilename[256];
+
+    snprintf(pcFilename, sizeof(pcFilename), "%s%06lu.pgm", g_pcPGMPrefix,
+             g_ulTick);
+    if(!HostDisplayDump(pcFilename))
+    {
+        fprintf(stderr, "pong_host: can't write %s\n", pcFilename);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints to the standard output with the same format conversions as
+// UARTprintf() on the board, which take unsigned long arguments for %u.
+//
+//*****************************************************************************
+void
+HalPrintf(const char *pcFormat, ...)
+{
+    char pcBuffer[256];
+    va_list vaArgP;
+
+    va_start(vaArgP, pcFormat);
+    uvsnprintf(pcBuffer, sizeof(pcBuffer), pcFormat, vaArgP);
+    va_end(vaArgP);
+
+    fputs(pcBuffer, stdout);
+}
+
+//*****************************************************************************
+//
+// Prints one line of the SSI bus accounting: the average and peak per frame.
+//
+//*****************************************************************************
+static void
+HostBusStatsPrint(const char *pcName, const tRITBusStats *psPeak,
+                  const tRITBusStats *psTotal, unsigned long ulFrames)
+{
+    printf("  %-10s %7lu.%lu %5lu bytes %5lu.%lu %3lu commands "
+           "%5lu.%lu %3lu toggles %5lu.%lu %3lu spins\n", pcName,
+           psTotal->ulBytes / ulFrames, (psTotal->ulBytes * 10 / ulFrames) % 10,
+           psPeak->ulBytes,
+           psTotal->ulCommands / ulFrames,
+           (psTotal->ulCommands * 10 / ulFrames) % 10, psPeak->ulCommands,
+           psTotal->ulDCToggles / ulFrames,
+           (psTotal->ulDCToggles * 10 / ulFrames) % 10, psPeak->ulDCToggles,
+           psTotal->ulBusySpins / ulFrames,
+           (psTotal->ulBusySpins * 10 / ulFrames) % 10, psPeak->ulBusySpins);
+}
+
+//*****************************************************************************
+//
+// Prints the SSI bus accounting kept by the display driver, against the number
+// of bytes the bus can carry in a tick.
+//
+//*****************************************************************************
+static void
+HostBusReport(void)
+{
+    tRITBusStats sPeak, sTotal;
+    unsigned long ulFrames, ulSection;
+    const char *pcName;
+
+    ulFrames = RIT128x96x4BusStatsGet(0, &sPeak, &sTotal);
+    if(ulFrames == 0)
+    {
+        return;
+    }
+
+    printf("SSI bus: %lu frames, %lu bytes per tick available at %luHz; "
+           "average and peak per frame:\n", ulFrames,
+           RIT128x96x4SSIClockGet() / 8 / g_ulTicksPerSecond,
+           RIT128x96x4SSIClockGet());
+    HostBusStatsPrint("all", &sPeak, &sTotal, ulFrames);
+
+    for(ulSection = 0; ulSection < RIT_BUS_SECTIONS; ulSection++)
+    {
+        pcName = RIT128x96x4BusSectionGet(ulSection, &sPeak, &sTotal);
+        if(pcName)
+        {
+            HostBusStatsPrint(pcName, &sPeak, &sTotal, ulFrames);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Reads the simulation settings.
+//
+//*****************************************************************************
+void
+HalInit(void)
+{
+    g_ulTickCount = HostEnvGet("PONG_TICKS", 3000);
+    srand(HostEnvGet("PONG_SEED", 1));
+    g_pcPGMPrefix = getenv("PONG_PGM");
+    g_ulPGMEvery = HostEnvGet("PONG_PGM_EVERY", 0);
+    g_bTraceDump = getenv("PONG_TRACE") ? true : false;
+    g_ulDisplayDelay = HostEnvGet("PONG_DISPLAY_DELAY", 0);
+
+    HalCycleCountStart();
+}
+
+//*****************************************************************************
+//
+// Records the tick rate.  It is only used to report the simulated time.
+//
+//*****************************************************************************
+void
+HalTimerInit(unsigned long ulTicksPerSecond)
+{
+    g_ulTicksPerSecond = ulTicksPerSecond;
+}
+
+//*****************************************************************************
+//
+// Returns the time charged for each byte sent to the display, in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long
+HostByteTimeGet(void)
+{
+    if(g_ulDisplayDelay)
+    {
+        return(g_ulDisplayDelay * (1000000000 / HOST_CLOCK));
+    }
+
+    return(HostSSIClockGet() ? (8000000000ULL / HostSSIClockGet()) : 0);
+}
+
+//*****************************************************************************
+//
+// Checks that the SSI clock that the hardware would produce for the display is
+// no faster than the display can take.  The divider can only make some rates,
+// so this is the rate that it actually makes, not the one that was asked for.
+//
+//*****************************************************************************
+static void
+HostSSIClockCheck(void)
+{
+    if(HostSSIClockGet() > RIT_SSI_CLOCK_MAX)
+    {
+        fprintf(stderr, "pong_host: SSI clock %luHz at %luHz is faster than "
+                "the display's %luHz\n", HostSSIClockGet(), g_ulClock,
+                (unsigned long)RIT_SSI_CLOCK_MAX);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the simulated time: g_ullTimeBase, plus the host's time since then,
+// stretched for the processor clock, and the delays charged for the display
+// since then.
+//
+//*****************************************************************************
+static unsigned long long
+HostTimeGet(void)
+{
+    struct timespec sNow;
+    unsigned long long ullNanoseconds;
+
+    if(!g_bTimeStarted)
+    {
+        return(0);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    ullNanoseconds = (((unsigned long long)(sNow.tv_sec - g_sTimeStart.tv_sec) *
+                       1000000000) + sNow.tv_nsec - g_sTimeStart.tv_nsec);
+
+    return(g_ullTimeBase +
+           (ullNanoseconds * (HOST_CLOCK / 1000) / (g_ulClock / 1000)) +
+           ((unsigned long long)(HostDisplayByteCountGet() - g_ulTimeBytes) *
+            HostByteTimeGet()));
+}
+
+//*****************************************************************************
+//
+// Starts the host's time and the display delays again from the simulated time
+// ullTime.
+//
+//*****************************************************************************
+static void
+HostTimeSet(unsigned long long ullTime)
+{
+    g_ullTimeBase = ullTime;
+    clock_gettime(CLOCK_MONOTONIC, &g_sTimeStart);
+    g_ulTimeBytes = HostDisplayByteCountGet();
+}
+
+//*****************************************************************************
+//
+// Returns the cycle count at the simulated time ullTime, which must not be
+// before the clock was last switched.
+//
+//*****************************************************************************
+static unsigned long long
+HostCyclesAt(unsigned long long ullTime)
+{
+    return(g_ullCycleBase +
+           ((ullTime - g_ullCycleTime) * (g_ulClock / 1000) / 1000000));
+}
+
+//*****************************************************************************
+//
+// Counts the time since the last tick's work finished as sleep, up to the
+// simulated time ullTime.
+//
+//*****************************************************************************
+static void
+HostSleepUntil(unsigned long long ullTime)
+{
+    if(ullTime > g_ullIdleStart)
+    {
+        g_ullSleepCycles += (HostCyclesAt(ullTime) -
+                             HostCyclesAt(g_ullIdleStart));
+        g_ullIdleStart = ullTime;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the simulated clock for the current tick at the time it is due.
+//
+//*****************************************************************************
+static void
+HostClockTick(void)
+{
+    g_ullTickTime = g_ullTickZero + ((unsigned long long)g_ulTick *
+                                     1000000000 / g_ulTicksPerSecond);
+    HostSleepUntil(g_ullTickTime);
+    HostTimeSet(g_ullTickTime);
+}
+
+//*****************************************************************************
+//
+// Returns the clock that cycles are counted at.
+//
+//*****************************************************************************
+unsigned long
+HalClockGet(void)
+{
+    return(g_ulClock);
+}
+
+//*****************************************************************************
+//
+// Returns the clock at a clock level.
+//
+//*****************************************************************************
+unsigned long
+HalClockLevelRate(unsigned long ulLevel)
+{
+    return(g_pulClockRate[ulLevel]);
+}
+
+//*****************************************************************************
+//
+// Switches the simulated clock to a clock level.  The cycle count carries on
+// from where it was at the new rate.  The display driver is disabled and
+// enabled again around the switch, as on the board, which sets the SSI
+// divider for the new clock.
+//
+//*****************************************************************************
+void
+HalClockLevelSet(unsigned long ulLevel)
+{
+    unsigned long long ullNow, ullNext;
+
+    RIT128x96x4Disable();
+
+    //
+    // A slow frame can finish drawing after the next tick is due.  On the
+    // board that tick would interrupt the frame and run at the old clock, so
+    // the switch is taken to happen just before the next tick instead.
+    //
+    ullNow = HostTimeGet();
+    ullNext = g_ullTickZero + ((unsigned long long)g_ulTick * 1000000000 /
+                               g_ulTicksPerSecond);
+    if(ullNow >= ullNext)
+    {
+        ullNow = ullNext - 1;
+    }
+    HostSleepUntil(ullNow);
+    g_ullCycleBase = HostCyclesAt(ullNow);
+    g_ullCycleTime = ullNow;
+    g_ulClock = g_pulClockRate[ulLevel];
+    HostTimeSet(ullNow);
+
+    RIT128x96x4Enable(DISPLAY_SSI_CLOCK);
+    HostSSIClockCheck();
+
+    HostSSIFlush();
+}
+
+//*****************************************************************************
+//
+// Starts the simulated time.  The host has no reset, so HalInit() calls this.
+//
+//*****************************************************************************
+void
+HalCycleCountStart(void)
+{
+    HostTimeSet(0);
+    g_bTimeStarted = true;
+}
+
+//*****************************************************************************
+//
+// Returns the simulated time in cycles.
+//
+//*****************************************************************************
+unsigned long
+HalCycleCount(void)
+{
+    return(HostCyclesAt(HostTimeGet()));
+}
+
+//*****************************************************************************
+//
+// The handlers are called one after another, so there are no interrupts to
+// turn off.
+//
+//*****************************************************************************
+unsigned long
+HalCriticalEnter(void)
+{
+    return(0);
+}
+
+void
+HalCriticalExit(unsigned long ulState)
+{
+}
+
+//*****************************************************************************
+//
+// The host's stack is not measured, so its size is given as 0.
+//
+//*****************************************************************************
+unsigned long
+HalStackUsed(unsigned long *pulSize)
+{
+    if(pulSize)
+    {
+        *pulSize = 0;
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// There are no buttons to set up.
+//
+//*****************************************************************************
+void
+HalInputInit(void)
+{
+}
+
+//*****************************************************************************
+//
+// Returns the buttons that the script is holding down.
+//
+//*****************************************************************************
+unsigned long
+HalInputRead(void)
+{
+    return(g_ulButtons);
+}
+
+//*****************************************************************************
+//
+// Initializes the display driver, which sends to the display model.
+//
+//*****************************************************************************
+void
+HalDisplayInit(void)
+{
+    RIT128x96x4Init(DISPLAY_SSI_CLOCK);
+    HostSSIClockCheck();
+}
+
+//*****************************************************************************
+//
+// There are no interrupt priorities; drawing is run after the tick instead.
+//
+//*****************************************************************************
+void
+HalRenderInit(void)
+{
+}
+
+//*****************************************************************************
+//
+// Has the PendSV handler run at the end of the current tick.
+//
+//*****************************************************************************
+void
+HalRenderRequest(void)
+{
+    g_bRenderPending = true;
+}
+
+//*****************************************************************************
+//
+// Returns a random number from the C library.
+//
+//*****************************************************************************
+int
+HalRandom(void)
+{
+    return(rand());
+}
+
+//*****************************************************************************
+//
+// Shifts out anything the display driver sent while starting up, and starts
+// the ticks from now.
+//
+//*****************************************************************************
+void
+HalStart(void)
+{
+    HostSSIFlush();
+
+    g_ullTickZero = HostTimeGet();
+    g_ullIdleStart = g_ullTickZero;
+}
+
+//*****************************************************************************
+//
+// Runs one simulated tick, or reports the result and exits once all of the
+// ticks have run.
+//
+//*****************************************************************************
+void
+HalIdle(void)
+{
+    if(g_ulTick == g_ulTickCount)
+    {
+        printf("ticks %lu (%lu.%02lus), display %08lx\n", g_ulTick,
+               g_ulTick / g_ulTicksPerSecond,
+               (g_ulTick % g_ulTicksPerSecond) * 100 / g_ulTicksPerSecond,
+               HostDisplayHash());
+        GameReport();
+        HostBusReport();
+        printf("Profile, in cycles:\n");
+        ProfileReport(HalPrintf);
+        printf("SSD1329 commands:\n");
+        HostDisplayReport();
+        if(g_bTraceDump)
+        {
+            TraceDump(HalPrintf);
+        }
+        if(g_pcPGMPrefix)
+        {
+            HostFrameDump();
+        }
+        exit(0);
+    }
+
+    HostClockTick();
+
+    //
+    // Press a button on the script's schedule.
+    //
+    if((g_ulTick % INPUT_PERIOD) == 0)
+    {
+        g_ulButtons = ((g_ulTick / INPUT_SWEEP) & 1) ? HAL_BUTTON_DOWN :
+                      HAL_BUTTON_UP;
+        GPIOEIntHandler();
+        g_ulButtons = 0;
+    }
+
+    //
+    // Run the game tick, then the drawing it asked for, then let the SSI
+    // finish sending.  If the last frame was still being drawn when this tick
+    // was due, the drawing waits for a later tick.
+    //
+    SysTickIntHandler();
+
+    if(g_bRenderPending && (g_ullTickTime >= g_ullRenderBusy))
+    {
+        g_bRenderPending = false;
+        PendSVIntHandler();
+        g_ullRenderBusy = HostTimeGet();
+    }
+
+    HostSSIFlush();
+
+    g_ullIdleStart = HostTimeGet();
+    g_ulTick++;
+
+    if(g_pcPGMPrefix && g_ulPGMEvery && ((g_ulTick % g_ulPGMEvery) == 0) &&
+       (g_ulTick != g_ulTickCount))
+    {
+        HostFrameDump();
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of cycles between the ticks' work.
+//
+//*****************************************************************************
+unsigned long
+HalSleepCycles(void)
+{
+    return((unsigned long)(g_ullSleepCycles & 0xffffffff));
+}
+
+//*****************************************************************************
+//
+// Turns the display off and on again, the way the board does around deep
+// sleep.  The simulated time does not move, since no ticks are lost.
+//
+//*****************************************************************************
+void
+HalDeepSleep(void)
+{
+    RIT128x96x4DisplayOff();
+    RIT128x96x4Disable();
+
+    RIT128x96x4Enable(DISPLAY_SSI_CLOCK);
+    HostSSIClockCheck();
+    RIT128x96x4DisplayOn();
+
+    HostSSIFlush();
+}
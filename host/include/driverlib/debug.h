@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// debug.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __DEBUG_H__
+#define __DEBUG_H__
+
+#include <assert.h>
+
+//*****************************************************************************
+//
+// The driver library's ASSERT() is checked with the C library's assert().
+//
+//*****************************************************************************
+#define ASSERT(expr) assert(expr)
+
+#endif // __DEBUG_H__
@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// interrupt.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __INTERRUPT_H__
+#define __INTERRUPT_H__
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void IntEnable(unsigned long ulInterrupt);
+extern void IntDisable(unsigned long ulInterrupt);
+
+#endif // __INTERRUPT_H__
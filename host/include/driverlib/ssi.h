@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// ssi.h - Host build stand-in for the StellarisWare header of the same name.
+//
+//*****************************************************************************
+
+#ifndef __SSI_H__
+#define __SSI_H__
+
+//*****************************************************************************
+//
+// The interrupt sources, frame formats and modes.
+//
+//*****************************************************************************
+#define SSI_TXFF                0x00000008  // TX FIFO half full or less
+
+#define SSI_FRF_MOTO_MODE_3     0x000000C0  // Moto fmt, polarity 1, phase 1
+#define SSI_MODE_MASTER         0x00000000  // SSI master
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern tBoolean SSIBusy(unsigned long ulBase);
+extern void SSIConfigSetExpClk(unsigned long ulBase, unsigned long ulSSIClk,
+                               unsigned long ulProtocol, unsigned long ulMode,
+                               unsigned long ulBitRate,
+                               unsigned long ulDataWidth);
+extern long SSIDataGetNonBlocking(unsigned long ulBase,
+                                  unsigned long *pulData);
+extern long SSIDataPutNonBlocking(unsigned long ulBase, unsigned long ulData);
+extern void SSIDisable(unsigned long ulBase);
+extern void SSIEnable(unsigned long ulBase);
+extern void SSIIntDisable(unsigned long ulBase, unsigned long ulIntFlags);
+extern void SSIIntEnable(unsigned long ulBase, unsigned long ulIntFlags);
+
+#endif // __SSI_H__
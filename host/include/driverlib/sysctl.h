@@ -0,0 +1,27 @@
+//*****************************************************************************
+//
+// sysctl.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __SYSCTL_H__
+#define __SYSCTL_H__
+
+//*****************************************************************************
+//
+// The peripherals.
+//
+//*****************************************************************************
+#define SYSCTL_PERIPH_SSI0      0x10000010  // SSI 0
+#define SYSCTL_PERIPH_GPIOA     0x20000001  // GPIO A
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern unsigned long SysCtlClockGet(void);
+extern void SysCtlPeripheralEnable(unsigned long ulPeripheral);
+
+#endif // __SYSCTL_H__
@@ -0,0 +1,18 @@
+//*****************************************************************************
+//
+// hw_ints.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+//*****************************************************************************
+//
+// The interrupt assignments that are used by the display driver.
+//
+//*****************************************************************************
+#define INT_SSI0                23          // SSI0 Rx and Tx
+
+#endif // __HW_INTS_H__
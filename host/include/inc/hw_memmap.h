@@ -0,0 +1,17 @@
+//*****************************************************************************
+//
+// hw_memmap.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+// The base addresses only identify the peripherals to the emulated driver
+// library; nothing is ever read or written at them.
+//
+//*****************************************************************************
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define GPIO_PORTA_BASE         0x40004000  // GPIO Port A
+#define SSI0_BASE               0x40008000  // SSI0
+
+#endif // __HW_MEMMAP_H__
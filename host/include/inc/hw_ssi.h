@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// hw_ssi.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+// None of the registers are used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_SSI_H__
+#define __HW_SSI_H__
+
+#endif // __HW_SSI_H__
@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// hw_sysctl.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+// None of the registers are used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_SYSCTL_H__
+#define __HW_SYSCTL_H__
+
+#endif // __HW_SYSCTL_H__
@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// hw_types.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+//*****************************************************************************
+//
+// Define a boolean type, and values for true and false.
+//
+//*****************************************************************************
+typedef unsigned char tBoolean;
+
+#ifndef true
+#define true 1
+#endif
+
+#ifndef false
+#define false 0
+#endif
+
+//*****************************************************************************
+//
+// Macros for hardware access.
+//
+// There is no bit-band region on the host, so HWREGBITW() gives each bit that
+// is used through it a word of its own instead.  The bit only ever holds the
+// value that was last written to it through HWREGBITW(), which is all the
+// drivers rely on; the variable that holds the bit is left unchanged.
+//
+//*****************************************************************************
+extern unsigned long *HostBitBand(volatile void *pvAddress,
+                                  unsigned long ulBit);
+
+#define HWREG(x)                                                              \
+        (*((volatile unsigned long *)(x)))
+#define HWREGH(x)                                                             \
+        (*((volatile unsigned short *)(x)))
+#define HWREGB(x)                                                             \
+        (*((volatile unsigned char *)(x)))
+#define HWREGBITW(x, b)                                                       \
+        (*HostBitBand((volatile void *)(x), (b)))
+
+#endif // __HW_TYPES_H__
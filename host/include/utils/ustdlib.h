@@ -0,0 +1,54 @@
+//*****************************************************************************
+//
+// ustdlib.h - Host build stand-in for the StellarisWare header of the same
+// name.
+//
+//*****************************************************************************
+
+#ifndef __USTDLIB_H__
+#define __USTDLIB_H__
+
+#include <stdarg.h>
+
+//*****************************************************************************
+//
+// A structure that contains the broken down date and time.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned short usYear;
+    unsigned char ucMon;
+    unsigned char ucMday;
+    unsigned char ucWday;
+    unsigned char ucHour;
+    unsigned char ucMin;
+    unsigned char ucSec;
+}
+tTime;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern int uvsnprintf(char *pcBuf, unsigned long ulSize, const char *pcString,
+                      va_list vaArgP);
+extern int usprintf(char *pcBuf, const char *pcString, ...);
+extern int usnprintf(char *pcBuf, unsigned long ulSize, const char *pcString,
+                     ...);
+extern void ulocaltime(unsigned long ulTime, tTime *psTime);
+extern unsigned long umktime(tTime *psTime);
+extern unsigned long ustrtoul(const char *pcStr, const char **ppcStrRet,
+                              int iBase);
+extern int ustrlen(const char *pcStr);
+extern char *ustrncpy(char *pcDst, const char *pcSrc, int iNum);
+extern char *ustrstr(const char *pcHaystack, const char *pcNeedle);
+extern int ustrncmp(const char *pcStr1, const char *pcStr2, int iCount);
+extern int ustrnicmp(const char *pcStr1, const char *pcStr2, int iCount);
+extern int ustrcasecmp(const char *pcStr1, const char *pcStr2);
+extern int ustrcmp(const char *pcStr1, const char *pcStr2);
+extern void usrand(unsigned long ulSeed);
+extern int urand(void);
+
+#endif // __USTDLIB_H__
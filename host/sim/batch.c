@@ -0,0 +1,1084 @@
+//*****************************************************************************
+//
+// batch.c - Batched game kernel for the host's tuner.
+//
+// The tuner spends nearly all of its time in CollisionDetector(),
+// BallMovement() and OpponentMovement(), one game at a time.  This plays
+// BATCH_GAMES games at once by the same rules instead, with each variable of
+// the games kept in an array (see tBatch), so that one vector holds it for
+// eight games.  Built with AVX2 (-mavx2 or -march=native), each step of the
+// game is done for eight games with each instruction, choosing between the
+// outcomes with masks instead of branches.  Without AVX2, the games are
+// stepped one after another by plain C that follows pong.c line for line.
+//
+// Either way, each game plays exactly as pong.c would play it.  Each game has
+// its own random numbers, from the same xorshift64 generator as the tuner's
+// HalRandom(), and the simulated player sees the same view of it.  The tuner
+// checks that the results are the same as pong.c's with PONG_SCALING.
+//
+// Only the parts of the game that decide a match are played: the player's
+// presses, the ball, the opponent and the countdown between points.  Nothing
+// is drawn and no time is kept.  As soon as the match in one of the games is
+// over, the next match is started in it, so that the games of a batch are all
+// kept busy until the last few matches.
+//
+//*****************************************************************************
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "pong.h"
+#include "host/sim/batch.h"
+#include "host/sim/player.h"
+
+//*****************************************************************************
+//
+// The columns of the bounce boards, as CollisionDetector() works them out.
+// The bounce boards never move along the x-axis.
+//
+//*****************************************************************************
+#define BATCH_PLAYER_X          (X_MIN + X_WALL_SPACER)
+#define BATCH_OPPONENT_X        ((X_MAX - 1) - X_WALL_SPACER)
+
+//*****************************************************************************
+//
+// Sets up a game for a new match, as MatchRestart() does, with its random
+// numbers starting from ullSeed.
+//
+//*****************************************************************************
+static void
+BatchGameStart(tBatch *psBatch, unsigned long ulGame,
+               unsigned long long ullSeed)
+{
+    psBatch->piPlayerY[ulGame] = Y_MAX / 2;
+    psBatch->piOpponentY[ulGame] = Y_MAX / 2;
+    psBatch->piOpponentDir[ulGame] = OPPONENT_DIRECTION_UP;
+    psBatch->piBallX[ulGame] = BALL_X_ORIGIN;
+    psBatch->piBallY[ulGame] = INT_TO_FIXED(BALL_Y_ORIGIN);
+    psBatch->piBallYStep[ulGame] = 0;
+    psBatch->piBallXDir[ulGame] = BALL_DIRECTION_LEFT;
+    psBatch->piBallYDir[ulGame] = BALL_DIRECTION_UP;
+    psBatch->piActive[ulGame] = 1;
+    psBatch->piSleep[ulGame] = 0;
+    psBatch->piSleepCount[ulGame] = 0;
+    psBatch->piPlayerScore[ulGame] = 0;
+    psBatch->piOpponentScore[ulGame] = 0;
+    psBatch->piOver[ulGame] = 0;
+    psBatch->piTicks[ulGame] = 0;
+    psBatch->piPhase[ulGame] = 0;
+    psBatch->piRallyHits[ulGame] = 0;
+    psBatch->piRallies[ulGame] = 0;
+    psBatch->piHits[ulGame] = 0;
+    psBatch->piLongest[ulGame] = 0;
+    psBatch->pullRandom[ulGame] = ullSeed;
+}
+
+//*****************************************************************************
+//
+// Leaves a game with nothing to play, once there are no more matches for it.
+//
+//*****************************************************************************
+static void
+BatchGameStop(tBatch *psBatch, unsigned long ulGame)
+{
+    psBatch->piActive[ulGame] = 0;
+    psBatch->piSleep[ulGame] = 0;
+    psBatch->piOver[ulGame] = 1;
+}
+
+//*****************************************************************************
+//
+// Reports how a game's match went, as MatchStatsGet() does.
+//
+//*****************************************************************************
+static void
+BatchGameStats(const tBatch *psBatch, unsigned long ulGame,
+               MatchStats *psStats)
+{
+    psStats->over = psBatch->piOver[ulGame];
+    psStats->player_score = psBatch->piPlayerScore[ulGame];
+    psStats->opponent_score = psBatch->piOpponentScore[ulGame];
+    psStats->ticks = psBatch->piTicks[ulGame];
+    psStats->rallies = psBatch->piRallies[ulGame];
+    psStats->hits = psBatch->piHits[ulGame];
+    psStats->longest_rally = psBatch->piLongest[ulGame];
+}
+
+//*****************************************************************************
+//
+// Asks the simulated player of each game in ulGames for its buttons, and moves
+// its bounce board as ProcessInput() does.  The player only presses a button
+// every PLAYER_PERIOD ticks, so the kernel only asks on those ticks.
+//
+//*****************************************************************************
+static void
+BatchInput(tBatch *psBatch, unsigned long ulGames, unsigned long ulReach)
+{
+    PlayerView sView;
+    unsigned long ulGame, ulButtons;
+
+    for(ulGame = 0; ulGames != 0; ulGame++, ulGames >>= 1)
+    {
+        if(!(ulGames & 1))
+        {
+            continue;
+        }
+
+        sView.player_x = BATCH_PLAYER_X;
+        sView.player_y = psBatch->piPlayerY[ulGame];
+        sView.ball_x = psBatch->piBallX[ulGame];
+        sView.ball_y = FIXED_TO_INT(psBatch->piBallY[ulGame]);
+        sView.ball_x_step = BALL_X_SPEED;
+        sView.ball_y_step =
+            ((psBatch->piBallYDir[ulGame] == BALL_DIRECTION_UP) ?
+             -psBatch->piBallYStep[ulGame] : psBatch->piBallYStep[ulGame]);
+        sView.ball_in_play = psBatch->piActive[ulGame];
+        sView.ball_incoming =
+            (psBatch->piBallXDir[ulGame] == BALL_DIRECTION_LEFT);
+
+        ulButtons = PlayerViewButtons(PLAYER_TRACK, ulReach,
+                                      psBatch->piTicks[ulGame], &sView);
+
+        if((ulButtons == HAL_BUTTON_UP) && (psBatch->piPlayerY[ulGame] > 0))
+        {
+            psBatch->piPlayerY[ulGame] -= PLAYER_Y_STEP;
+        }
+        if((ulButtons == HAL_BUTTON_DOWN) &&
+           (psBatch->piPlayerY[ulGame] < Y_MAX - 1))
+        {
+            psBatch->piPlayerY[ulGame] += PLAYER_Y_STEP;
+        }
+    }
+}
+
+#ifdef __AVX2__
+
+//*****************************************************************************
+//
+// Loads and stores eight games' values of a variable, and picks between two
+// vectors of values with a mask.
+//
+//*****************************************************************************
+#define BatchLoad(piArray, ulBase)                                            \
+        _mm256_load_si256((const __m256i *)&(piArray)[ulBase])
+#define BatchStore(piArray, ulBase, vValue)                                   \
+        _mm256_store_si256((__m256i *)&(piArray)[ulBase], (vValue))
+#define BatchSelect(vMask, vTrue, vFalse)                                     \
+        _mm256_blendv_epi8((vFalse), (vTrue), (vMask))
+#define BatchSet(iValue)                                                      \
+        _mm256_set1_epi32(iValue)
+
+//*****************************************************************************
+//
+// Compares vectors as unsigned values, which AVX2 has no instruction for.
+//
+//*****************************************************************************
+static __m256i
+BatchGreaterUnsigned(__m256i vA, __m256i vB)
+{
+    __m256i vSign;
+
+    vSign = BatchSet((int)0x80000000);
+
+    return(_mm256_cmpgt_epi32(_mm256_xor_si256(vA, vSign),
+                              _mm256_xor_si256(vB, vSign)));
+}
+
+//*****************************************************************************
+//
+// BallReachesX() for eight games.
+//
+//*****************************************************************************
+static __m256i
+BatchReaches(__m256i vBallX, __m256i vLeft, int iX)
+{
+    __m256i vX, vLeftReach, vRightReach;
+
+    vX = BatchSet(iX);
+    vLeftReach = _mm256_andnot_si256(
+        _mm256_cmpgt_epi32(vX, vBallX),
+        _mm256_cmpgt_epi32(vX, _mm256_sub_epi32(vBallX,
+                                                BatchSet(BALL_X_SPEED))));
+    vRightReach = _mm256_andnot_si256(
+        _mm256_cmpgt_epi32(vBallX, vX),
+        _mm256_cmpgt_epi32(_mm256_add_epi32(vBallX, BatchSet(BALL_X_SPEED)),
+                           vX));
+
+    return(BatchSelect(vLeft, vLeftReach, vRightReach));
+}
+
+//*****************************************************************************
+//
+// BallYAtX() for eight games.  The part of the y-axis step is divided by the
+// x-axis step in single precision, which is exact for these small values.
+//
+//*****************************************************************************
+static __m256i
+BatchBallYAt(__m256i vBallX, __m256i vBallY, __m256i vYStep, __m256i vDown,
+             int iX)
+{
+    __m256i vTravel;
+
+    vTravel = _mm256_mullo_epi32(vYStep,
+                                 _mm256_abs_epi32(_mm256_sub_epi32(vBallX,
+                                                               BatchSet(iX))));
+#if BALL_X_SPEED != 1
+    vTravel = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(vTravel),
+                                                _mm256_set1_ps(BALL_X_SPEED)));
+#endif
+
+    return(_mm256_srai_epi32(BatchSelect(vDown,
+                                         _mm256_add_epi32(vBallY, vTravel),
+                                         _mm256_sub_epi32(vBallY, vTravel)),
+                             FIXED_SHIFT));
+}
+
+//*****************************************************************************
+//
+// IsYBounceable() for eight games.
+//
+//*****************************************************************************
+static __m256i
+BatchBounceable(__m256i vBoard, __m256i vY)
+{
+    return(_mm256_and_si256(
+        _mm256_cmpgt_epi32(_mm256_add_epi32(vBoard, BatchSet(BOARD_TOLERANCE)),
+                           vY),
+        _mm256_cmpgt_epi32(vY, _mm256_sub_epi32(vBoard,
+                                                BatchSet(BOARD_TOLERANCE)))));
+}
+
+//*****************************************************************************
+//
+// BallYBounceAngle() for eight games.  The regions are picked from the last
+// to the first, so that the first one that matches is the one that is kept.
+//
+//*****************************************************************************
+static __m256i
+BatchBounceAngle(__m256i vBoard, __m256i vY)
+{
+    __m256i vBelow, vAbove, vAngle;
+
+    vBelow = _mm256_cmpgt_epi32(vY, vBoard);
+    vAbove = _mm256_cmpgt_epi32(vBoard, vY);
+    vAngle = _mm256_setzero_si256();
+
+    // top
+    vAngle = BatchSelect(_mm256_and_si256(vAbove, _mm256_cmpgt_epi32(vY,
+                             _mm256_sub_epi32(vBoard,
+                                              BatchSet(BOARD_TOLERANCE)))),
+                         BatchSet(BALL_Y_STEP_WIDE), vAngle);
+    // middle-top
+    vAngle = BatchSelect(_mm256_and_si256(vAbove, _mm256_cmpgt_epi32(vY,
+                             _mm256_sub_epi32(vBoard,
+                                  BatchSet(BOARD_TOLERANCE -
+                                           BOARD_SHALLOW_ANGLE_OFFSET)))),
+                         BatchSet(BALL_Y_STEP_SHALLOW), vAngle);
+    // middle
+    vAngle = BatchSelect(_mm256_cmpeq_epi32(vBoard, vY),
+                         _mm256_setzero_si256(), vAngle);
+    // middle-bottom
+    vAngle = BatchSelect(_mm256_and_si256(vBelow, _mm256_cmpgt_epi32(
+                             _mm256_add_epi32(vBoard,
+                                  BatchSet(BOARD_TOLERANCE -
+                                           BOARD_SHALLOW_ANGLE_OFFSET)), vY)),
+                         BatchSet(BALL_Y_STEP_SHALLOW), vAngle);
+    // bottom
+    vAngle = BatchSelect(_mm256_and_si256(vBelow, _mm256_cmpgt_epi32(
+                             _mm256_add_epi32(vBoard,
+                                              BatchSet(BOARD_TOLERANCE)), vY)),
+                         BatchSet(BALL_Y_STEP_WIDE), vAngle);
+
+    return(vAngle);
+}
+
+//*****************************************************************************
+//
+// Takes the next random number of four games whose 64-bit masks are set, and
+// returns OPPONENT_VOTE(HalRandom()) for each of them in 64-bit lanes.
+//
+//*****************************************************************************
+static __m256i
+BatchVoteHalf(unsigned long long *pullRandom, __m128i vMask)
+{
+    __m256i vState, vNext;
+
+    vState = _mm256_load_si256((const __m256i *)pullRandom);
+    vNext = _mm256_xor_si256(vState, _mm256_slli_epi64(vState, 13));
+    vNext = _mm256_xor_si256(vNext, _mm256_srli_epi64(vNext, 7));
+    vNext = _mm256_xor_si256(vNext, _mm256_slli_epi64(vNext, 17));
+    _mm256_store_si256((__m256i *)pullRandom,
+                       BatchSelect(_mm256_cvtepi32_epi64(vMask), vNext,
+                                   vState));
+
+    return(_mm256_and_si256(_mm256_srli_epi64(vNext, 33 + 7),
+                            _mm256_set1_epi64x(0xff)));
+}
+
+//*****************************************************************************
+//
+// Takes a lottery vote, OPPONENT_VOTE(HalRandom()), for each of eight games
+// whose mask is set.  The other games' random numbers are left as they are.
+//
+//*****************************************************************************
+static __m256i
+BatchVote(tBatch *psBatch, unsigned long ulBase, __m256i vMask)
+{
+    __m256i vIndex, vLow, vHigh;
+
+    vLow = BatchVoteHalf(&psBatch->pullRandom[ulBase],
+                         _mm256_castsi256_si128(vMask));
+    vHigh = BatchVoteHalf(&psBatch->pullRandom[ulBase + 4],
+                          _mm256_extracti128_si256(vMask, 1));
+
+    //
+    // Gather the low halves of the 64-bit lanes into eight 32-bit lanes.
+    //
+    vIndex = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    vLow = _mm256_permutevar8x32_epi32(vLow, vIndex);
+    vHigh = _mm256_permutevar8x32_epi32(vHigh, vIndex);
+
+    return(_mm256_inserti128_si256(vLow, _mm256_castsi256_si128(vHigh), 1));
+}
+
+//*****************************************************************************
+//
+// Steps the eight games from ulBase by one tick, as GameStep() does.  Sets the
+// bits of the games whose matches ended in *pulFinished, and of the games
+// whose players press a button on the next tick in *pulInput.
+//
+//*****************************************************************************
+static void
+BatchStepVector(tBatch *psBatch, unsigned long ulBase,
+                unsigned long *pulFinished, unsigned long *pulInput)
+{
+    __m256i vOne, vMaxTicks, vOver, vTicks, vPhase, vLive, vActiveFlag;
+    __m256i vSleepFlag, vActive, vSleeping, vCount, vServe;
+    __m256i vBallX, vBallY, vYStep, vXDir, vYDir, vPlayerY, vOpponentY;
+    __m256i vOpponentDir, vPlayerScore, vOpponentScore, vRallyHits;
+    __m256i vRallies, vHits, vLongest;
+    __m256i vLeft, vDown, vUp, vPlayerAt, vOpponentAt, vHitPlayer;
+    __m256i vHitOpponent, vHit, vRest, vWallPlayer, vWallOpponent, vPoint;
+    __m256i vWin, vBoard, vY, vBoardX, vNewX, vGoDown, vGoUp, vTurn;
+    __m256i vVote, vInvincible, vLinear, vBand, vFar, vNear;
+
+    vOne = BatchSet(1);
+    vMaxTicks = BatchSet(psBatch->iMaxTicks);
+
+    //
+    // Only the games whose matches are still being played are stepped.
+    //
+    vOver = BatchLoad(psBatch->piOver, ulBase);
+    vTicks = BatchLoad(psBatch->piTicks, ulBase);
+    vLive = _mm256_andnot_si256(_mm256_cmpeq_epi32(vOver, vOne),
+                                _mm256_cmpgt_epi32(vMaxTicks, vTicks));
+    if(_mm256_testz_si256(vLive, vLive))
+    {
+        *pulFinished = 0;
+        *pulInput = 0;
+        return;
+    }
+
+    vTicks = _mm256_sub_epi32(vTicks, vLive);
+    vPhase = _mm256_sub_epi32(BatchLoad(psBatch->piPhase, ulBase), vLive);
+    vPhase = BatchSelect(_mm256_cmpeq_epi32(vPhase, BatchSet(PLAYER_PERIOD)),
+                         _mm256_setzero_si256(), vPhase);
+
+    vActiveFlag = BatchLoad(psBatch->piActive, ulBase);
+    vSleepFlag = BatchLoad(psBatch->piSleep, ulBase);
+    vCount = BatchLoad(psBatch->piSleepCount, ulBase);
+    vActive = _mm256_and_si256(_mm256_cmpeq_epi32(vActiveFlag, vOne), vLive);
+    vSleeping = _mm256_and_si256(_mm256_cmpeq_epi32(vSleepFlag, vOne), vLive);
+
+    vBallX = BatchLoad(psBatch->piBallX, ulBase);
+    vBallY = BatchLoad(psBatch->piBallY, ulBase);
+    vYStep = BatchLoad(psBatch->piBallYStep, ulBase);
+    vXDir = BatchLoad(psBatch->piBallXDir, ulBase);
+    vYDir = BatchLoad(psBatch->piBallYDir, ulBase);
+    vPlayerY = BatchLoad(psBatch->piPlayerY, ulBase);
+    vOpponentY = BatchLoad(psBatch->piOpponentY, ulBase);
+    vOpponentDir = BatchLoad(psBatch->piOpponentDir, ulBase);
+    vPlayerScore = BatchLoad(psBatch->piPlayerScore, ulBase);
+    vOpponentScore = BatchLoad(psBatch->piOpponentScore, ulBase);
+    vRallyHits = BatchLoad(psBatch->piRallyHits, ulBase);
+    vRallies = BatchLoad(psBatch->piRallies, ulBase);
+    vHits = BatchLoad(psBatch->piHits, ulBase);
+    vLongest = BatchLoad(psBatch->piLongest, ulBase);
+
+    if(!_mm256_testz_si256(vActive, vActive))
+    {
+        //
+        // CollisionDetector(): each game takes the first of the player's
+        // bounce board, the opponent's, the player's wall and the opponent's
+        // wall that the ball reaches.
+        //
+        vLeft = _mm256_cmpeq_epi32(vXDir, BatchSet(BALL_DIRECTION_LEFT));
+        vDown = _mm256_cmpeq_epi32(vYDir, BatchSet(BALL_DIRECTION_DOWN));
+        vPlayerAt = BatchBallYAt(vBallX, vBallY, vYStep, vDown,
+                                 BATCH_PLAYER_X);
+        vOpponentAt = BatchBallYAt(vBallX, vBallY, vYStep, vDown,
+                                   BATCH_OPPONENT_X);
+
+        vHitPlayer = _mm256_and_si256(
+            _mm256_and_si256(vActive, vLeft),
+            _mm256_and_si256(BatchReaches(vBallX, vLeft, BATCH_PLAYER_X),
+                             BatchBounceable(vPlayerY, vPlayerAt)));
+        vHitOpponent = _mm256_and_si256(
+            _mm256_andnot_si256(vLeft, vActive),
+            _mm256_and_si256(BatchReaches(vBallX, vLeft, BATCH_OPPONENT_X),
+                             BatchBounceable(vOpponentY, vOpponentAt)));
+        vHit = _mm256_or_si256(vHitPlayer, vHitOpponent);
+
+        vRest = _mm256_andnot_si256(vHit, vActive);
+        vWallPlayer = _mm256_and_si256(vRest,
+                                       BatchReaches(vBallX, vLeft, X_MIN));
+        vRest = _mm256_andnot_si256(vWallPlayer, vRest);
+        vWallOpponent = _mm256_and_si256(vRest,
+                                         BatchReaches(vBallX, vLeft, X_MAX));
+        vPoint = _mm256_or_si256(vWallPlayer, vWallOpponent);
+
+        //
+        // The ball bounces off a bounce board.
+        //
+        vBoard = BatchSelect(vHitPlayer, vPlayerY, vOpponentY);
+        vY = BatchSelect(vHitPlayer, vPlayerAt, vOpponentAt);
+        vBoardX = BatchSelect(vHitPlayer, BatchSet(BATCH_PLAYER_X),
+                              BatchSet(BATCH_OPPONENT_X));
+
+        vBallX = BatchSelect(vHit, _mm256_sub_epi32(_mm256_add_epi32(vBoardX,
+                                                                     vBoardX),
+                                                    vBallX), vBallX);
+        vXDir = BatchSelect(vHitPlayer, BatchSet(BALL_DIRECTION_RIGHT),
+                            BatchSelect(vHitOpponent,
+                                        BatchSet(BALL_DIRECTION_LEFT), vXDir));
+        vRallyHits = _mm256_sub_epi32(vRallyHits, vHit);
+        vYStep = BatchSelect(vHit, BatchBounceAngle(vBoard, vY), vYStep);
+        vYDir = BatchSelect(vHit,
+                    BatchSelect(_mm256_and_si256(
+                                    _mm256_cmpgt_epi32(vY, vBoard),
+                                    _mm256_cmpgt_epi32(
+                                        _mm256_add_epi32(vBoard,
+                                            BatchSet(BOARD_TOLERANCE)), vY)),
+                                BatchSet(BALL_DIRECTION_DOWN),
+                                BatchSelect(_mm256_cmpeq_epi32(vBoard, vY),
+                                            vYDir,
+                                            BatchSet(BALL_DIRECTION_UP))),
+                    vYDir);
+
+        //
+        // A point is won, which ends the rally, and the match if it was the
+        // last point.  Otherwise the ball goes back to the middle for the
+        // countdown.
+        //
+        vYStep = _mm256_andnot_si256(vPoint, vYStep);
+        vRallies = _mm256_sub_epi32(vRallies, vPoint);
+        vHits = _mm256_add_epi32(vHits, _mm256_and_si256(vPoint, vRallyHits));
+        vLongest = BatchSelect(_mm256_and_si256(vPoint,
+                                   _mm256_cmpgt_epi32(vRallyHits, vLongest)),
+                               vRallyHits, vLongest);
+        vRallyHits = _mm256_andnot_si256(vPoint, vRallyHits);
+
+        vWin = _mm256_or_si256(
+            _mm256_and_si256(vWallPlayer,
+                             _mm256_cmpeq_epi32(vOpponentScore,
+                                                BatchSet(MATCH_POINTS - 1))),
+            _mm256_and_si256(vWallOpponent,
+                             _mm256_cmpeq_epi32(vPlayerScore,
+                                                BatchSet(MATCH_POINTS - 1))));
+        vOpponentScore = _mm256_sub_epi32(vOpponentScore, vWallPlayer);
+        vPlayerScore = _mm256_sub_epi32(vPlayerScore, vWallOpponent);
+        vActiveFlag = _mm256_andnot_si256(vPoint, vActiveFlag);
+        vOver = BatchSelect(vWin, vOne, vOver);
+
+        vServe = _mm256_andnot_si256(vWin, vPoint);
+        vSleepFlag = BatchSelect(vServe, vOne, vSleepFlag);
+        vBallY = BatchSelect(vServe, BatchSet(INT_TO_FIXED(BALL_Y_ORIGIN)),
+                             vBallY);
+        vBallX = BatchSelect(vServe, BatchSet(BALL_X_ORIGIN), vBallX);
+
+        //
+        // BallMovement(), which still moves the ball on the tick that a point
+        // is won.
+        //
+        vLeft = _mm256_cmpeq_epi32(vXDir, BatchSet(BALL_DIRECTION_LEFT));
+        vNewX = BatchSelect(vLeft,
+                    BatchSelect(_mm256_cmpgt_epi32(vBallX,
+                                    BatchSet(X_MIN + BALL_X_SPEED - 1)),
+                                _mm256_sub_epi32(vBallX,
+                                                 BatchSet(BALL_X_SPEED)),
+                                BatchSet(X_MIN)),
+                    BatchSelect(_mm256_cmpgt_epi32(
+                                    _mm256_add_epi32(vBallX,
+                                                     BatchSet(BALL_X_SPEED)),
+                                    BatchSet(X_MAX)),
+                                BatchSet(X_MAX),
+                                _mm256_add_epi32(vBallX,
+                                                 BatchSet(BALL_X_SPEED))));
+        vBallX = BatchSelect(vActive, vNewX, vBallX);
+
+        vDown = _mm256_cmpeq_epi32(vYDir, BatchSet(BALL_DIRECTION_DOWN));
+        vGoDown = _mm256_and_si256(_mm256_and_si256(vActive, vDown),
+                      _mm256_cmpgt_epi32(BatchSet(INT_TO_FIXED(Y_MAX - 1)),
+                                         vBallY));
+        vGoUp = _mm256_and_si256(_mm256_andnot_si256(vDown, vActive),
+                    _mm256_cmpgt_epi32(vBallY,
+                                       BatchSet(INT_TO_FIXED(Y_MIN + 1))));
+        vTurn = _mm256_andnot_si256(_mm256_or_si256(vGoDown, vGoUp), vActive);
+        vBallY = _mm256_add_epi32(vBallY, _mm256_and_si256(vGoDown, vYStep));
+        vBallY = _mm256_sub_epi32(vBallY, _mm256_and_si256(vGoUp, vYStep));
+        vYDir = _mm256_xor_si256(vYDir, _mm256_and_si256(vTurn, vOne));
+
+        //
+        // OpponentMovement(): the lottery, then the move.  The band is
+        // compared as unsigned values, as it is in pong.c.
+        //
+        vVote = BatchVote(psBatch, ulBase, vActive);
+        vInvincible = _mm256_and_si256(vActive, _mm256_cmpgt_epi32(
+                          BatchSet(psBatch->sProfile.invincible), vVote));
+        vBand = BatchSet(psBatch->sProfile.band);
+        vFar = BatchGreaterUnsigned(vBallY, _mm256_slli_epi32(
+                   _mm256_sub_epi32(vOpponentY, vBand), FIXED_SHIFT));
+        vNear = BatchGreaterUnsigned(_mm256_slli_epi32(
+                    _mm256_add_epi32(vOpponentY, vBand), FIXED_SHIFT), vBallY);
+        vOpponentDir = BatchSelect(vInvincible,
+                           BatchSelect(vFar, BatchSet(OPPONENT_DIRECTION_DOWN),
+                               BatchSelect(vNear,
+                                           BatchSet(OPPONENT_DIRECTION_UP),
+                                           vOpponentDir)),
+                           vOpponentDir);
+
+        vLinear = _mm256_andnot_si256(vInvincible, vActive);
+        vVote = BatchVote(psBatch, ulBase, vLinear);
+        vOpponentDir = _mm256_xor_si256(vOpponentDir, _mm256_and_si256(
+                           _mm256_andnot_si256(_mm256_cmpgt_epi32(
+                               BatchSet(psBatch->sProfile.turn), vVote),
+                               vLinear), vOne));
+
+        vUp = _mm256_cmpeq_epi32(vOpponentDir,
+                                 BatchSet(OPPONENT_DIRECTION_UP));
+        vGoUp = _mm256_and_si256(_mm256_and_si256(vActive, vUp),
+                                 _mm256_cmpgt_epi32(vOpponentY,
+                                                    BatchSet(Y_MIN)));
+        vGoDown = _mm256_and_si256(_mm256_andnot_si256(vUp, vActive),
+                                   _mm256_cmpgt_epi32(BatchSet(Y_MAX),
+                                                      vOpponentY));
+        vTurn = _mm256_andnot_si256(_mm256_or_si256(vGoDown, vGoUp), vActive);
+        vOpponentY = _mm256_add_epi32(vOpponentY, vGoUp);
+        vOpponentY = _mm256_sub_epi32(vOpponentY, vGoDown);
+        vOpponentDir = _mm256_xor_si256(vOpponentDir,
+                                        _mm256_and_si256(vTurn, vOne));
+    }
+
+    //
+    // The countdown between points.
+    //
+    vCount = _mm256_sub_epi32(vCount, vSleeping);
+    vServe = _mm256_and_si256(vSleeping,
+                              _mm256_cmpgt_epi32(vCount,
+                                                 BatchSet(COUNTDOWN_TICKS)));
+    vCount = _mm256_andnot_si256(vServe, vCount);
+    vSleepFlag = _mm256_andnot_si256(vServe, vSleepFlag);
+    vActiveFlag = BatchSelect(vServe, vOne, vActiveFlag);
+
+    BatchStore(psBatch->piOver, ulBase, vOver);
+    BatchStore(psBatch->piTicks, ulBase, vTicks);
+    BatchStore(psBatch->piPhase, ulBase, vPhase);
+    BatchStore(psBatch->piActive, ulBase, vActiveFlag);
+    BatchStore(psBatch->piSleep, ulBase, vSleepFlag);
+    BatchStore(psBatch->piSleepCount, ulBase, vCount);
+    BatchStore(psBatch->piBallX, ulBase, vBallX);
+    BatchStore(psBatch->piBallY, ulBase, vBallY);
+    BatchStore(psBatch->piBallYStep, ulBase, vYStep);
+    BatchStore(psBatch->piBallXDir, ulBase, vXDir);
+    BatchStore(psBatch->piBallYDir, ulBase, vYDir);
+    BatchStore(psBatch->piOpponentY, ulBase, vOpponentY);
+    BatchStore(psBatch->piOpponentDir, ulBase, vOpponentDir);
+    BatchStore(psBatch->piPlayerScore, ulBase, vPlayerScore);
+    BatchStore(psBatch->piOpponentScore, ulBase, vOpponentScore);
+    BatchStore(psBatch->piRallyHits, ulBase, vRallyHits);
+    BatchStore(psBatch->piRallies, ulBase, vRallies);
+    BatchStore(psBatch->piHits, ulBase, vHits);
+    BatchStore(psBatch->piLongest, ulBase, vLongest);
+
+    //
+    // The games whose matches were being played, and are now over or out of
+    // ticks, have finished.
+    //
+    vActive = _mm256_andnot_si256(_mm256_cmpeq_epi32(vOver, vOne),
+                                  _mm256_cmpgt_epi32(vMaxTicks, vTicks));
+    *pulFinished = _mm256_movemask_ps(_mm256_castsi256_ps(
+                       _mm256_andnot_si256(vActive, vLive)));
+    *pulInput = _mm256_movemask_ps(_mm256_castsi256_ps(
+                    _mm256_and_si256(vActive,
+                                     _mm256_cmpeq_epi32(vPhase,
+                                         _mm256_setzero_si256()))));
+}
+
+//*****************************************************************************
+//
+// Steps all the games by one tick, eight at a time.
+//
+//*****************************************************************************
+static void
+BatchStep(tBatch *psBatch, unsigned long *pulFinished, unsigned long *pulInput)
+{
+    unsigned long ulBase, ulFinished, ulInput;
+
+    *pulFinished = 0;
+    *pulInput = 0;
+
+    for(ulBase = 0; ulBase < BATCH_GAMES; ulBase += 8)
+    {
+        BatchStepVector(psBatch, ulBase, &ulFinished, &ulInput);
+        *pulFinished |= ulFinished << ulBase;
+        *pulInput |= ulInput << ulBase;
+    }
+}
+
+#else
+
+//*****************************************************************************
+//
+// HalRandom() for one game.
+//
+//*****************************************************************************
+static int
+BatchRandom(tBatch *psBatch, unsigned long ulGame)
+{
+    unsigned long long ullRandom;
+
+    ullRandom = psBatch->pullRandom[ulGame];
+    ullRandom ^= ullRandom << 13;
+    ullRandom ^= ullRandom >> 7;
+    ullRandom ^= ullRandom << 17;
+    psBatch->pullRandom[ulGame] = ullRandom;
+
+    return((int)(ullRandom >> 33));
+}
+
+//*****************************************************************************
+//
+// BallReachesX() for one game.
+//
+//*****************************************************************************
+static int
+BatchReaches(const tBatch *psBatch, unsigned long ulGame, int iX)
+{
+    int iBallX;
+
+    iBallX = psBatch->piBallX[ulGame];
+
+    if(psBatch->piBallXDir[ulGame] == BALL_DIRECTION_LEFT)
+    {
+        return((iBallX >= iX) && (iBallX - BALL_X_SPEED < iX));
+    }
+
+    return((iBallX <= iX) && (iBallX + BALL_X_SPEED > iX));
+}
+
+//*****************************************************************************
+//
+// BallYAtX() for one game.
+//
+//*****************************************************************************
+static int
+BatchBallYAt(const tBatch *psBatch, unsigned long ulGame, int iX)
+{
+    int iDistance, iTravel;
+
+    iDistance = psBatch->piBallX[ulGame] - iX;
+    if(iDistance < 0)
+    {
+        iDistance = -iDistance;
+    }
+
+    iTravel = (psBatch->piBallYStep[ulGame] * iDistance) / BALL_X_SPEED;
+
+    if(psBatch->piBallYDir[ulGame] == BALL_DIRECTION_DOWN)
+    {
+        return(FIXED_TO_INT(psBatch->piBallY[ulGame] + iTravel));
+    }
+
+    return(FIXED_TO_INT(psBatch->piBallY[ulGame] - iTravel));
+}
+
+//*****************************************************************************
+//
+// IsYBounceable() for one game.
+//
+//*****************************************************************************
+static int
+BatchBounceable(int iBoard, int iY)
+{
+    return((iBoard + BOARD_TOLERANCE > iY) && (iBoard - BOARD_TOLERANCE < iY));
+}
+
+//*****************************************************************************
+//
+// BallYBounceAngle() for one game.
+//
+//*****************************************************************************
+static int
+BatchBounceAngle(int iBoard, int iY)
+{
+    if((iBoard + BOARD_TOLERANCE > iY) && (iBoard < iY))
+    {
+        return(BALL_Y_STEP_WIDE);
+    }
+    if((iBoard + BOARD_TOLERANCE - BOARD_SHALLOW_ANGLE_OFFSET > iY) &&
+       (iBoard < iY))
+    {
+        return(BALL_Y_STEP_SHALLOW);
+    }
+    if(iBoard == iY)
+    {
+        return(0);
+    }
+    if((iBoard - BOARD_TOLERANCE + BOARD_SHALLOW_ANGLE_OFFSET < iY) &&
+       (iBoard > iY))
+    {
+        return(BALL_Y_STEP_SHALLOW);
+    }
+    if((iBoard - BOARD_TOLERANCE < iY) && (iBoard > iY))
+    {
+        return(BALL_Y_STEP_WIDE);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Bounces the ball of one game off the bounce board at column iBoardX and row
+// iBoard, which it reaches at row iY.
+//
+//*****************************************************************************
+static void
+BatchBounce(tBatch *psBatch, unsigned long ulGame, int iBoardX, int iBoard,
+            int iY, int iDirection)
+{
+    psBatch->piBallX[ulGame] = (2 * iBoardX) - psBatch->piBallX[ulGame];
+    psBatch->piBallXDir[ulGame] = iDirection;
+    psBatch->piRallyHits[ulGame]++;
+    psBatch->piBallYStep[ulGame] = BatchBounceAngle(iBoard, iY);
+
+    if((iBoard + BOARD_TOLERANCE > iY) && (iBoard < iY))
+    {
+        psBatch->piBallYDir[ulGame] = BALL_DIRECTION_DOWN;
+    }
+    else if(iBoard != iY)
+    {
+        psBatch->piBallYDir[ulGame] = BALL_DIRECTION_UP;
+    }
+}
+
+//*****************************************************************************
+//
+// Gives a point to one side of one game, whose score is at piScore.
+//
+//*****************************************************************************
+static void
+BatchPoint(tBatch *psBatch, unsigned long ulGame, int *piScore)
+{
+    psBatch->piBallYStep[ulGame] = 0;
+
+    psBatch->piRallies[ulGame]++;
+    psBatch->piHits[ulGame] += psBatch->piRallyHits[ulGame];
+    if(psBatch->piRallyHits[ulGame] > psBatch->piLongest[ulGame])
+    {
+        psBatch->piLongest[ulGame] = psBatch->piRallyHits[ulGame];
+    }
+    psBatch->piRallyHits[ulGame] = 0;
+
+    psBatch->piActive[ulGame] = 0;
+    if(*piScore == MATCH_POINTS - 1)
+    {
+        psBatch->piOver[ulGame] = 1;
+    }
+    else
+    {
+        psBatch->piSleep[ulGame] = 1;
+        psBatch->piBallY[ulGame] = INT_TO_FIXED(BALL_Y_ORIGIN);
+        psBatch->piBallX[ulGame] = BALL_X_ORIGIN;
+    }
+    (*piScore)++;
+}
+
+//*****************************************************************************
+//
+// Steps one game by one tick, as GameStep() does.
+//
+//*****************************************************************************
+static void
+BatchGameStep(tBatch *psBatch, unsigned long ulGame)
+{
+    int iY;
+
+    if(psBatch->piActive[ulGame])
+    {
+        //
+        // CollisionDetector()
+        //
+        if((psBatch->piBallXDir[ulGame] == BALL_DIRECTION_LEFT) &&
+           BatchReaches(psBatch, ulGame, BATCH_PLAYER_X) &&
+           BatchBounceable(psBatch->piPlayerY[ulGame],
+                           BatchBallYAt(psBatch, ulGame, BATCH_PLAYER_X)))
+        {
+            iY = BatchBallYAt(psBatch, ulGame, BATCH_PLAYER_X);
+            BatchBounce(psBatch, ulGame, BATCH_PLAYER_X,
+                        psBatch->piPlayerY[ulGame], iY, BALL_DIRECTION_RIGHT);
+        }
+        else if((psBatch->piBallXDir[ulGame] == BALL_DIRECTION_RIGHT) &&
+                BatchReaches(psBatch, ulGame, BATCH_OPPONENT_X) &&
+                BatchBounceable(psBatch->piOpponentY[ulGame],
+                                BatchBallYAt(psBatch, ulGame,
+                                             BATCH_OPPONENT_X)))
+        {
+            iY = BatchBallYAt(psBatch, ulGame, BATCH_OPPONENT_X);
+            BatchBounce(psBatch, ulGame, BATCH_OPPONENT_X,
+                        psBatch->piOpponentY[ulGame], iY, BALL_DIRECTION_LEFT);
+        }
+        else if(BatchReaches(psBatch, ulGame, X_MIN))
+        {
+            BatchPoint(psBatch, ulGame, &psBatch->piOpponentScore[ulGame]);
+        }
+        else if(BatchReaches(psBatch, ulGame, X_MAX))
+        {
+            BatchPoint(psBatch, ulGame, &psBatch->piPlayerScore[ulGame]);
+        }
+
+        //
+        // BallMovement()
+        //
+        if(psBatch->piBallXDir[ulGame] == BALL_DIRECTION_LEFT)
+        {
+            if(psBatch->piBallX[ulGame] >= X_MIN + BALL_X_SPEED)
+            {
+                psBatch->piBallX[ulGame] -= BALL_X_SPEED;
+            }
+            else
+            {
+                psBatch->piBallX[ulGame] = X_MIN;
+            }
+        }
+        else
+        {
+            if(psBatch->piBallX[ulGame] + BALL_X_SPEED <= X_MAX)
+            {
+                psBatch->piBallX[ulGame] += BALL_X_SPEED;
+            }
+            else
+            {
+                psBatch->piBallX[ulGame] = X_MAX;
+            }
+        }
+
+        if(psBatch->piBallYDir[ulGame] == BALL_DIRECTION_DOWN)
+        {
+            if(psBatch->piBallY[ulGame] < INT_TO_FIXED(Y_MAX - 1))
+            {
+                psBatch->piBallY[ulGame] += psBatch->piBallYStep[ulGame];
+            }
+            else
+            {
+                psBatch->piBallYDir[ulGame] = BALL_DIRECTION_UP;
+            }
+        }
+        else
+        {
+            if(psBatch->piBallY[ulGame] > INT_TO_FIXED(Y_MIN + 1))
+            {
+                psBatch->piBallY[ulGame] -= psBatch->piBallYStep[ulGame];
+            }
+            else
+            {
+                psBatch->piBallYDir[ulGame] = BALL_DIRECTION_DOWN;
+            }
+        }
+
+        //
+        // OpponentMovement().  The band is compared as unsigned values, as it
+        // is in pong.c.
+        //
+        if(OPPONENT_VOTE(BatchRandom(psBatch, ulGame)) <
+           psBatch->sProfile.invincible)
+        {
+            if((unsigned int)psBatch->piBallY[ulGame] >
+               INT_TO_FIXED((unsigned int)psBatch->piOpponentY[ulGame] -
+                            psBatch->sProfile.band))
+            {
+                psBatch->piOpponentDir[ulGame] = OPPONENT_DIRECTION_DOWN;
+            }
+            else if((unsigned int)psBatch->piBallY[ulGame] <
+                    INT_TO_FIXED((unsigned int)psBatch->piOpponentY[ulGame] +
+                                 psBatch->sProfile.band))
+            {
+                psBatch->piOpponentDir[ulGame] = OPPONENT_DIRECTION_UP;
+            }
+        }
+        else if(OPPONENT_VOTE(BatchRandom(psBatch, ulGame)) >=
+                psBatch->sProfile.turn)
+        {
+            psBatch->piOpponentDir[ulGame] =
+                ((psBatch->piOpponentDir[ulGame] == OPPONENT_DIRECTION_UP) ?
+                 OPPONENT_DIRECTION_DOWN : OPPONENT_DIRECTION_UP);
+        }
+
+        if(psBatch->piOpponentDir[ulGame] == OPPONENT_DIRECTION_UP)
+        {
+            if(psBatch->piOpponentY[ulGame] > Y_MIN)
+            {
+                psBatch->piOpponentY[ulGame]--;
+            }
+            else
+            {
+                psBatch->piOpponentDir[ulGame] = OPPONENT_DIRECTION_DOWN;
+            }
+        }
+        else
+        {
+            if(psBatch->piOpponentY[ulGame] < Y_MAX)
+            {
+                psBatch->piOpponentY[ulGame]++;
+            }
+            else
+            {
+                psBatch->piOpponentDir[ulGame] = OPPONENT_DIRECTION_UP;
+            }
+        }
+    }
+    else if(psBatch->piSleep[ulGame])
+    {
+        //
+        // The countdown between points.
+        //
+        psBatch->piSleepCount[ulGame]++;
+        if(psBatch->piSleepCount[ulGame] > COUNTDOWN_TICKS)
+        {
+            psBatch->piSleepCount[ulGame] = 0;
+            psBatch->piSleep[ulGame] = 0;
+            psBatch->piActive[ulGame] = 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Steps all the games by one tick, one after another.  Sets the bits of the
+// games whose matches ended in *pulFinished, and of the games whose players
+// press a button on the next tick in *pulInput.
+//
+//*****************************************************************************
+static void
+BatchStep(tBatch *psBatch, unsigned long *pulFinished, unsigned long *pulInput)
+{
+    unsigned long ulGame;
+
+    *pulFinished = 0;
+    *pulInput = 0;
+
+    for(ulGame = 0; ulGame < BATCH_GAMES; ulGame++)
+    {
+        if(psBatch->piOver[ulGame] ||
+           (psBatch->piTicks[ulGame] >= psBatch->iMaxTicks))
+        {
+            continue;
+        }
+
+        psBatch->piTicks[ulGame]++;
+        psBatch->piPhase[ulGame]++;
+        if(psBatch->piPhase[ulGame] == PLAYER_PERIOD)
+        {
+            psBatch->piPhase[ulGame] = 0;
+        }
+
+        BatchGameStep(psBatch, ulGame);
+
+        if(psBatch->piOver[ulGame] ||
+           (psBatch->piTicks[ulGame] >= psBatch->iMaxTicks))
+        {
+            *pulFinished |= 1 << ulGame;
+        }
+        else if(psBatch->piPhase[ulGame] == 0)
+        {
+            *pulInput |= 1 << ulGame;
+        }
+    }
+}
+
+#endif
+
+//*****************************************************************************
+//
+// Plays ulMatches matches against an opponent with the odds psOdds, and the
+// tracking player with a reach of ulReach, each for at most ulMaxTicks ticks.
+// Match n starts its random numbers from pullSeeds[n], which must not be 0,
+// and how it went is put in psStats[n].
+//
+//*****************************************************************************
+void
+BatchPlay(tBatch *psBatch, const OpponentOdds *psOdds, unsigned long ulReach,
+          unsigned long ulMaxTicks, const unsigned long long *pullSeeds,
+          MatchStats *psStats, unsigned long ulMatches)
+{
+    unsigned long pulMatch[BATCH_GAMES];
+    unsigned long ulGame, ulNext, ulBusy, ulFinished, ulInput;
+
+    OpponentProfileFromOdds(&psBatch->sProfile, psOdds);
+    psBatch->iMaxTicks = ulMaxTicks;
+
+    ulNext = 0;
+    ulBusy = 0;
+    for(ulGame = 0; ulGame < BATCH_GAMES; ulGame++)
+    {
+        if((ulNext < ulMatches) && (ulMaxTicks != 0))
+        {
+            BatchGameStart(psBatch, ulGame, pullSeeds[ulNext]);
+            pulMatch[ulGame] = ulNext++;
+            ulBusy |= 1 << ulGame;
+        }
+        else
+        {
+            BatchGameStop(psBatch, ulGame);
+        }
+    }
+
+    //
+    // The player is asked for its buttons on the first tick of each match.
+    //
+    ulInput = ulBusy;
+
+    while(ulBusy)
+    {
+        if(ulInput)
+        {
+            BatchInput(psBatch, ulInput, ulReach);
+        }
+
+        BatchStep(psBatch, &ulFinished, &ulInput);
+
+        for(ulGame = 0; ulFinished != 0; ulGame++, ulFinished >>= 1)
+        {
+            if(!(ulFinished & 1))
+            {
+                continue;
+            }
+
+            BatchGameStats(psBatch, ulGame, &psStats[pulMatch[ulGame]]);
+
+            if(ulNext < ulMatches)
+            {
+                BatchGameStart(psBatch, ulGame, pullSeeds[ulNext]);
+                pulMatch[ulGame] = ulNext++;
+                ulInput |= 1 << ulGame;
+            }
+            else
+            {
+                BatchGameStop(psBatch, ulGame);
+                ulBusy &= ~(1 << ulGame);
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// batch.h - Batched game kernel for the host's tuner.
+//
+//*****************************************************************************
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+//*****************************************************************************
+//
+// The number of games that are stepped together, which is two AVX2 vectors of
+// 32-bit values.
+//
+//*****************************************************************************
+#define BATCH_GAMES             16
+
+//*****************************************************************************
+//
+// The state of the games in a batch, with one entry in each array for each
+// game so that a vector holds the same variable of eight games.  The flags are
+// 0 or 1, and the directions are those of pong.h.  A game that has no match
+// to play is marked as over.
+//
+//*****************************************************************************
+typedef struct
+{
+    int piPlayerY[BATCH_GAMES] __attribute__((aligned(32)));
+    int piOpponentY[BATCH_GAMES] __attribute__((aligned(32)));
+    int piOpponentDir[BATCH_GAMES] __attribute__((aligned(32)));
+    int piBallX[BATCH_GAMES] __attribute__((aligned(32)));
+    int piBallY[BATCH_GAMES] __attribute__((aligned(32)));
+    int piBallYStep[BATCH_GAMES] __attribute__((aligned(32)));
+    int piBallXDir[BATCH_GAMES] __attribute__((aligned(32)));
+    int piBallYDir[BATCH_GAMES] __attribute__((aligned(32)));
+    int piActive[BATCH_GAMES] __attribute__((aligned(32)));
+    int piSleep[BATCH_GAMES] __attribute__((aligned(32)));
+    int piSleepCount[BATCH_GAMES] __attribute__((aligned(32)));
+    int piPlayerScore[BATCH_GAMES] __attribute__((aligned(32)));
+    int piOpponentScore[BATCH_GAMES] __attribute__((aligned(32)));
+    int piOver[BATCH_GAMES] __attribute__((aligned(32)));
+    int piTicks[BATCH_GAMES] __attribute__((aligned(32)));
+    int piPhase[BATCH_GAMES] __attribute__((aligned(32)));
+    int piRallyHits[BATCH_GAMES] __attribute__((aligned(32)));
+    int piRallies[BATCH_GAMES] __attribute__((aligned(32)));
+    int piHits[BATCH_GAMES] __attribute__((aligned(32)));
+    int piLongest[BATCH_GAMES] __attribute__((aligned(32)));
+    unsigned long long pullRandom[BATCH_GAMES] __attribute__((aligned(32)));
+
+    //
+    // The settings that all the games share, with the odds as the lottery
+    // uses them.
+    //
+    OpponentProfile sProfile;
+    int iMaxTicks;
+}
+tBatch;
+
+//*****************************************************************************
+//
+// Prototypes for the batched kernel.
+//
+//*****************************************************************************
+extern void BatchPlay(tBatch *psBatch, const OpponentOdds *psOdds,
+                      unsigned long ulReach, unsigned long ulMaxTicks,
+                      const unsigned long long *pullSeeds,
+                      MatchStats *psStats, unsigned long ulMatches);
+
+#endif // __BATCH_H__
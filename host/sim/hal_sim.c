@@ -0,0 +1,453 @@
+//*****************************************************************************
+//
+// hal_sim.c - Headless Linux implementation of the Pong HAL, for playing
+// matches as fast as the host can go.
+//
+// This runs the unchanged game on a Linux machine the way hal_host.c does,
+// but without keeping to the board's time: every call to HalIdle() from the
+// main loop runs the next tick straight away.  Nothing is drawn unless it is
+// asked for, and the player is simulated, so the game is played many
+// thousands of times faster than on the board.  This is for tuning the game
+// play, which would otherwise mean playing matches by hand at 50 ticks a
+// second.
+//
+// Build and run it from the top of the repository with:
+//
+//     gcc -O2 -Wall -Ihost/include -I. -o pong_sim pong.c profile.c trace.c
+//         clock.c boot.c drivers/rit128x96x4.c utils/ustdlib.c
+//         host/driverlib_host.c host/display_host.c host/sim/hal_stub.c
+//         host/sim/player.c host/sim/hal_sim.c
+//
+//     PONG_MATCHES=1000 PONG_SEED=1 ./pong_sim
+//
+// PONG_MATCHES is the number of matches to play (100 by default) and PONG_SEED
+// seeds the random numbers used by the opponent (1 by default).  As soon as a
+// match is won, a new one is started.  Each match prints a line with the
+// score, the ticks it took and its rallies, where a rally is the number of
+// times the ball was hit before a point was won:
+//
+//     match 1: you 4, cpu 10 in 3843 ticks (76.86s), 14 rallies, 2.1 hits
+//         average, 6 longest
+//
+// Once all of the matches have been played, the totals are printed, along
+// with the number of simulated ticks run per second of the host's time.
+//
+// PONG_PLAYER picks the simulated player (see player.c).  "track", the
+// default, moves the bounce board to where the ball will reach it, once the
+// ball is within PONG_REACH columns of it (60, half the court, by default).
+// "sweep" is the scripted player of hal_host.c.
+//
+// If PONG_AIM is set, the game plays against the predicting opponent instead
+// of the lottery (see OpponentPredictMovement() in pong.c).  It is given as
+// error:delay, the most rows the opponent aims away from the ball and the
+// ticks it waits after the ball is hit, such as PONG_AIM=8:20.
+//
+// The game's frames are not drawn, since no one is watching.  If PONG_DRAW is
+// set, every PONG_DRAW'th frame is drawn into the in-memory copy of the
+// display (see display_host.c), and the display's hash is printed at the end;
+// frames in between are skipped the way they are when the display falls
+// behind on the board.
+//
+// No time passes while a tick runs, so the profile, the CPU load and the frame
+// deadlines, which hal_host.c models, mean nothing here and are not printed.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "inc/hw_types.h"
+#include "drivers/rit128x96x4.h"
+#include "host/display_host.h"
+#include "host/driverlib_host.h"
+#include "hal.h"
+#include "pong.h"
+#include "host/sim/hal_stub.h"
+#include "host/sim/player.h"
+
+//*****************************************************************************
+//
+// The SSI clock for the display, as on the board.
+//
+//*****************************************************************************
+#define DISPLAY_SSI_CLOCK       RIT_SSI_CLOCK_MAX
+
+//*****************************************************************************
+//
+// The clock at each clock level, which are the board's.
+//
+//*****************************************************************************
+static const unsigned long g_pulClockRate[HAL_CLOCK_LEVELS] =
+{
+    50000000,
+    8000000,
+    2000000
+};
+
+//*****************************************************************************
+//
+// The simulation settings.
+//
+//*****************************************************************************
+static unsigned long g_ulTicksPerSecond;
+static unsigned long g_ulMatchCount;
+static unsigned long g_ulDrawEvery;
+static unsigned long g_ulPlayer;
+static unsigned long g_ulReach;
+
+//*****************************************************************************
+//
+// The simulation state.  Ticks are counted from the start of the first match.
+//
+//*****************************************************************************
+static unsigned long g_ulTick;
+static tBoolean g_bRenderPending;
+static struct timespec g_sTimeStart;
+
+//*****************************************************************************
+//
+// The simulated processor clock.  The cycle count was g_ullCycleBase at the
+// start of tick g_ulCycleTick, when the clock was last switched, and has
+// counted a whole tick's worth of cycles at g_ulClock every tick since.
+//
+//*****************************************************************************
+static unsigned long g_ulClock;
+static unsigned long long g_ullCycleBase;
+static unsigned long g_ulCycleTick;
+
+//*****************************************************************************
+//
+// The totals over the matches played so far.
+//
+//*****************************************************************************
+static unsigned long g_ulMatches;
+static unsigned long g_ulMatchesWon;
+static unsigned long long g_ullMatchTicks;
+static unsigned long long g_ullPlayerPoints;
+static unsigned long long g_ullOpponentPoints;
+static unsigned long long g_ullRallies;
+static unsigned long long g_ullHits;
+static unsigned long g_ulLongestRally;
+
+//*****************************************************************************
+//
+// Returns the host's time since the first match started, in microseconds.
+//
+//*****************************************************************************
+static unsigned long long
+SimTimeGet(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((unsigned long long)(sNow.tv_sec - g_sTimeStart.tv_sec) *
+            1000000) + ((sNow.tv_nsec - g_sTimeStart.tv_nsec) / 1000));
+}
+
+//*****************************************************************************
+//
+// Prints how the match that has just been won went, and adds it to the
+// totals.
+//
+//*****************************************************************************
+static void
+SimMatchEnd(const MatchStats *psStats)
+{
+    unsigned long ulAverage;
+
+    g_ulMatches++;
+    if(psStats->player_score > psStats->opponent_score)
+    {
+        g_ulMatchesWon++;
+    }
+    g_ullMatchTicks += psStats->ticks;
+    g_ullPlayerPoints += psStats->player_score;
+    g_ullOpponentPoints += psStats->opponent_score;
+    g_ullRallies += psStats->rallies;
+    g_ullHits += psStats->hits;
+    if(psStats->longest_rally > g_ulLongestRally)
+    {
+        g_ulLongestRally = psStats->longest_rally;
+    }
+
+    ulAverage = psStats->rallies ? (psStats->hits * 10 / psStats->rallies) : 0;
+    printf("match %lu: you %u, cpu %u in %lu ticks (%lu.%02lus), %lu rallies, "
+           "%lu.%lu hits average, %lu longest\n", g_ulMatches,
+           psStats->player_score, psStats->opponent_score, psStats->ticks,
+           psStats->ticks / g_ulTicksPerSecond,
+           (psStats->ticks % g_ulTicksPerSecond) * 100 / g_ulTicksPerSecond,
+           psStats->rallies, ulAverage / 10, ulAverage % 10,
+           psStats->longest_rally);
+}
+
+//*****************************************************************************
+//
+// Prints the totals over all of the matches and how fast they were played,
+// and exits.
+//
+//*****************************************************************************
+static void
+SimReport(void)
+{
+    unsigned long long ullTime, ullRate, ullAverage;
+
+    ullTime = SimTimeGet();
+    if(ullTime == 0)
+    {
+        ullTime = 1;
+    }
+
+    printf("matches: %lu played, %lu won by you (%llu.%llu%%)\n", g_ulMatches,
+           g_ulMatchesWon, (g_ulMatchesWon * 1000ULL / g_ulMatches) / 10,
+           (g_ulMatchesWon * 1000ULL / g_ulMatches) % 10);
+
+    ullAverage = g_ullMatchTicks / g_ulMatches;
+    printf("score: you %llu.%llu, cpu %llu.%llu average; %llu ticks "
+           "(%llu.%02llus) a match\n",
+           g_ullPlayerPoints / g_ulMatches,
+           (g_ullPlayerPoints * 10 / g_ulMatches) % 10,
+           g_ullOpponentPoints / g_ulMatches,
+           (g_ullOpponentPoints * 10 / g_ulMatches) % 10, ullAverage,
+           ullAverage / g_ulTicksPerSecond,
+           (ullAverage % g_ulTicksPerSecond) * 100 / g_ulTicksPerSecond);
+
+    ullAverage = g_ullRallies ? (g_ullHits * 10 / g_ullRallies) : 0;
+    printf("rallies: %llu, %llu.%llu hits average, %lu longest\n",
+           g_ullRallies, ullAverage / 10, ullAverage % 10, g_ulLongestRally);
+
+    if(g_ulDrawEvery)
+    {
+        printf("display %08lx\n", HostDisplayHash());
+    }
+
+    ullRate = (unsigned long long)g_ulTick * 1000000 / ullTime;
+    printf("sim: %lu ticks in %llu.%03llus, %llu ticks per second, %llux "
+           "real time\n", g_ulTick, ullTime / 1000000,
+           (ullTime / 1000) % 1000, ullRate, ullRate / g_ulTicksPerSecond);
+
+    exit(0);
+}
+
+//*****************************************************************************
+//
+// Reads the simulation settings.
+//
+//*****************************************************************************
+void
+HalInit(void)
+{
+    const char *pcPlayer, *pcAim;
+    char *pcEnd;
+    OpponentAim sAim;
+
+    g_ulMatchCount = SimEnvGet("PONG_MATCHES", 100);
+    srand(SimEnvGet("PONG_SEED", 1));
+    g_ulDrawEvery = SimEnvGet("PONG_DRAW", 0);
+    g_ulReach = SimEnvGet("PONG_REACH", PLAYER_REACH);
+
+    pcPlayer = getenv("PONG_PLAYER");
+    if(pcPlayer && (strcmp(pcPlayer, "sweep") == 0))
+    {
+        g_ulPlayer = PLAYER_SWEEP;
+    }
+    else if(pcPlayer && (strcmp(pcPlayer, "track") != 0))
+    {
+        fprintf(stderr, "pong_sim: PONG_PLAYER must be track or sweep\n");
+        exit(1);
+    }
+
+    pcAim = getenv("PONG_AIM");
+    if(pcAim)
+    {
+        sAim.error = strtoul(pcAim, &pcEnd, 0);
+        sAim.delay = (*pcEnd == ':') ? strtoul(pcEnd + 1, &pcEnd, 0) : 0;
+        if(*pcEnd != '\0')
+        {
+            fprintf(stderr, "pong_sim: PONG_AIM must be error:delay\n");
+            exit(1);
+        }
+        OpponentAimSet(&sAim);
+    }
+
+    if(g_ulMatchCount == 0)
+    {
+        exit(0);
+    }
+
+    g_ulClock = g_pulClockRate[HAL_CLOCK_FULL];
+    HalCycleCountStart();
+}
+
+//*****************************************************************************
+//
+// Records the tick rate, which the cycle count and the reports use.
+//
+//*****************************************************************************
+void
+HalTimerInit(unsigned long ulTicksPerSecond)
+{
+    g_ulTicksPerSecond = ulTicksPerSecond;
+}
+
+//*****************************************************************************
+//
+// Returns the cycle count at the start of the current tick.  No time passes
+// while a tick runs, so a tick is always exactly one period after the last.
+//
+//*****************************************************************************
+unsigned long
+HalCycleCount(void)
+{
+    if(g_ulTicksPerSecond == 0)
+    {
+        return(0);
+    }
+
+    return((unsigned long)((g_ullCycleBase +
+                            ((unsigned long long)(g_ulTick - g_ulCycleTick) *
+                             (g_ulClock / g_ulTicksPerSecond))) &
+                           0xffffffff));
+}
+
+//*****************************************************************************
+//
+// Returns the clock that cycles are counted at.
+//
+//*****************************************************************************
+unsigned long
+HalClockGet(void)
+{
+    return(g_ulClock);
+}
+
+//*****************************************************************************
+//
+// Returns the clock at a clock level.
+//
+//*****************************************************************************
+unsigned long
+HalClockLevelRate(unsigned long ulLevel)
+{
+    return(g_pulClockRate[ulLevel]);
+}
+
+//*****************************************************************************
+//
+// Switches the simulated clock to a clock level, between two ticks.  The cycle
+// count carries on from where it was at the new rate.  The display driver is
+// set up again for the new clock, as on the board.
+//
+//*****************************************************************************
+void
+HalClockLevelSet(unsigned long ulLevel)
+{
+    g_ullCycleBase += ((unsigned long long)(g_ulTick - g_ulCycleTick) *
+                       (g_ulClock / g_ulTicksPerSecond));
+    g_ulCycleTick = g_ulTick;
+    g_ulClock = g_pulClockRate[ulLevel];
+
+    RIT128x96x4Disable();
+    RIT128x96x4Enable(DISPLAY_SSI_CLOCK);
+    HostSSIFlush();
+}
+
+//*****************************************************************************
+//
+// Initializes the display driver, which sends to the display model.
+//
+//*****************************************************************************
+void
+HalDisplayInit(void)
+{
+    RIT128x96x4Init(DISPLAY_SSI_CLOCK);
+}
+
+//*****************************************************************************
+//
+// Notes that the game has a frame to draw.
+//
+//*****************************************************************************
+void
+HalRenderRequest(void)
+{
+    g_bRenderPending = true;
+}
+
+//*****************************************************************************
+//
+// Returns a random number from the C library.
+//
+//*****************************************************************************
+int
+HalRandom(void)
+{
+    return(rand());
+}
+
+//*****************************************************************************
+//
+// Shifts out anything the display driver sent while starting up, and starts
+// the clock that the throughput is measured with.
+//
+//*****************************************************************************
+void
+HalStart(void)
+{
+    HostSSIFlush();
+
+    clock_gettime(CLOCK_MONOTONIC, &g_sTimeStart);
+}
+
+//*****************************************************************************
+//
+// Runs one tick, with the simulated player's button press before it and a
+// frame after it if one is due.  Once the tick has won the match, a new match
+// is started, or the totals are printed if that was the last one.
+//
+//*****************************************************************************
+void
+HalIdle(void)
+{
+    MatchStats sStats;
+
+    g_ulSimButtons = PlayerButtons(g_ulPlayer, g_ulReach, g_ulTick);
+    if(g_ulSimButtons)
+    {
+        GPIOEIntHandler();
+        g_ulSimButtons = 0;
+    }
+
+    SysTickIntHandler();
+
+    if(g_bRenderPending && g_ulDrawEvery && ((g_ulTick % g_ulDrawEvery) == 0))
+    {
+        g_bRenderPending = false;
+        PendSVIntHandler();
+        HostSSIFlush();
+    }
+
+    g_ulTick++;
+
+    MatchStatsGet(&sStats);
+    if(sStats.over)
+    {
+        SimMatchEnd(&sStats);
+        if(g_ulMatches == g_ulMatchCount)
+        {
+            SimReport();
+        }
+
+        //
+        // The result is never drawn over, so take it off the display before
+        // the next match.
+        //
+        MatchRestart();
+        if(g_ulDrawEvery)
+        {
+            RIT128x96x4Clear();
+            HostSSIFlush();
+        }
+    }
+}
@@ -0,0 +1,162 @@
+//*****************************************************************************
+//
+// hal_stub.c - The parts of the Pong HAL that the simulator and the tuner
+// share.
+//
+// Neither hal_sim.c nor tune.c lets any time pass while a tick runs, and both
+// call the game's handlers one after another from a simulated player, so most
+// of the HAL is the same for both: there are no interrupts to turn off, no
+// buttons or stack to look at, and nothing asks for deep sleep.  Those parts
+// are here, along with reading the settings from the environment.  The clock,
+// the random numbers and the running of the ticks are left to each of them.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "inc/hw_types.h"
+#include "utils/ustdlib.h"
+#include "hal.h"
+#include "host/sim/hal_stub.h"
+
+//*****************************************************************************
+//
+// The buttons that the calling thread's simulated player is pressing.
+//
+//*****************************************************************************
+HAL_THREAD_LOCAL unsigned long g_ulSimButtons;
+
+//*****************************************************************************
+//
+// Returns the value of an environment variable as a number, or ulDefault if it
+// is not set.
+//
+//*****************************************************************************
+unsigned long
+SimEnvGet(const char *pcName, unsigned long ulDefault)
+{
+    const char *pcValue;
+
+    pcValue = getenv(pcName);
+
+    return(pcValue ? strtoul(pcValue, 0, 0) : ulDefault);
+}
+
+//*****************************************************************************
+//
+// Prints to the standard output with the same format conversions as
+// UARTprintf() on the board, which take unsigned long arguments for %u.
+//
+//*****************************************************************************
+void
+HalPrintf(const char *pcFormat, ...)
+{
+    char pcBuffer[256];
+    va_list vaArgP;
+
+    va_start(vaArgP, pcFormat);
+    uvsnprintf(pcBuffer, sizeof(pcBuffer), pcFormat, vaArgP);
+    va_end(vaArgP);
+
+    fputs(pcBuffer, stdout);
+}
+
+//*****************************************************************************
+//
+// The cycle count is worked out from the tick number, so there is nothing to
+// start.
+//
+//*****************************************************************************
+void
+HalCycleCountStart(void)
+{
+}
+
+//*****************************************************************************
+//
+// The handlers are called one after another, so there are no interrupts to
+// turn off.
+//
+//*****************************************************************************
+unsigned long
+HalCriticalEnter(void)
+{
+    return(0);
+}
+
+void
+HalCriticalExit(unsigned long ulState)
+{
+}
+
+//*****************************************************************************
+//
+// The host's stack is not measured, so its size is given as 0.
+//
+//*****************************************************************************
+unsigned long
+HalStackUsed(unsigned long *pulSize)
+{
+    if(pulSize)
+    {
+        *pulSize = 0;
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// There are no buttons to set up.
+//
+//*****************************************************************************
+void
+HalInputInit(void)
+{
+}
+
+//*****************************************************************************
+//
+// Returns the buttons that the calling thread's simulated player is pressing.
+//
+//*****************************************************************************
+unsigned long
+HalInputRead(void)
+{
+    return(g_ulSimButtons);
+}
+
+//*****************************************************************************
+//
+// There are no interrupt priorities; drawing, if any, is run after the tick
+// instead.
+//
+//*****************************************************************************
+void
+HalRenderInit(void)
+{
+}
+
+//*****************************************************************************
+//
+// Returns the cycles since the first tick, all of which were spent asleep,
+// since no time passes while a tick runs.
+//
+//*****************************************************************************
+unsigned long
+HalSleepCycles(void)
+{
+    return(HalCycleCount());
+}
+
+//*****************************************************************************
+//
+// Matches are stopped or started again as soon as they are won, so the game
+// never gets as far as asking for deep sleep.
+//
+//*****************************************************************************
+void
+HalDeepSleep(void)
+{
+}
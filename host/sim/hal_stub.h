@@ -0,0 +1,25 @@
+//*****************************************************************************
+//
+// hal_stub.h - The parts of the Pong HAL shared by the host simulators.
+//
+//*****************************************************************************
+
+#ifndef __HAL_STUB_H__
+#define __HAL_STUB_H__
+
+//*****************************************************************************
+//
+// The buttons that the calling thread's simulated player is pressing, which
+// HalInputRead() returns.
+//
+//*****************************************************************************
+extern HAL_THREAD_LOCAL unsigned long g_ulSimButtons;
+
+//*****************************************************************************
+//
+// Prototypes for the shared functions.
+//
+//*****************************************************************************
+extern unsigned long SimEnvGet(const char *pcName, unsigned long ulDefault);
+
+#endif // __HAL_STUB_H__
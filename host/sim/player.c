@@ -0,0 +1,145 @@
+//*****************************************************************************
+//
+// player.c - Simulated players for the host simulators.
+//
+// The players only see what a person would see: where the ball and their own
+// bounce board are, and how the ball is moving (see PlayerViewGet()).  They
+// press a button at most every PLAYER_PERIOD ticks, which is about as fast as
+// a person can, and each press moves the bounce board four rows.
+//
+// The tracking player works out where the ball will be when it reaches the
+// bounce board, folding its path back at the top and bottom rows for each
+// bounce, and moves the bounce board there.  It only sees the ball once it is
+// within a number of columns of the bounce board, its reach; until then, and
+// once the ball has been hit back, it goes back to the middle.  The further
+// its reach, the more it wins.
+//
+// The sweeping player is the scripted player of hal_host.c.  It changes
+// between up and down every INPUT_SWEEP ticks, whatever the ball does.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "pong.h"
+#include "host/sim/player.h"
+
+//*****************************************************************************
+//
+// The sweeping player changes between up and down every INPUT_SWEEP ticks, and
+// the tracking player leaves the bounce board where it is if it is within
+// INPUT_SLACK rows of where it wants it.
+//
+//*****************************************************************************
+#define INPUT_SWEEP             140
+#define INPUT_SLACK             3
+
+//*****************************************************************************
+//
+// The row that the tracking player goes back to between hits, which is where
+// the bounce boards start, and the rows that the ball bounces between.
+//
+//*****************************************************************************
+#define INPUT_HOME              44
+#define INPUT_TOP               1
+#define INPUT_BOTTOM            87
+
+//*****************************************************************************
+//
+// Returns the row that the tracking player wants the bounce board at: where
+// the ball will be when it reaches the bounce board, or the middle if the ball
+// is not coming or is still out of reach.
+//
+//*****************************************************************************
+static unsigned long
+PlayerTarget(const PlayerView *psView, unsigned long ulReach)
+{
+    long lTicks, lY, lSpan;
+
+    if(!psView->ball_in_play || !psView->ball_incoming ||
+       (psView->ball_x > psView->player_x + ulReach))
+    {
+        return(INPUT_HOME);
+    }
+    if(psView->ball_x <= psView->player_x)
+    {
+        return(psView->ball_y);
+    }
+
+    lTicks = (psView->ball_x - psView->player_x) / psView->ball_x_step;
+    lY = ((long)(psView->ball_y - INPUT_TOP) << 16) +
+         ((long)psView->ball_y_step * lTicks);
+    lSpan = (long)(INPUT_BOTTOM - INPUT_TOP) << 16;
+
+    lY %= 2 * lSpan;
+    if(lY < 0)
+    {
+        lY += 2 * lSpan;
+    }
+    if(lY > lSpan)
+    {
+        lY = (2 * lSpan) - lY;
+    }
+
+    return(INPUT_TOP + (lY >> 16));
+}
+
+//*****************************************************************************
+//
+// Returns the buttons that a simulated player presses on tick ulTick, if any,
+// in a game that it sees through psView.  ulReach is how many columns from the
+// bounce board the tracking player sees the ball from.  This is for the
+// tuner's batched kernel, whose games are not the one in pong.c.
+//
+//*****************************************************************************
+unsigned long
+PlayerViewButtons(unsigned long ulPlayer, unsigned long ulReach,
+                  unsigned long ulTick, const PlayerView *psView)
+{
+    unsigned long ulTarget;
+
+    if((ulTick % PLAYER_PERIOD) != 0)
+    {
+        return(0);
+    }
+
+    if(ulPlayer == PLAYER_SWEEP)
+    {
+        return(((ulTick / INPUT_SWEEP) & 1) ? HAL_BUTTON_DOWN : HAL_BUTTON_UP);
+    }
+
+    ulTarget = PlayerTarget(psView, ulReach);
+
+    if(psView->player_y > ulTarget + INPUT_SLACK)
+    {
+        return(HAL_BUTTON_UP);
+    }
+    if(psView->player_y + INPUT_SLACK < ulTarget)
+    {
+        return(HAL_BUTTON_DOWN);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Returns the buttons that a simulated player presses on tick ulTick of the
+// game in pong.c, if any.
+//
+//*****************************************************************************
+unsigned long
+PlayerButtons(unsigned long ulPlayer, unsigned long ulReach,
+              unsigned long ulTick)
+{
+    PlayerView sView;
+
+    if((ulTick % PLAYER_PERIOD) != 0)
+    {
+        return(0);
+    }
+
+    PlayerViewGet(&sView);
+
+    return(PlayerViewButtons(ulPlayer, ulReach, ulTick, &sView));
+}
@@ -0,0 +1,49 @@
+//*****************************************************************************
+//
+// player.h - Simulated players for the host simulators.
+//
+//*****************************************************************************
+
+#ifndef __PLAYER_H__
+#define __PLAYER_H__
+
+//*****************************************************************************
+//
+// The simulated players.  PLAYER_TRACK works out where the ball will reach it
+// and moves there, and PLAYER_SWEEP sweeps the bounce board up and down
+// whatever the ball does.
+//
+//*****************************************************************************
+#define PLAYER_TRACK            0
+#define PLAYER_SWEEP            1
+
+//*****************************************************************************
+//
+// The number of columns from the bounce board that the tracking player sees
+// the ball from by default, which is half the court.
+//
+//*****************************************************************************
+#define PLAYER_REACH            60
+
+//*****************************************************************************
+//
+// The players press a button at most every PLAYER_PERIOD ticks, which is about
+// as fast as a person can.
+//
+//*****************************************************************************
+#define PLAYER_PERIOD           7
+
+//*****************************************************************************
+//
+// Prototypes for the simulated players.
+//
+//*****************************************************************************
+extern unsigned long PlayerButtons(unsigned long ulPlayer,
+                                   unsigned long ulReach,
+                                   unsigned long ulTick);
+extern unsigned long PlayerViewButtons(unsigned long ulPlayer,
+                                       unsigned long ulReach,
+                                       unsigned long ulTick,
+                                       const PlayerView *psView);
+
+#endif // __PLAYER_H__
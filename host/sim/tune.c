@@ -0,0 +1,955 @@
+//*****************************************************************************
+//
+// tune.c - Monte Carlo tuner for the opponent's lottery odds.
+//
+// The opponent's odds (see OpponentMovement() in pong.c) were picked by
+// playing the game by hand.  This plays the unchanged game against the
+// simulated tracking player (see player.c) for every combination of odds in a
+// grid, many matches each, and prints how often the player won and how long
+// the rallies were for each one, so that difficulty levels can be picked from
+// the results.
+//
+// Build and run it from the top of the repository with:
+//
+//     gcc -O2 -Wall -pthread -DHAL_THREAD_LOCAL=__thread -Ihost/include -I.
+//         -o pong_tune pong.c profile.c trace.c clock.c boot.c
+//         drivers/rit128x96x4.c utils/ustdlib.c host/driverlib_host.c
+//         host/display_host.c host/sim/batch.c host/sim/hal_stub.c
+//         host/sim/player.c host/sim/tune.c
+//
+//     PONG_MATCHES=1000 ./pong_tune
+//
+// The grid is given as first:last:step ranges of each of the odds:
+//
+// * PONG_INVINCIBLE is the votes out of 100 for playing perfectly (50:90:10 by
+//   default; the game uses 70).
+// * PONG_LINEAR is the vote above which the bounce board turns around while
+//   not playing perfectly (87:99:4 by default; the game uses 95).
+// * PONG_BAND is how many rows from the ball the bounce board is kept while
+//   playing perfectly (2:6:2 by default; the game uses 4).
+//
+// PONG_MATCHES is the number of matches played for each combination (200 by
+// default), PONG_REACH is the tracking player's reach (see player.c), and
+// PONG_SEED seeds the random numbers (1 by default).
+//
+// The matches are shared out between PONG_THREADS threads, one for each
+// processor by default.  Every thread has its own copy of the game, which is
+// why the game's state is HAL_THREAD_LOCAL.  The grid is cut up into tasks of
+// TUNE_TASK_MATCHES matches, and each thread starts with an equal run of them.
+// A thread takes its next task from the end of its own run, and once that is
+// empty, steals one from the start of another thread's.  Some combinations
+// play much longer rallies than others, so without the stealing the threads
+// that got them would be left running long after the rest had finished.
+//
+// Each match has its own stream of random numbers, seeded from PONG_SEED and
+// the match's number, so the results are the same whichever thread plays each
+// task and however many threads there are.
+//
+// The matches are played by the batched kernel (see batch.c), which plays
+// many games at once, unless PONG_BATCH is 0, when they are played one at a
+// time by pong.c.  Both play exactly the same matches.  If PONG_SCALING is
+// set, the whole grid is played by both, with 1, 2, 4 and so on threads up to
+// PONG_THREADS, and the time each one took is printed, along with whether the
+// results were the same.
+//
+// The results are printed as one table for each band, of the player's win
+// percentage and the average rally, with a row for each PONG_INVINCIBLE and a
+// column for each PONG_LINEAR.  Last comes the combination closest to the
+// player's win rate for each difficulty level, and the same combinations as
+// the profile lines of pong.h (OPPONENT_EASY_ODDS and so on), to be pasted
+// over the ones there.
+//
+//*****************************************************************************
+
+#ifndef HAL_THREAD_LOCAL
+#error "Build the tuner with -DHAL_THREAD_LOCAL=__thread"
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "pong.h"
+#include "host/sim/batch.h"
+#include "host/sim/hal_stub.h"
+#include "host/sim/player.h"
+
+//*****************************************************************************
+//
+// The number of matches in each task, which is small enough for the threads
+// to finish together and large enough that taking a task costs nothing next to
+// playing it.  The batched kernel starts a new match in each of its games as
+// soon as the last one is over, so two batches' worth keeps its games busy
+// for most of a task.
+//
+//*****************************************************************************
+#define TUNE_TASK_MATCHES       (2 * BATCH_GAMES)
+
+//*****************************************************************************
+//
+// The most ticks a match is played for.  A perfect opponent can't lose a
+// point, and a player with a long reach hardly ever does, so a match between
+// them would never end.  This is more than an hour of play.
+//
+//*****************************************************************************
+#define TUNE_MATCH_TICKS        200000
+
+//*****************************************************************************
+//
+// The most threads that can be used.
+//
+//*****************************************************************************
+#define TUNE_THREADS_MAX        256
+
+//*****************************************************************************
+//
+// The player's win rates, in tenths of a percent, that the difficulty levels
+// are picked for, and the names of their profiles in pong.h.  Normal is about
+// what the odds that were picked by hand win.
+//
+//*****************************************************************************
+static const struct
+{
+    const char *pcName;
+    const char *pcProfile;
+    unsigned long ulWinRate;
+}
+g_psTuneLevels[] =
+{
+    { "easy", "EASY", 750 },
+    { "normal", "NORMAL", 350 },
+    { "hard", "HARD", 150 },
+    { "insane", "INSANE", 20 }
+};
+
+#define TUNE_LEVELS             (sizeof(g_psTuneLevels) /                    \
+                                 sizeof(g_psTuneLevels[0]))
+
+//*****************************************************************************
+//
+// A range of one of the odds.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulFirst;
+    unsigned long ulStep;
+    unsigned long ulCount;
+}
+tTuneRange;
+
+//*****************************************************************************
+//
+// How the matches of a task, or of a combination of odds, went.  Matches that
+// were stopped at TUNE_MATCH_TICKS are only counted as unfinished.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulMatches;
+    unsigned long ulUnfinished;
+    unsigned long ulWon;
+    unsigned long long ullTicks;
+    unsigned long long ullRallies;
+    unsigned long long ullHits;
+    unsigned long ulLongest;
+}
+tTuneResult;
+
+//*****************************************************************************
+//
+// The run of tasks that a thread has left.  The thread takes tasks from the
+// end, and other threads steal them from the start.
+//
+//*****************************************************************************
+typedef struct
+{
+    pthread_mutex_t sLock;
+    unsigned long ulFirst;
+    unsigned long ulLast;
+    unsigned long ulStolen;
+}
+tTuneQueue;
+
+//*****************************************************************************
+//
+// The tuner's settings.  They are set on the main thread before any others
+// are started, and only read after that.
+//
+//*****************************************************************************
+static tTuneRange g_sInvincible, g_sLinear, g_sBand;
+static unsigned long g_ulMatchCount;
+static unsigned long g_ulReach;
+static unsigned long g_ulSeed;
+static unsigned long g_ulThreadCount;
+static tBoolean g_bScaling;
+static tBoolean g_bBatch;
+
+//*****************************************************************************
+//
+// The tasks, the queue of each thread, and the result of each task.
+//
+//*****************************************************************************
+static unsigned long g_ulCells;
+static unsigned long g_ulTasksPerCell;
+static unsigned long g_ulTasks;
+static tTuneQueue g_psQueues[TUNE_THREADS_MAX];
+static tTuneResult *g_psTaskResults;
+
+//*****************************************************************************
+//
+// Each thread's simulation state: the ticks it has run and its random number
+// generator.  The buttons its player is pressing are in g_ulSimButtons.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL unsigned long g_ulTick;
+static HAL_THREAD_LOCAL unsigned long long g_ullRandom;
+
+//*****************************************************************************
+//
+// Reads a first:last:step range from an environment variable, or from
+// pcDefault if it is not set, and checks that it is no more than ulMax.
+//
+//*****************************************************************************
+static void
+TuneRangeGet(tTuneRange *psRange, const char *pcName, const char *pcDefault,
+             unsigned long ulMax)
+{
+    const char *pcValue;
+    char *pcEnd;
+    unsigned long ulFirst, ulLast, ulStep;
+
+    pcValue = getenv(pcName);
+    if(!pcValue)
+    {
+        pcValue = pcDefault;
+    }
+
+    ulFirst = strtoul(pcValue, &pcEnd, 0);
+    ulLast = ulFirst;
+    ulStep = 1;
+    if(*pcEnd == ':')
+    {
+        ulLast = strtoul(pcEnd + 1, &pcEnd, 0);
+        if(*pcEnd == ':')
+        {
+            ulStep = strtoul(pcEnd + 1, &pcEnd, 0);
+        }
+    }
+
+    if((*pcEnd != '\0') || (ulStep == 0) || (ulLast < ulFirst) ||
+       (ulLast > ulMax))
+    {
+        fprintf(stderr, "pong_tune: %s must be first:last:step, from 0 to "
+                "%lu\n", pcName, ulMax);
+        exit(1);
+    }
+
+    psRange->ulFirst = ulFirst;
+    psRange->ulStep = ulStep;
+    psRange->ulCount = ((ulLast - ulFirst) / ulStep) + 1;
+}
+
+//*****************************************************************************
+//
+// Returns the value of a range at an index.
+//
+//*****************************************************************************
+static unsigned long
+TuneRangeValue(const tTuneRange *psRange, unsigned long ulIndex)
+{
+    return(psRange->ulFirst + (ulIndex * psRange->ulStep));
+}
+
+//*****************************************************************************
+//
+// Works out the opponent's odds for a cell of the grid.  Cells are numbered by
+// band, then invincible odds, then linear odds.
+//
+//*****************************************************************************
+static void
+TuneCellOdds(unsigned long ulCell, OpponentOdds *psOdds)
+{
+    psOdds->linear = TuneRangeValue(&g_sLinear, ulCell % g_sLinear.ulCount);
+    ulCell /= g_sLinear.ulCount;
+    psOdds->invincible = TuneRangeValue(&g_sInvincible,
+                                        ulCell % g_sInvincible.ulCount);
+    ulCell /= g_sInvincible.ulCount;
+    psOdds->band = TuneRangeValue(&g_sBand, ulCell);
+}
+
+//*****************************************************************************
+//
+// Adds one result to another.
+//
+//*****************************************************************************
+static void
+TuneResultAdd(tTuneResult *psTotal, const tTuneResult *psResult)
+{
+    psTotal->ulMatches += psResult->ulMatches;
+    psTotal->ulUnfinished += psResult->ulUnfinished;
+    psTotal->ulWon += psResult->ulWon;
+    psTotal->ullTicks += psResult->ullTicks;
+    psTotal->ullRallies += psResult->ullRallies;
+    psTotal->ullHits += psResult->ullHits;
+    if(psResult->ulLongest > psTotal->ulLongest)
+    {
+        psTotal->ulLongest = psResult->ulLongest;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the player's win rate, in tenths of a percent, and the average
+// rally, in tenths of a hit.
+//
+//*****************************************************************************
+static unsigned long
+TuneWinRate(const tTuneResult *psResult)
+{
+    unsigned long ulPlayed;
+
+    ulPlayed = psResult->ulMatches + psResult->ulUnfinished;
+
+    return(ulPlayed ? (psResult->ulWon * 1000 / ulPlayed) : 0);
+}
+
+static unsigned long
+TuneRally(const tTuneResult *psResult)
+{
+    return(psResult->ullRallies ?
+           (unsigned long)(psResult->ullHits * 10 / psResult->ullRallies) : 0);
+}
+
+//*****************************************************************************
+//
+// Returns the seed of a match's random numbers, from PONG_SEED and the match's
+// number in the grid.  SplitMix64 spreads neighbouring numbers far apart.
+//
+//*****************************************************************************
+static unsigned long long
+TuneSeed(unsigned long ulMatch)
+{
+    unsigned long long ullSeed;
+
+    ullSeed = (((unsigned long long)g_ulSeed << 32) + ulMatch +
+               0x9e3779b97f4a7c15ULL);
+    ullSeed = (ullSeed ^ (ullSeed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    ullSeed = (ullSeed ^ (ullSeed >> 27)) * 0x94d049bb133111ebULL;
+    ullSeed ^= ullSeed >> 31;
+
+    return(ullSeed ? ullSeed : 1);
+}
+
+//*****************************************************************************
+//
+// Plays matches one at a time with the calling thread's copy of the game in
+// pong.c.  Match n starts its random numbers from pullSeeds[n], and how it
+// went is put in psStats[n].
+//
+//*****************************************************************************
+static void
+TuneScalarPlay(const OpponentOdds *psOdds, const unsigned long long *pullSeeds,
+               MatchStats *psStats, unsigned long ulMatches)
+{
+    unsigned long ulMatch, ulMatchTick;
+
+    OpponentOddsSet(psOdds);
+
+    for(ulMatch = 0; ulMatch < ulMatches; ulMatch++)
+    {
+        g_ullRandom = pullSeeds[ulMatch];
+        MatchRestart();
+
+        //
+        // The player presses the buttons on ticks counted from the start of
+        // the match, so that it plays the same whichever matches the thread
+        // played before.  The thread's own ticks carry on, since the game
+        // would count a jump back in the cycle count as lost ticks.
+        //
+        ulMatchTick = 0;
+
+        do
+        {
+            g_ulSimButtons = PlayerButtons(PLAYER_TRACK, g_ulReach,
+                                           ulMatchTick);
+            if(g_ulSimButtons)
+            {
+                GPIOEIntHandler();
+                g_ulSimButtons = 0;
+            }
+
+            SysTickIntHandler();
+            g_ulTick++;
+            ulMatchTick++;
+
+            MatchStatsGet(&psStats[ulMatch]);
+        }
+        while(!psStats[ulMatch].over &&
+              (psStats[ulMatch].ticks < TUNE_MATCH_TICKS));
+    }
+}
+
+//*****************************************************************************
+//
+// Plays the matches of a task on the calling thread, with either the batched
+// kernel or its own copy of the game in pong.c.
+//
+//*****************************************************************************
+static void
+TuneTaskRun(unsigned long ulTask, tBoolean bBatch)
+{
+    unsigned long long pullSeeds[TUNE_TASK_MATCHES];
+    MatchStats psStats[TUNE_TASK_MATCHES];
+    tTuneResult *psResult;
+    OpponentOdds sOdds;
+    tBatch sBatch;
+    unsigned long ulCell, ulMatch, ulMatches, ulFirst;
+
+    ulCell = ulTask / g_ulTasksPerCell;
+    TuneCellOdds(ulCell, &sOdds);
+
+    ulFirst = (ulTask % g_ulTasksPerCell) * TUNE_TASK_MATCHES;
+    ulMatches = g_ulMatchCount - ulFirst;
+    if(ulMatches > TUNE_TASK_MATCHES)
+    {
+        ulMatches = TUNE_TASK_MATCHES;
+    }
+
+    //
+    // Each match has its own random numbers, so that it plays the same
+    // whichever kernel plays it, and alongside whichever other matches.
+    //
+    for(ulMatch = 0; ulMatch < ulMatches; ulMatch++)
+    {
+        pullSeeds[ulMatch] = TuneSeed((ulCell * g_ulMatchCount) + ulFirst +
+                                      ulMatch);
+    }
+
+    if(bBatch)
+    {
+        BatchPlay(&sBatch, &sOdds, g_ulReach, TUNE_MATCH_TICKS, pullSeeds,
+                  psStats, ulMatches);
+    }
+    else
+    {
+        TuneScalarPlay(&sOdds, pullSeeds, psStats, ulMatches);
+    }
+
+    psResult = &g_psTaskResults[ulTask];
+    memset(psResult, 0, sizeof(*psResult));
+
+    for(ulMatch = 0; ulMatch < ulMatches; ulMatch++)
+    {
+        if(!psStats[ulMatch].over)
+        {
+            psResult->ulUnfinished++;
+            continue;
+        }
+
+        psResult->ulMatches++;
+        if(psStats[ulMatch].player_score > psStats[ulMatch].opponent_score)
+        {
+            psResult->ulWon++;
+        }
+        psResult->ullTicks += psStats[ulMatch].ticks;
+        psResult->ullRallies += psStats[ulMatch].rallies;
+        psResult->ullHits += psStats[ulMatch].hits;
+        if(psStats[ulMatch].longest_rally > psResult->ulLongest)
+        {
+            psResult->ulLongest = psStats[ulMatch].longest_rally;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Takes the next task for a thread: the last one left in its own queue, or
+// failing that, the first one left in another thread's.  Returns false once
+// there are none left anywhere.
+//
+//*****************************************************************************
+static tBoolean
+TuneTaskTake(unsigned long ulThread, unsigned long ulThreads,
+             unsigned long *pulTask)
+{
+    tTuneQueue *psQueue;
+    unsigned long ulIdx;
+    tBoolean bFound;
+
+    for(ulIdx = 0; ulIdx < ulThreads; ulIdx++)
+    {
+        psQueue = &g_psQueues[(ulThread + ulIdx) % ulThreads];
+
+        pthread_mutex_lock(&psQueue->sLock);
+        bFound = (psQueue->ulFirst < psQueue->ulLast) ? true : false;
+        if(bFound && (ulIdx == 0))
+        {
+            *pulTask = --psQueue->ulLast;
+        }
+        else if(bFound)
+        {
+            *pulTask = psQueue->ulFirst++;
+            psQueue->ulStolen++;
+        }
+        pthread_mutex_unlock(&psQueue->sLock);
+
+        if(bFound)
+        {
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// The body of each thread: sets up its own copy of the game, then plays tasks
+// with the kernel it was given until there are none left.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulThread;
+    unsigned long ulThreads;
+    tBoolean bBatch;
+}
+tTuneThread;
+
+static void *
+TuneThread(void *pvArg)
+{
+    const tTuneThread *psThread;
+    unsigned long ulTask;
+
+    psThread = pvArg;
+
+    GameInit();
+
+    while(TuneTaskTake(psThread->ulThread, psThread->ulThreads, &ulTask))
+    {
+        TuneTaskRun(ulTask, psThread->bBatch);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Plays the whole grid with a number of threads and a kernel.  Returns the
+// time it took in microseconds, and the number of tasks that were stolen.
+//
+//*****************************************************************************
+static unsigned long long
+TuneGridRun(unsigned long ulThreads, tBoolean bBatch, unsigned long *pulStolen)
+{
+    pthread_t psThreads[TUNE_THREADS_MAX];
+    tTuneThread psArgs[TUNE_THREADS_MAX];
+    struct timespec sStart, sEnd;
+    unsigned long ulIdx;
+
+    //
+    // Give each thread an equal run of the tasks.
+    //
+    for(ulIdx = 0; ulIdx < ulThreads; ulIdx++)
+    {
+        pthread_mutex_init(&g_psQueues[ulIdx].sLock, 0);
+        g_psQueues[ulIdx].ulFirst = g_ulTasks * ulIdx / ulThreads;
+        g_psQueues[ulIdx].ulLast = g_ulTasks * (ulIdx + 1) / ulThreads;
+        g_psQueues[ulIdx].ulStolen = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+
+    for(ulIdx = 0; ulIdx < ulThreads; ulIdx++)
+    {
+        psArgs[ulIdx].ulThread = ulIdx;
+        psArgs[ulIdx].ulThreads = ulThreads;
+        psArgs[ulIdx].bBatch = bBatch;
+        if(pthread_create(&psThreads[ulIdx], 0, TuneThread, &psArgs[ulIdx]))
+        {
+            fprintf(stderr, "pong_tune: can't start thread %lu\n", ulIdx);
+            exit(1);
+        }
+    }
+
+    *pulStolen = 0;
+    for(ulIdx = 0; ulIdx < ulThreads; ulIdx++)
+    {
+        pthread_join(psThreads[ulIdx], 0);
+    }
+
+    //
+    // The queues can only go once every thread has stopped looking in them.
+    //
+    for(ulIdx = 0; ulIdx < ulThreads; ulIdx++)
+    {
+        *pulStolen += g_psQueues[ulIdx].ulStolen;
+        pthread_mutex_destroy(&g_psQueues[ulIdx].sLock);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+
+    return(((unsigned long long)(sEnd.tv_sec - sStart.tv_sec) * 1000000) +
+           ((sEnd.tv_nsec - sStart.tv_nsec) / 1000));
+}
+
+//*****************************************************************************
+//
+// Adds up the results of the tasks for each cell of the grid.
+//
+//*****************************************************************************
+static void
+TuneCellResults(tTuneResult *psCells)
+{
+    unsigned long ulTask;
+
+    memset(psCells, 0, g_ulCells * sizeof(*psCells));
+    for(ulTask = 0; ulTask < g_ulTasks; ulTask++)
+    {
+        TuneResultAdd(&psCells[ulTask / g_ulTasksPerCell],
+                      &g_psTaskResults[ulTask]);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints one table of the grid for a band: the win rates if bRally is false,
+// or the average rallies if it is true.
+//
+//*****************************************************************************
+static void
+TuneTablePrint(const tTuneResult *psCells, unsigned long ulBand,
+               tBoolean bRally)
+{
+    unsigned long ulInvincible, ulLinear, ulValue;
+    const tTuneResult *psCell;
+
+    printf("band %lu: %s (rows: invincible odds, columns: linear odds)\n",
+           TuneRangeValue(&g_sBand, ulBand),
+           bRally ? "average rally, hits" : "player wins, %");
+
+    printf("      ");
+    for(ulLinear = 0; ulLinear < g_sLinear.ulCount; ulLinear++)
+    {
+        printf(" %6lu", TuneRangeValue(&g_sLinear, ulLinear));
+    }
+    printf("\n");
+
+    for(ulInvincible = 0; ulInvincible < g_sInvincible.ulCount; ulInvincible++)
+    {
+        printf("  %3lu ", TuneRangeValue(&g_sInvincible, ulInvincible));
+        for(ulLinear = 0; ulLinear < g_sLinear.ulCount; ulLinear++)
+        {
+            psCell = &psCells[(((ulBand * g_sInvincible.ulCount) +
+                                ulInvincible) * g_sLinear.ulCount) + ulLinear];
+            ulValue = bRally ? TuneRally(psCell) : TuneWinRate(psCell);
+            printf(" %4lu.%lu", ulValue / 10, ulValue % 10);
+        }
+        printf("\n");
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the results of the grid: the tables for each band, the totals, and
+// the combination that comes closest to each difficulty level's win rate.
+//
+//*****************************************************************************
+static void
+TuneReport(const tTuneResult *psCells)
+{
+    unsigned long ulBand, ulCell, ulLevel, ulBest, ulRate, ulError;
+    unsigned long ulBestError;
+    unsigned long pulBest[TUNE_LEVELS];
+    tTuneResult sTotal;
+    OpponentOdds sOdds;
+
+    for(ulBand = 0; ulBand < g_sBand.ulCount; ulBand++)
+    {
+        TuneTablePrint(psCells, ulBand, false);
+        TuneTablePrint(psCells, ulBand, true);
+    }
+
+    memset(&sTotal, 0, sizeof(sTotal));
+    for(ulCell = 0; ulCell < g_ulCells; ulCell++)
+    {
+        TuneResultAdd(&sTotal, &psCells[ulCell]);
+    }
+    printf("matches: %lu played, %lu unfinished, %llu ticks, %lu longest "
+           "rally\n", sTotal.ulMatches, sTotal.ulUnfinished, sTotal.ullTicks,
+           sTotal.ulLongest);
+
+    for(ulLevel = 0; ulLevel < TUNE_LEVELS; ulLevel++)
+    {
+        ulBest = 0;
+        ulBestError = 0xffffffff;
+        for(ulCell = 0; ulCell < g_ulCells; ulCell++)
+        {
+            ulRate = TuneWinRate(&psCells[ulCell]);
+            ulError = ((ulRate > g_psTuneLevels[ulLevel].ulWinRate) ?
+                       (ulRate - g_psTuneLevels[ulLevel].ulWinRate) :
+                       (g_psTuneLevels[ulLevel].ulWinRate - ulRate));
+            if(ulError < ulBestError)
+            {
+                ulBest = ulCell;
+                ulBestError = ulError;
+            }
+        }
+        pulBest[ulLevel] = ulBest;
+
+        TuneCellOdds(ulBest, &sOdds);
+        ulRate = TuneWinRate(&psCells[ulBest]);
+        printf("%s (%lu%% wins): invincible %u, linear %u, band %u; "
+               "%lu.%lu%% wins, %lu.%lu hits a rally\n",
+               g_psTuneLevels[ulLevel].pcName,
+               g_psTuneLevels[ulLevel].ulWinRate / 10, sOdds.invincible,
+               sOdds.linear, sOdds.band, ulRate / 10, ulRate % 10,
+               TuneRally(&psCells[ulBest]) / 10,
+               TuneRally(&psCells[ulBest]) % 10);
+    }
+
+    for(ulLevel = 0; ulLevel < TUNE_LEVELS; ulLevel++)
+    {
+        TuneCellOdds(pulBest[ulLevel], &sOdds);
+        printf("#define OPPONENT_%s_ODDS %u, %u, %u\n",
+               g_psTuneLevels[ulLevel].pcProfile, sOdds.invincible,
+               sOdds.linear, sOdds.band);
+    }
+}
+
+//*****************************************************************************
+//
+// The name of each kernel, for the timings.
+//
+//*****************************************************************************
+#ifdef __AVX2__
+#define TUNE_BATCH_NAME         "batched AVX2"
+#else
+#define TUNE_BATCH_NAME         "batched"
+#endif
+
+//*****************************************************************************
+//
+// Plays the grid, with each number of threads and both kernels if the scaling
+// is being measured, prints the results, and exits.
+//
+//*****************************************************************************
+static void
+TuneRun(void)
+{
+    tTuneResult *psCells, *psFirst;
+    unsigned long long ullTime, ullFirstTime, ullMatches;
+    unsigned long ulThreads, ulStolen, ulKernel;
+    tBoolean bBatch;
+
+    psCells = calloc(g_ulCells, sizeof(*psCells));
+    psFirst = calloc(g_ulCells, sizeof(*psFirst));
+    if(!psCells || !psFirst)
+    {
+        fprintf(stderr, "pong_tune: out of memory\n");
+        exit(1);
+    }
+
+    ullMatches = (unsigned long long)g_ulCells * g_ulMatchCount;
+    ullFirstTime = 0;
+    ulThreads = g_bScaling ? 1 : g_ulThreadCount;
+    while(1)
+    {
+        for(ulKernel = 0; ulKernel < 2; ulKernel++)
+        {
+            bBatch = (ulKernel == 1) ? true : false;
+            if(!g_bScaling && (bBatch != g_bBatch))
+            {
+                continue;
+            }
+
+            ullTime = TuneGridRun(ulThreads, bBatch, &ulStolen);
+            if(ullTime == 0)
+            {
+                ullTime = 1;
+            }
+            TuneCellResults(psCells);
+
+            if(ullFirstTime == 0)
+            {
+                ullFirstTime = ullTime;
+                memcpy(psFirst, psCells, g_ulCells * sizeof(*psCells));
+            }
+
+            printf("%s, threads %lu: %llu matches in %llu.%03llus, %llu "
+                   "matches per second, %llu.%02llux the first, %lu tasks "
+                   "stolen%s\n", bBatch ? TUNE_BATCH_NAME : "pong.c",
+                   ulThreads, ullMatches, ullTime / 1000000,
+                   (ullTime / 1000) % 1000, ullMatches * 1000000 / ullTime,
+                   ullFirstTime / ullTime,
+                   (ullFirstTime * 100 / ullTime) % 100, ulStolen,
+                   memcmp(psFirst, psCells, g_ulCells * sizeof(*psCells)) ?
+                   ", DIFFERENT RESULTS" : "");
+        }
+
+        if(ulThreads == g_ulThreadCount)
+        {
+            break;
+        }
+        ulThreads = ((ulThreads * 2) < g_ulThreadCount) ? (ulThreads * 2) :
+                    g_ulThreadCount;
+    }
+
+    TuneReport(psCells);
+
+    free(psCells);
+    free(psFirst);
+
+    exit(0);
+}
+
+//*****************************************************************************
+//
+// Reads the tuner's settings and cuts the grid up into tasks.
+//
+//*****************************************************************************
+void
+HalInit(void)
+{
+    long lProcessors;
+
+    TuneRangeGet(&g_sInvincible, "PONG_INVINCIBLE", "50:90:10", 100);
+    TuneRangeGet(&g_sLinear, "PONG_LINEAR", "87:99:4", 100);
+    TuneRangeGet(&g_sBand, "PONG_BAND", "2:6:2", 88);
+    g_ulMatchCount = SimEnvGet("PONG_MATCHES", 200);
+    g_ulReach = SimEnvGet("PONG_REACH", PLAYER_REACH);
+    g_ulSeed = SimEnvGet("PONG_SEED", 1);
+    g_bScaling = getenv("PONG_SCALING") ? true : false;
+    g_bBatch = SimEnvGet("PONG_BATCH", 1) ? true : false;
+
+    lProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    g_ulThreadCount = SimEnvGet("PONG_THREADS",
+                                (lProcessors > 0) ? lProcessors : 1);
+    if((g_ulThreadCount == 0) || (g_ulThreadCount > TUNE_THREADS_MAX))
+    {
+        fprintf(stderr, "pong_tune: PONG_THREADS must be from 1 to %u\n",
+                TUNE_THREADS_MAX);
+        exit(1);
+    }
+    if(g_ulMatchCount == 0)
+    {
+        exit(0);
+    }
+
+    g_ulCells = g_sBand.ulCount * g_sInvincible.ulCount * g_sLinear.ulCount;
+    g_ulTasksPerCell = ((g_ulMatchCount + TUNE_TASK_MATCHES - 1) /
+                        TUNE_TASK_MATCHES);
+    g_ulTasks = g_ulCells * g_ulTasksPerCell;
+    g_psTaskResults = calloc(g_ulTasks, sizeof(*g_psTaskResults));
+    if(!g_psTaskResults)
+    {
+        fprintf(stderr, "pong_tune: out of memory\n");
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+//
+// Records the tick rate.  It is not needed, since no time passes while a tick
+// runs.
+//
+//*****************************************************************************
+void
+HalTimerInit(unsigned long ulTicksPerSecond)
+{
+}
+
+//*****************************************************************************
+//
+// Returns the cycle count at the start of the thread's current tick.  No time
+// passes while a tick runs, and the clock is never switched, so a tick is
+// always exactly one period after the last.
+//
+//*****************************************************************************
+unsigned long
+HalCycleCount(void)
+{
+    return(g_ulTick * (HalClockGet() / 50));
+}
+
+//*****************************************************************************
+//
+// The clock stays at the PLL's 50MHz.
+//
+//*****************************************************************************
+unsigned long
+HalClockGet(void)
+{
+    return(50000000);
+}
+
+unsigned long
+HalClockLevelRate(unsigned long ulLevel)
+{
+    return(HalClockGet());
+}
+
+void
+HalClockLevelSet(unsigned long ulLevel)
+{
+}
+
+//*****************************************************************************
+//
+// Nothing is drawn, so the display is not set up, and frames are dropped.
+//
+//*****************************************************************************
+void
+HalDisplayInit(void)
+{
+}
+
+void
+HalRenderRequest(void)
+{
+}
+
+//*****************************************************************************
+//
+// Returns a random number from the current task's stream, from the xorshift64
+// generator.  The top 31 bits are used, which are the most random.
+//
+//*****************************************************************************
+int
+HalRandom(void)
+{
+    g_ullRandom ^= g_ullRandom << 13;
+    g_ullRandom ^= g_ullRandom >> 7;
+    g_ullRandom ^= g_ullRandom << 17;
+
+    return((int)(g_ullRandom >> 33));
+}
+
+//*****************************************************************************
+//
+// There is nothing to start on the main thread; the threads are started by
+// HalIdle().
+//
+//*****************************************************************************
+void
+HalStart(void)
+{
+}
+
+//*****************************************************************************
+//
+// Plays the whole grid on the other threads, prints the results and exits.
+// The main thread's copy of the game is never played.
+//
+//*****************************************************************************
+void
+HalIdle(void)
+{
+    TuneRun();
+}
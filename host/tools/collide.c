@@ -0,0 +1,330 @@
+//*****************************************************************************
+//
+// collide.c - Checks the ball's collisions with the bounce boards at every
+// speed, angle and crossing point.
+//
+// CollisionDetector() in pong.c checks the ball's whole path for the tick, so
+// that a ball that moves more than one column a tick can't pass through a
+// bounce board.  This sets the ball up a few ticks in front of each bounce
+// board, for every speed from 1 to X_WALL_SPACER columns a tick, every column
+// it can start a tick on, every y step and direction, and a run of sub-pixel
+// rows, and puts the bounce board every row from BOARD_TOLERANCE + 2 above to
+// as far below where the ball crosses its column.  It then plays the ball with
+// CollisionDetector() and BallMovement() until it is hit back or a point is
+// won, and checks that:
+//
+// * the ball is hit back on the tick that it crosses the bounce board's column
+//   if, and only if, it is within BOARD_TOLERANCE rows of the board's middle
+//   there, and never on an earlier tick;
+// * once hit back, the ball ends the tick as far in front of the board as it
+//   would otherwise have gone past it;
+// * otherwise the ball carries on to the wall behind the board and the point
+//   goes to the other side, with the ball never leaving the court on the way.
+//
+// The game is included rather than linked, so that the ball can be set up
+// directly.  Build and run it from the top of the repository with:
+//
+//     gcc -O2 -Wall -Ihost/include -I. -o collide host/tools/collide.c
+//         profile.c trace.c clock.c boot.c drivers/rit128x96x4.c
+//         utils/ustdlib.c host/driverlib_host.c host/display_host.c
+//         host/sim/hal_stub.c host/sim/player.c host/sim/hal_sim.c
+//     ./collide [-v]
+//
+// It prints the number of cases and failures, and each failure with -v, and
+// exits with 1 if any case failed.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+
+#define main                    PongMain
+#include "pong.c"
+#undef main
+
+//*****************************************************************************
+//
+// How many columns in front of the bounce board the ball starts, at least, in
+// ticks of movement; how many sub-pixel rows it starts on; and how many ticks
+// it is played for at most.
+//
+//*****************************************************************************
+#define COLLIDE_LEAD_TICKS      2
+#define COLLIDE_FRACTIONS       16
+#define COLLIDE_MAX_TICKS       200
+
+//*****************************************************************************
+//
+// The ball's y steps that are checked: straight, and the two bounce angles.
+//
+//*****************************************************************************
+static const int g_piCollideSteps[] =
+{
+    0, BALL_Y_STEP_SHALLOW, BALL_Y_STEP_WIDE
+};
+
+#define COLLIDE_STEPS           (sizeof(g_piCollideSteps) /                   \
+                                 sizeof(g_piCollideSteps[0]))
+
+//*****************************************************************************
+//
+// The cases that were checked, and those that failed.
+//
+//*****************************************************************************
+static unsigned long g_ulCases;
+static unsigned long g_ulFailures;
+static int g_bVerbose;
+
+//*****************************************************************************
+//
+// One case: the side whose bounce board the ball goes towards, its speed, the
+// column and row it starts on, its y step and direction, and where the bounce
+// board is.
+//
+//*****************************************************************************
+typedef struct
+{
+    int bOpponent;
+    int iSpeed;
+    int iStartX;
+    int iStartY;
+    int iStep;
+    int iYDir;
+    int iBoardY;
+}
+tCollideCase;
+
+//*****************************************************************************
+//
+// Counts a failure, and prints it with -v.
+//
+//*****************************************************************************
+static void
+CollideFail(const tCollideCase *psCase, const char *pcWhy, int iTick)
+{
+    g_ulFailures++;
+    if(g_bVerbose)
+    {
+        printf("%s board, speed %d, x %d, y 0x%x, step %d %s, board row %d: "
+               "%s on tick %d\n", psCase->bOpponent ? "opponent" : "player",
+               psCase->iSpeed, psCase->iStartX, psCase->iStartY,
+               psCase->iStep, (psCase->iYDir == BALL_DIRECTION_UP) ? "up" :
+               "down", psCase->iBoardY, pcWhy, iTick);
+    }
+}
+
+//*****************************************************************************
+//
+// Sets up the game for a case, with both bounce boards at the given row.
+//
+//*****************************************************************************
+static void
+CollideSetUp(const tCollideCase *psCase)
+{
+    g_player_score = 0;
+    g_opponent_score = 0;
+    g_rally_hits = 0;
+    g_game_active = 1;
+    g_game_sleep = 0;
+    g_winner_message = 0;
+
+    g_player_y_axis_counter = psCase->iBoardY;
+    g_opponent_y_axis_counter = psCase->iBoardY;
+
+    g_ball_x_step = psCase->iSpeed;
+    g_ball_x_axis_counter = psCase->iStartX;
+    g_ball_y_axis_counter = psCase->iStartY;
+    g_ball_y_step = psCase->iStep;
+    g_ball_x_direction = psCase->bOpponent ? BALL_DIRECTION_RIGHT :
+                         BALL_DIRECTION_LEFT;
+    g_ball_y_direction = psCase->iYDir;
+}
+
+//*****************************************************************************
+//
+// Plays one case and checks it against what should happen.  iCrossTick is the
+// tick on which the ball crosses the bounce board's column, and iCrossY the
+// row it crosses at.
+//
+//*****************************************************************************
+static void
+CollideRun(const tCollideCase *psCase, int iBoardX, int iCrossTick,
+           int iCrossY)
+{
+    int iTick, iStartX, iEndX, bBounce, bBack;
+    unsigned int ulPlayerScore, ulOpponentScore;
+
+    g_ulCases++;
+    CollideSetUp(psCase);
+    bBounce = IsYBounceable(psCase->iBoardY, iCrossY);
+
+    for(iTick = 0; iTick < COLLIDE_MAX_TICKS; iTick++)
+    {
+        iStartX = g_ball_x_axis_counter;
+        ulPlayerScore = g_player_score;
+        ulOpponentScore = g_opponent_score;
+
+        CollisionDetector();
+        BallMovement();
+
+        bBack = (g_ball_x_direction !=
+                 (psCase->bOpponent ? BALL_DIRECTION_RIGHT :
+                  BALL_DIRECTION_LEFT));
+
+        //
+        // A point ends the case.  It must be the point of the side that the
+        // ball was going away from, and only if the ball was not to be hit.
+        //
+        if((g_player_score != ulPlayerScore) ||
+           (g_opponent_score != ulOpponentScore))
+        {
+            if(bBounce)
+            {
+                CollideFail(psCase, "went through the board", iTick);
+            }
+            else if(psCase->bOpponent ?
+                    (g_player_score == ulPlayerScore) :
+                    (g_opponent_score == ulOpponentScore))
+            {
+                CollideFail(psCase, "point went to the wrong side", iTick);
+            }
+            return;
+        }
+
+        //
+        // The ball must stay in the court.
+        //
+        if(g_ball_x_axis_counter > X_MAX)
+        {
+            CollideFail(psCase, "left the court", iTick);
+            return;
+        }
+
+        //
+        // The ball may only be hit back on the tick it crosses the board,
+        // and then must end up reflected across it.
+        //
+        if(bBack)
+        {
+            if(!bBounce || (iTick != iCrossTick))
+            {
+                CollideFail(psCase, "hit back when it should not be", iTick);
+                return;
+            }
+
+            iEndX = psCase->bOpponent ? (iStartX + psCase->iSpeed) :
+                    (iStartX - psCase->iSpeed);
+            if((int)g_ball_x_axis_counter != ((2 * iBoardX) - iEndX))
+            {
+                CollideFail(psCase, "hit back to the wrong column", iTick);
+            }
+            return;
+        }
+
+        if(bBounce && (iTick >= iCrossTick))
+        {
+            CollideFail(psCase, "not hit back", iTick);
+            return;
+        }
+    }
+
+    CollideFail(psCase, "no point was won", iTick);
+}
+
+//*****************************************************************************
+//
+// Works out the tick and row at which the ball of a case crosses the bounce
+// board's column, by moving it a tick at a time as BallMovement() does, and
+// checks it with every bounce board row around that.
+//
+//*****************************************************************************
+static void
+CollideCase(tCollideCase *psCase)
+{
+    int iBoardX, iX, iY, iYDir, iTick, iDistance, iCrossY, iOffset;
+
+    iBoardX = psCase->bOpponent ? ((X_MAX - 1) - X_WALL_SPACER) :
+              (X_MIN + X_WALL_SPACER);
+    iX = psCase->iStartX;
+    iY = psCase->iStartY;
+    iYDir = psCase->iYDir;
+
+    for(iTick = 0; ; iTick++)
+    {
+        iDistance = psCase->bOpponent ? (iBoardX - iX) : (iX - iBoardX);
+        if(iDistance < psCase->iSpeed)
+        {
+            break;
+        }
+
+        iX += psCase->bOpponent ? psCase->iSpeed : -psCase->iSpeed;
+        if(iYDir == BALL_DIRECTION_DOWN)
+        {
+            iY += psCase->iStep;
+        }
+        else
+        {
+            iY -= psCase->iStep;
+        }
+    }
+
+    iDistance = (iDistance * psCase->iStep) / psCase->iSpeed;
+    iCrossY = FIXED_TO_INT((iYDir == BALL_DIRECTION_DOWN) ? (iY + iDistance) :
+                           (iY - iDistance));
+
+    for(iOffset = -(BOARD_TOLERANCE + 2); iOffset <= BOARD_TOLERANCE + 2;
+        iOffset++)
+    {
+        psCase->iBoardY = iCrossY + iOffset;
+        CollideRun(psCase, iBoardX, iTick, iCrossY);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks every case.
+//
+//*****************************************************************************
+int
+main(int argc, char **argv)
+{
+    tCollideCase sCase;
+    int iBoardX, iPhase, iFraction;
+    unsigned long ulStep;
+
+    g_bVerbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+
+    for(sCase.bOpponent = 0; sCase.bOpponent < 2; sCase.bOpponent++)
+    {
+        iBoardX = sCase.bOpponent ? ((X_MAX - 1) - X_WALL_SPACER) :
+                  (X_MIN + X_WALL_SPACER);
+        for(sCase.iSpeed = 1; sCase.iSpeed <= X_WALL_SPACER; sCase.iSpeed++)
+        {
+            for(iPhase = 0; iPhase < sCase.iSpeed; iPhase++)
+            {
+                sCase.iStartX = (sCase.iSpeed * COLLIDE_LEAD_TICKS) + iPhase;
+                sCase.iStartX = sCase.bOpponent ? (iBoardX - sCase.iStartX) :
+                                (iBoardX + sCase.iStartX);
+                for(ulStep = 0; ulStep < COLLIDE_STEPS; ulStep++)
+                {
+                    sCase.iStep = g_piCollideSteps[ulStep];
+                    for(sCase.iYDir = 0; sCase.iYDir < 2; sCase.iYDir++)
+                    {
+                        for(iFraction = 0; iFraction < COLLIDE_FRACTIONS;
+                            iFraction++)
+                        {
+                            sCase.iStartY = (INT_TO_FIXED(BALL_Y_ORIGIN) +
+                                             ((iFraction << FIXED_SHIFT) /
+                                              COLLIDE_FRACTIONS));
+                            CollideCase(&sCase);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("collide: %lu cases, %lu failed\n", g_ulCases, g_ulFailures);
+
+    return(g_ulFailures ? 1 : 0);
+}
@@ -0,0 +1,304 @@
+//*****************************************************************************
+//
+// fontbench.c - Times RIT128x96x4StringDraw() against the per-pixel version
+// that it replaced.
+//
+// StringDraw used to build each character from the column-major font one bit
+// at a time, and wrote each byte into the frame buffer on its own.  It now
+// copies whole rows of a glyph from a font that was expanded for gray levels
+// 11 and 15 when the driver was built, and expands the glyph first for the
+// other levels.  This keeps a copy of the old version, checks that both draw
+// the same bytes into the frame buffer, and prints how long each takes for a
+// character, for each kind of gray level.
+//
+// The driver is included rather than linked, so that the old version can use
+// its font and frame buffer.  Build and run it from the top of the repository
+// with:
+//
+//     gcc -O2 -Wall -Ihost/include -I. -o fontbench host/tools/fontbench.c
+//         host/driverlib_host.c host/display_host.c
+//     ./fontbench [rounds]
+//
+// Each string is drawn rounds times (200000 by default), changing every other
+// time so that the frame buffer is written as well as compared.  The times are
+// the host's, so only the ratios between them say anything about the board.
+// It exits with 1 if the two versions draw anything differently.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "drivers/rit128x96x4.c"
+#include "hal.h"
+
+//*****************************************************************************
+//
+// The default number of times each string is drawn.
+//
+//*****************************************************************************
+#define BENCH_ROUNDS            200000
+
+//*****************************************************************************
+//
+// The strings that are drawn, with the same length so that each one covers
+// the other, and where.  The column is even, as the old version needs.
+//
+//*****************************************************************************
+#define BENCH_STRING_A          "The CPU wins!"
+#define BENCH_STRING_B          "You win! 0123"
+#define BENCH_CHARS             13
+#define BENCH_X                 24
+#define BENCH_Y                 44
+
+//*****************************************************************************
+//
+// The gray levels that are timed: the two with pre-expanded fonts, and one
+// that is expanded as it is drawn.
+//
+//*****************************************************************************
+static const unsigned char g_pucBenchLevels[] = { 11, 15, 7 };
+
+#define BENCH_LEVELS            (sizeof(g_pucBenchLevels) /                   \
+                                 sizeof(g_pucBenchLevels[0]))
+
+//*****************************************************************************
+//
+// The host's driver library asks the HAL for the processor clock.  Nothing is
+// sent to the display, so any clock will do.
+//
+//*****************************************************************************
+unsigned long
+HalClockGet(void)
+{
+    return(50000000);
+}
+
+//*****************************************************************************
+//
+// Writes one byte into the frame buffer, as the old version did, and widens
+// the row's dirty span to cover it if it changed.
+//
+//*****************************************************************************
+static void
+BenchFrameWrite(unsigned long ulRow, unsigned long ulColumn,
+                unsigned char ucValue)
+{
+    if(g_pucFrame[ulRow][ulColumn] == ucValue)
+    {
+        return;
+    }
+    g_pucFrame[ulRow][ulColumn] = ucValue;
+
+    if(g_pucDirtyEnd[ulRow] == 0)
+    {
+        g_pucDirtyStart[ulRow] = ulColumn;
+        g_pucDirtyEnd[ulRow] = ulColumn + 1;
+    }
+    else if(ulColumn < g_pucDirtyStart[ulRow])
+    {
+        g_pucDirtyStart[ulRow] = ulColumn;
+    }
+    else if(ulColumn >= g_pucDirtyEnd[ulRow])
+    {
+        g_pucDirtyEnd[ulRow] = ulColumn + 1;
+    }
+}
+
+//*****************************************************************************
+//
+// Draws a string the way RIT128x96x4StringDraw() used to, a bit of the font
+// at a time.  ulX must be even.
+//
+//*****************************************************************************
+static void
+BenchOldStringDraw(const char *pcStr, unsigned long ulX, unsigned long ulY,
+                   unsigned char ucLevel)
+{
+    unsigned long ulIdx1, ulIdx2;
+    unsigned char ucTemp, ucByte;
+
+    if((ulX >= 128) || (ulY >= 96))
+    {
+        return;
+    }
+
+    while(*pcStr != 0)
+    {
+        ucTemp = *pcStr++ & 0x7f;
+        if(ucTemp < ' ')
+        {
+            ucTemp = 0;
+        }
+        else
+        {
+            ucTemp -= ' ';
+        }
+
+        for(ulIdx1 = 0; ulIdx1 < 6; ulIdx1 += 2)
+        {
+            for(ulIdx2 = 0; (ulIdx2 < 8) && ((ulY + ulIdx2) < 96); ulIdx2++)
+            {
+                ucByte = 0;
+                if(g_pucFont[ucTemp][ulIdx1] & (1 << ulIdx2))
+                {
+                    ucByte = (ucLevel << 4) & 0xf0;
+                }
+                if((ulIdx1 < 4) &&
+                   (g_pucFont[ucTemp][ulIdx1 + 1] & (1 << ulIdx2)))
+                {
+                    ucByte |= (ucLevel << 0) & 0x0f;
+                }
+                BenchFrameWrite(ulY + ulIdx2, ulX / 2, ucByte);
+            }
+
+            ulX += 2;
+            if(ulX >= 128)
+            {
+                return;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Clears the frame buffer and its dirty spans.
+//
+//*****************************************************************************
+static void
+BenchFrameClear(void)
+{
+    memset(g_pucFrame, 0, sizeof(g_pucFrame));
+    memset(g_pucDirtyStart, 0, sizeof(g_pucDirtyStart));
+    memset(g_pucDirtyEnd, 0, sizeof(g_pucDirtyEnd));
+}
+
+//*****************************************************************************
+//
+// Draws every character of the font at a gray level with both versions, and
+// returns 1 if the frame buffers or their dirty spans differ.
+//
+//*****************************************************************************
+static int
+BenchCheck(unsigned char ucLevel)
+{
+    static unsigned char pucFrame[96][64];
+    static unsigned char pucStart[96], pucEnd[96];
+    char pcChars[21];
+    unsigned long ulChar, ulIdx;
+
+    BenchFrameClear();
+    for(ulChar = 0; ulChar < 95; ulChar += 20)
+    {
+        for(ulIdx = 0; (ulIdx < 20) && ((ulChar + ulIdx) < 95); ulIdx++)
+        {
+            pcChars[ulIdx] = ' ' + ulChar + ulIdx;
+        }
+        pcChars[ulIdx] = 0;
+        BenchOldStringDraw(pcChars, 4, ulChar / 2, ucLevel);
+    }
+    memcpy(pucFrame, g_pucFrame, sizeof(pucFrame));
+    memcpy(pucStart, g_pucDirtyStart, sizeof(pucStart));
+    memcpy(pucEnd, g_pucDirtyEnd, sizeof(pucEnd));
+
+    BenchFrameClear();
+    for(ulChar = 0; ulChar < 95; ulChar += 20)
+    {
+        for(ulIdx = 0; (ulIdx < 20) && ((ulChar + ulIdx) < 95); ulIdx++)
+        {
+            pcChars[ulIdx] = ' ' + ulChar + ulIdx;
+        }
+        pcChars[ulIdx] = 0;
+        RIT128x96x4StringDraw(pcChars, 4, ulChar / 2, ucLevel);
+    }
+
+    return((memcmp(pucFrame, g_pucFrame, sizeof(pucFrame)) != 0) ||
+           (memcmp(pucStart, g_pucDirtyStart, sizeof(pucStart)) != 0) ||
+           (memcmp(pucEnd, g_pucDirtyEnd, sizeof(pucEnd)) != 0));
+}
+
+//*****************************************************************************
+//
+// Returns the time now in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long long
+BenchNow(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((unsigned long long)sNow.tv_sec * 1000000000) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the nanoseconds that one version takes to draw a character, drawing
+// the two strings in turn ulRounds times.
+//
+//*****************************************************************************
+static double
+BenchTime(void (*pfnDraw)(const char *, unsigned long, unsigned long,
+                          unsigned char),
+          unsigned char ucLevel, unsigned long ulRounds)
+{
+    unsigned long long ullStart;
+    unsigned long ulRound;
+
+    BenchFrameClear();
+    ullStart = BenchNow();
+    for(ulRound = 0; ulRound < ulRounds; ulRound++)
+    {
+        pfnDraw((ulRound & 1) ? BENCH_STRING_B : BENCH_STRING_A, BENCH_X,
+                BENCH_Y, ucLevel);
+    }
+
+    return((double)(BenchNow() - ullStart) / ((double)ulRounds * BENCH_CHARS));
+}
+
+//*****************************************************************************
+//
+// Checks and times both versions at each gray level.
+//
+//*****************************************************************************
+int
+main(int argc, char **argv)
+{
+    unsigned long ulRounds, ulLevel;
+    double dOld, dNew;
+    int iFailed;
+
+    ulRounds = (argc > 1) ? strtoul(argv[1], 0, 0) : BENCH_ROUNDS;
+    if(ulRounds == 0)
+    {
+        fprintf(stderr, "usage: fontbench [rounds]\n");
+        return(1);
+    }
+
+    iFailed = 0;
+    for(ulLevel = 0; ulLevel < BENCH_LEVELS; ulLevel++)
+    {
+        if(BenchCheck(g_pucBenchLevels[ulLevel]))
+        {
+            printf("level %2u: the two versions draw differently\n",
+                   g_pucBenchLevels[ulLevel]);
+            iFailed = 1;
+            continue;
+        }
+
+        dOld = BenchTime(BenchOldStringDraw, g_pucBenchLevels[ulLevel],
+                         ulRounds);
+        dNew = BenchTime(RIT128x96x4StringDraw, g_pucBenchLevels[ulLevel],
+                         ulRounds);
+        printf("level %2u (%s): old %.1fns, new %.1fns a character, "
+               "%.2fx\n", g_pucBenchLevels[ulLevel],
+               ((g_pucBenchLevels[ulLevel] == 11) ||
+                (g_pucBenchLevels[ulLevel] == 15)) ? "pre-expanded" :
+               "expanded as drawn", dOld, dNew, dOld / dNew);
+    }
+
+    return(iFailed);
+}
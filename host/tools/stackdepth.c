@@ -0,0 +1,475 @@
+//*****************************************************************************
+//
+// stackdepth.c - Works out the worst case stack use of each interrupt handler
+// from the call graph that GCC writes with -fcallgraph-info=su.
+//
+// GCC writes a .ci file for each source file, which lists the stack frame of
+// every function it compiled and every call that each one makes.  This reads
+// them all, follows the calls down from each root, and prints the deepest
+// path from it.
+//
+// The roots are given as levels of interrupt priority, lowest first, with one
+// -r option for each.  The first level is usually main(); the roots at each
+// level after it can interrupt the levels before it but not one another.  The
+// worst case for the whole program is the deepest root of every level, plus
+// an exception frame for each level that interrupts another.  For Pong on the
+// board, with the StellarisWare headers in $SW_ROOT:
+//
+//     arm-none-eabi-gcc -mcpu=cortex-m3 -mthumb -O2 -fcallgraph-info=su
+//         -I$SW_ROOT -I. -c pong.c profile.c trace.c hal_lm3s8962.c
+//         drivers/rit128x96x4.c utils/ustdlib.c
+//     gcc -O2 -Wall -o stackdepth host/tools/stackdepth.c
+//     ./stackdepth -r main -r PendSVIntHandler
+//         -r SysTickIntHandler,GPIOEIntHandler,RIT128x96x4IntHandler
+//         -e TraceDump,HalPrintf -e ProfileReport,HalPrintf *.ci
+//
+// -e adds a call that the compiler can't see, such as one through a function
+// pointer.  -f sets the size of an exception frame, which is 36 bytes by
+// default: the eight words that a Cortex-M3 stacks, and a word of padding to
+// keep the stack aligned to eight bytes.
+//
+// Functions with no .ci file, such as those from the driver library or the C
+// library, are counted as using no stack and are listed at the end, as are
+// calls through pointers that were not given with -e and recursion.  The
+// numbers are only as good as the compiler that produced them; the host's
+// compiler gives its own frame sizes, not the board's.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//*****************************************************************************
+//
+// The limits of what is read.
+//
+//*****************************************************************************
+#define MAX_FUNCTIONS           2048
+#define MAX_CALLS               16384
+#define MAX_LEVELS              8
+#define MAX_NAME                256
+#define MAX_LINE                1024
+
+//*****************************************************************************
+//
+// The default size of an exception frame, in bytes.
+//
+//*****************************************************************************
+#define EXCEPTION_FRAME         36
+
+//*****************************************************************************
+//
+// A function.  lFrame is the size of its own frame, or -1 if it was never
+// compiled.  lDepth is the most stack it and the functions it calls can use,
+// once it has been worked out, and iDeepest is the call on that path.
+//
+//*****************************************************************************
+typedef struct
+{
+    char pcName[MAX_NAME];
+    long lFrame;
+    int bDynamic;
+    int bIndirect;
+    int iState;
+    long lDepth;
+    int iDeepest;
+}
+tFunction;
+
+#define STATE_NEW               0
+#define STATE_VISITING          1
+#define STATE_DONE              2
+
+//*****************************************************************************
+//
+// A call from one function to another.
+//
+//*****************************************************************************
+typedef struct
+{
+    int iFrom;
+    int iTo;
+}
+tCall;
+
+//*****************************************************************************
+//
+// The call graph.
+//
+//*****************************************************************************
+static tFunction g_psFunctions[MAX_FUNCTIONS];
+static int g_iFunctions;
+static tCall g_psCalls[MAX_CALLS];
+static int g_iCalls;
+static int g_bRecursion;
+
+//*****************************************************************************
+//
+// Returns the number of a function, adding it if it has not been seen.
+//
+//*****************************************************************************
+static int
+FunctionFind(const char *pcName)
+{
+    int iIdx;
+
+    for(iIdx = 0; iIdx < g_iFunctions; iIdx++)
+    {
+        if(strcmp(g_psFunctions[iIdx].pcName, pcName) == 0)
+        {
+            return(iIdx);
+        }
+    }
+
+    if(g_iFunctions == MAX_FUNCTIONS)
+    {
+        fprintf(stderr, "stackdepth: too many functions\n");
+        exit(1);
+    }
+
+    snprintf(g_psFunctions[iIdx].pcName, MAX_NAME, "%s", pcName);
+    g_psFunctions[iIdx].lFrame = -1;
+    g_iFunctions++;
+
+    return(iIdx);
+}
+
+//*****************************************************************************
+//
+// Adds a call.
+//
+//*****************************************************************************
+static void
+CallAdd(const char *pcFrom, const char *pcTo)
+{
+    if(g_iCalls == MAX_CALLS)
+    {
+        fprintf(stderr, "stackdepth: too many calls\n");
+        exit(1);
+    }
+
+    g_psCalls[g_iCalls].iFrom = FunctionFind(pcFrom);
+    if(strcmp(pcTo, "__indirect_call") == 0)
+    {
+        g_psFunctions[g_psCalls[g_iCalls].iFrom].bIndirect = 1;
+        return;
+    }
+    g_psCalls[g_iCalls].iTo = FunctionFind(pcTo);
+    g_iCalls++;
+}
+
+//*****************************************************************************
+//
+// Copies the quoted string that follows pcKey in pcLine into pcValue.
+// Returns a pointer to the rest of the line, or 0 if the key isn't there.
+//
+//*****************************************************************************
+static const char *
+FieldGet(const char *pcLine, const char *pcKey, char *pcValue)
+{
+    const char *pcStart, *pcEnd;
+    size_t iLength;
+
+    pcStart = strstr(pcLine, pcKey);
+    if(!pcStart)
+    {
+        return(0);
+    }
+    pcStart += strlen(pcKey);
+    pcEnd = strchr(pcStart, '"');
+    if(!pcEnd)
+    {
+        return(0);
+    }
+
+    iLength = pcEnd - pcStart;
+    if(iLength >= MAX_NAME)
+    {
+        iLength = MAX_NAME - 1;
+    }
+    memcpy(pcValue, pcStart, iLength);
+    pcValue[iLength] = 0;
+
+    return(pcEnd + 1);
+}
+
+//*****************************************************************************
+//
+// Reads the nodes and edges of one .ci file.  A node's label ends with its
+// frame size, such as "16 bytes (static)", unless the function was only
+// declared.
+//
+//*****************************************************************************
+static void
+FileRead(const char *pcFilename)
+{
+    char pcLine[MAX_LINE], pcName[MAX_NAME], pcLabel[MAX_NAME];
+    char pcTarget[MAX_NAME];
+    const char *pcBytes;
+    tFunction *psFunction;
+    FILE *pFile;
+
+    pFile = fopen(pcFilename, "r");
+    if(!pFile)
+    {
+        fprintf(stderr, "stackdepth: can't read %s\n", pcFilename);
+        exit(1);
+    }
+
+    while(fgets(pcLine, sizeof(pcLine), pFile))
+    {
+        if(strncmp(pcLine, "node:", 5) == 0)
+        {
+            if(!FieldGet(pcLine, "title: \"", pcName) ||
+               !FieldGet(pcLine, "label: \"", pcLabel))
+            {
+                continue;
+            }
+
+            pcBytes = strrchr(pcLabel, '\\');
+            if(!pcBytes || !strstr(pcBytes, " bytes"))
+            {
+                continue;
+            }
+
+            psFunction = &g_psFunctions[FunctionFind(pcName)];
+            psFunction->lFrame = strtol(pcBytes + 2, 0, 10);
+            psFunction->bDynamic = (strstr(pcBytes, "dynamic") &&
+                                    !strstr(pcBytes, "bounded"));
+        }
+        else if(strncmp(pcLine, "edge:", 5) == 0)
+        {
+            if(FieldGet(pcLine, "sourcename: \"", pcName) &&
+               FieldGet(pcLine, "targetname: \"", pcTarget))
+            {
+                CallAdd(pcName, pcTarget);
+            }
+        }
+    }
+
+    fclose(pFile);
+}
+
+//*****************************************************************************
+//
+// Works out the most stack that a function and the functions it calls can
+// use.  A call back into a function that is already on the path is recursion,
+// which has no bound; it is counted once and reported.
+//
+//*****************************************************************************
+static long
+DepthGet(int iFunction)
+{
+    tFunction *psFunction;
+    long lDepth;
+    int iCall;
+
+    psFunction = &g_psFunctions[iFunction];
+    if(psFunction->iState == STATE_DONE)
+    {
+        return(psFunction->lDepth);
+    }
+    if(psFunction->iState == STATE_VISITING)
+    {
+        g_bRecursion = 1;
+        return(0);
+    }
+
+    psFunction->iState = STATE_VISITING;
+    psFunction->lDepth = 0;
+    psFunction->iDeepest = -1;
+
+    for(iCall = 0; iCall < g_iCalls; iCall++)
+    {
+        if(g_psCalls[iCall].iFrom != iFunction)
+        {
+            continue;
+        }
+
+        lDepth = DepthGet(g_psCalls[iCall].iTo);
+        if((psFunction->iDeepest < 0) || (lDepth > psFunction->lDepth))
+        {
+            psFunction->lDepth = lDepth;
+            psFunction->iDeepest = g_psCalls[iCall].iTo;
+        }
+    }
+
+    if(psFunction->lFrame > 0)
+    {
+        psFunction->lDepth += psFunction->lFrame;
+    }
+    psFunction->iState = STATE_DONE;
+
+    return(psFunction->lDepth);
+}
+
+//*****************************************************************************
+//
+// Prints the deepest path from a function.
+//
+//*****************************************************************************
+static void
+PathPrint(int iFunction)
+{
+    const char *pcSeparator = "";
+    int iDepth;
+
+    for(iDepth = 0; (iFunction >= 0) && (iDepth < MAX_FUNCTIONS); iDepth++)
+    {
+        printf("%s%s %ld", pcSeparator, g_psFunctions[iFunction].pcName,
+               (g_psFunctions[iFunction].lFrame > 0) ?
+               g_psFunctions[iFunction].lFrame : 0);
+        pcSeparator = " > ";
+        iFunction = g_psFunctions[iFunction].iDeepest;
+    }
+    printf("\n");
+}
+
+//*****************************************************************************
+//
+// Prints, on one line, the functions reached from the roots that have
+// something that was not counted, if there are any.
+//
+//*****************************************************************************
+#define LIST_INDIRECT           0
+#define LIST_MISSING            1
+#define LIST_DYNAMIC            2
+
+static void
+ListPrint(const char *pcHeading, int iList)
+{
+    const tFunction *psFunction;
+    const char *pcSeparator;
+    int iIdx, bListed;
+
+    pcSeparator = " ";
+    for(iIdx = 0; iIdx < g_iFunctions; iIdx++)
+    {
+        psFunction = &g_psFunctions[iIdx];
+        if(psFunction->iState != STATE_DONE)
+        {
+            continue;
+        }
+
+        bListed = ((iList == LIST_INDIRECT) ? psFunction->bIndirect :
+                   (iList == LIST_MISSING) ? (psFunction->lFrame < 0) :
+                   psFunction->bDynamic);
+        if(bListed)
+        {
+            printf("%s%s%s", (pcSeparator[0] == ' ') ? pcHeading : "",
+                   pcSeparator, psFunction->pcName);
+            pcSeparator = ", ";
+        }
+    }
+
+    if(pcSeparator[0] != ' ')
+    {
+        printf("\n");
+    }
+}
+
+//*****************************************************************************
+//
+// Reads the call graph and prints the depth of each root.
+//
+//*****************************************************************************
+int
+main(int argc, char **argv)
+{
+    char *ppcLevels[MAX_LEVELS], *pcRoot, *pcNext, *pcComma;
+    long lFrame, lTotal, lLevel, lDepth;
+    int iLevels, iArg, iIdx, iFiles, iFunction;
+
+    lFrame = EXCEPTION_FRAME;
+    iLevels = 0;
+    iFiles = 0;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if((strcmp(argv[iArg], "-r") == 0) && (iArg + 1 < argc) &&
+           (iLevels < MAX_LEVELS))
+        {
+            ppcLevels[iLevels++] = argv[++iArg];
+        }
+        else if((strcmp(argv[iArg], "-f") == 0) && (iArg + 1 < argc))
+        {
+            lFrame = strtol(argv[++iArg], 0, 0);
+        }
+        else if((strcmp(argv[iArg], "-e") == 0) && (iArg + 1 < argc) &&
+                (pcComma = strchr(argv[iArg + 1], ',')))
+        {
+            *pcComma = 0;
+            CallAdd(argv[iArg + 1], pcComma + 1);
+            iArg++;
+        }
+        else if(argv[iArg][0] == '-')
+        {
+            iLevels = 0;
+            break;
+        }
+        else
+        {
+            FileRead(argv[iArg]);
+            iFiles++;
+        }
+    }
+
+    if((iLevels == 0) || (iFiles == 0))
+    {
+        fprintf(stderr, "usage: %s [-f frame] [-e caller,callee]... "
+                "-r root[,root]... [-r ...] file.ci...\n", argv[0]);
+        return(1);
+    }
+
+    //
+    // Print each root, and add up the deepest of each level.
+    //
+    lTotal = 0;
+    for(iIdx = 0; iIdx < iLevels; iIdx++)
+    {
+        lLevel = 0;
+        for(pcRoot = ppcLevels[iIdx]; pcRoot; pcRoot = pcNext)
+        {
+            pcNext = strchr(pcRoot, ',');
+            if(pcNext)
+            {
+                *pcNext++ = 0;
+            }
+
+            iFunction = FunctionFind(pcRoot);
+            if(g_psFunctions[iFunction].lFrame < 0)
+            {
+                printf("%-24s not found\n", pcRoot);
+                continue;
+            }
+
+            lDepth = DepthGet(iFunction);
+            printf("%-24s %5ld bytes: ", pcRoot, lDepth);
+            PathPrint(iFunction);
+            if(lDepth > lLevel)
+            {
+                lLevel = lDepth;
+            }
+        }
+        lTotal += lLevel + ((iIdx != 0) ? lFrame : 0);
+    }
+
+    printf("worst case with every level interrupted: %ld bytes, "
+           "including %d exception frames of %ld bytes\n", lTotal,
+           iLevels - 1, lFrame);
+
+    //
+    // List what was not counted on the paths from the roots.
+    //
+    ListPrint("not counted, calls through pointers from:", LIST_INDIRECT);
+    ListPrint("not counted, not compiled:", LIST_MISSING);
+    ListPrint("not counted, unbounded dynamic stack in:", LIST_DYNAMIC);
+
+    if(g_bRecursion)
+    {
+        printf("recursion was counted only once\n");
+    }
+
+    return(0);
+}
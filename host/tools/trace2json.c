@@ -0,0 +1,358 @@
+//*****************************************************************************
+//
+// trace2json.c - Converts an event trace dump to a Chrome trace.
+//
+// This reads the output of TraceDump() (trace.c), as captured from UART0 on
+// the board or printed by pong_host, from the standard input, and writes it
+// to the standard output in the Chrome trace event format.  The result can be
+// opened in Perfetto (https://ui.perfetto.dev) or chrome://tracing.  Anything
+// before the "trace begin" line and after the "trace end" line is ignored.
+//
+// The processor has one core and the handlers preempt one another, so every
+// event goes on the same track: the handlers as slices, the phases nested in
+// them, the SSI bytes of each frame, the stack high water mark, the CPU load
+// and the processor clock as counters, and the button presses as instants.
+//
+// Build and run it with:
+//
+//     gcc -O2 -Wall -o trace2json host/tools/trace2json.c
+//     ./trace2json [clock] < uart.log > pong.json
+//
+// where clock is the processor clock in Hz (50000000 by default), which the
+// cycle counts are converted to microseconds with.  The clock switch events in
+// the trace change it from then on.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//*****************************************************************************
+//
+// The event types and layout, which must match trace.h.
+//
+//*****************************************************************************
+#define TRACE_ISR_ENTER         1
+#define TRACE_ISR_EXIT          2
+#define TRACE_PHASE             3
+#define TRACE_SSI               4
+#define TRACE_INPUT             5
+#define TRACE_STACK             6
+#define TRACE_LOAD              7
+#define TRACE_CLOCK             8
+
+#define TRACE_TYPE(ulInfo)      (((ulInfo) >> 28) & 0x0f)
+#define TRACE_ID(ulInfo)        (((ulInfo) >> 24) & 0x0f)
+#define TRACE_ARG(ulInfo)       ((ulInfo) & 0x00ffffff)
+
+//*****************************************************************************
+//
+// The most names of each kind, and the longest line, that are read.
+//
+//*****************************************************************************
+#define MAX_NAMES               16
+#define MAX_LINE                256
+
+//*****************************************************************************
+//
+// One event, with its time unwrapped to 64 bits.  ulOrder is its position in
+// the dump, which breaks ties between events at the same time.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long long ullTime;
+    unsigned long ulInfo;
+    unsigned long ulOrder;
+}
+tEvent;
+
+//*****************************************************************************
+//
+// The names read from the dump.
+//
+//*****************************************************************************
+static char g_ppcIsrNames[MAX_NAMES][MAX_LINE];
+static char g_ppcPhaseNames[MAX_NAMES][MAX_LINE];
+
+//*****************************************************************************
+//
+// Sorts events by time.  A phase is recorded when it ends, so it comes after
+// the phases inside it in the dump; of two phases that start together, the
+// longer one goes first so that the shorter one nests inside it.  Otherwise
+// events at the same time stay in the order that they were recorded.
+//
+//*****************************************************************************
+static int
+EventCompare(const void *pvA, const void *pvB)
+{
+    const tEvent *psA = pvA, *psB = pvB;
+
+    if(psA->ullTime != psB->ullTime)
+    {
+        return((psA->ullTime < psB->ullTime) ? -1 : 1);
+    }
+
+    if((TRACE_TYPE(psA->ulInfo) == TRACE_PHASE) &&
+       (TRACE_TYPE(psB->ulInfo) == TRACE_PHASE) &&
+       (TRACE_ARG(psA->ulInfo) != TRACE_ARG(psB->ulInfo)))
+    {
+        return((TRACE_ARG(psA->ulInfo) > TRACE_ARG(psB->ulInfo)) ? -1 : 1);
+    }
+
+    return((psA->ulOrder < psB->ulOrder) ? -1 : 1);
+}
+
+//*****************************************************************************
+//
+// Prints a name as a JSON string.
+//
+//*****************************************************************************
+static void
+NamePrint(const char *pcName)
+{
+    putchar('"');
+    for(; *pcName; pcName++)
+    {
+        if((*pcName == '"') || (*pcName == '\\'))
+        {
+            putchar('\\');
+        }
+        putchar(*pcName);
+    }
+    putchar('"');
+}
+
+//*****************************************************************************
+//
+// Prints the name of an interrupt handler or phase, or its number if the dump
+// did not name it.
+//
+//*****************************************************************************
+static void
+EventNamePrint(char ppcNames[][MAX_LINE], const char *pcKind,
+               unsigned long ulId)
+{
+    char pcName[32];
+
+    if(ppcNames[ulId][0])
+    {
+        NamePrint(ppcNames[ulId]);
+    }
+    else
+    {
+        snprintf(pcName, sizeof(pcName), "%s %lu", pcKind, ulId);
+        NamePrint(pcName);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads the dump and writes the trace.
+//
+//*****************************************************************************
+int
+main(int argc, char **argv)
+{
+    char pcLine[MAX_LINE], pcName[MAX_LINE];
+    unsigned long ulTime, ulInfo, ulId, ulCount, ulMax, ulIdx;
+    unsigned long pulDepth[MAX_NAMES];
+    unsigned long long ullTime, ullBase;
+    double dCyclesPerUs, dBaseUs, dUs;
+    tEvent *psEvents;
+    int iBegun, iEnded;
+
+    dCyclesPerUs = ((argc > 1) ? strtod(argv[1], 0) : 50000000.0) / 1000000.0;
+    if(dCyclesPerUs <= 0)
+    {
+        fprintf(stderr, "usage: %s [clock]\n", argv[0]);
+        return(1);
+    }
+
+    //
+    // Read the events, unwrapping the 32-bit times.  The events are nearly
+    // in order, so each time is taken to be the one nearest the last.
+    //
+    psEvents = 0;
+    ulCount = 0;
+    ulMax = 0;
+    ullTime = 0;
+    iBegun = 0;
+    iEnded = 0;
+    while(!iEnded && fgets(pcLine, sizeof(pcLine), stdin))
+    {
+        pcLine[strcspn(pcLine, "\r\n")] = 0;
+
+        if(!iBegun)
+        {
+            iBegun = (strncmp(pcLine, "trace begin", 11) == 0);
+        }
+        else if(strcmp(pcLine, "trace end") == 0)
+        {
+            iEnded = 1;
+        }
+        else if(sscanf(pcLine, "isr %lu %[^\n]", &ulId, pcName) == 2)
+        {
+            if(ulId < MAX_NAMES)
+            {
+                strcpy(g_ppcIsrNames[ulId], pcName);
+            }
+        }
+        else if(sscanf(pcLine, "phase %lu %[^\n]", &ulId, pcName) == 2)
+        {
+            if(ulId < MAX_NAMES)
+            {
+                strcpy(g_ppcPhaseNames[ulId], pcName);
+            }
+        }
+        else if(sscanf(pcLine, "%lx %lx", &ulTime, &ulInfo) == 2)
+        {
+            if(ulCount == ulMax)
+            {
+                ulMax = ulMax ? (ulMax * 2) : 1024;
+                psEvents = realloc(psEvents, ulMax * sizeof(tEvent));
+                if(!psEvents)
+                {
+                    fprintf(stderr, "trace2json: out of memory\n");
+                    return(1);
+                }
+            }
+
+            if(ulCount == 0)
+            {
+                ullTime = ((unsigned long long)1 << 32) + ulTime;
+            }
+            else
+            {
+                ullTime += (int)(unsigned int)(ulTime - (unsigned int)ullTime);
+            }
+
+            psEvents[ulCount].ullTime = ullTime;
+            psEvents[ulCount].ulInfo = ulInfo;
+            psEvents[ulCount].ulOrder = ulCount;
+            ulCount++;
+        }
+    }
+
+    if(!iBegun)
+    {
+        fprintf(stderr, "trace2json: no trace found\n");
+        return(1);
+    }
+
+    qsort(psEvents, ulCount, sizeof(tEvent), EventCompare);
+
+    //
+    // Write the trace.  An exit that has no entry in the trace, because the
+    // entry was overwritten, is left out.  The time is counted in
+    // microseconds from the first event; dBaseUs is the time at the cycle
+    // count ullBase, where the clock last changed.
+    //
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+           "\"args\":{\"name\":\"LM3S8962\"}},\n");
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+           "\"args\":{\"name\":\"CPU\"}}");
+
+    memset(pulDepth, 0, sizeof(pulDepth));
+    ullBase = ulCount ? psEvents[0].ullTime : 0;
+    dBaseUs = 0;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulInfo = psEvents[ulIdx].ulInfo;
+        ulId = TRACE_ID(ulInfo);
+        dUs = dBaseUs + ((psEvents[ulIdx].ullTime - ullBase) / dCyclesPerUs);
+
+        switch(TRACE_TYPE(ulInfo))
+        {
+            case TRACE_ISR_ENTER:
+            case TRACE_ISR_EXIT:
+            {
+                if(TRACE_TYPE(ulInfo) == TRACE_ISR_ENTER)
+                {
+                    pulDepth[ulId]++;
+                }
+                else if(pulDepth[ulId] == 0)
+                {
+                    continue;
+                }
+                else
+                {
+                    pulDepth[ulId]--;
+                }
+                printf(",\n{\"name\":");
+                EventNamePrint(g_ppcIsrNames, "isr", ulId);
+                printf(",\"cat\":\"isr\",\"ph\":\"%c\"",
+                       (TRACE_TYPE(ulInfo) == TRACE_ISR_ENTER) ? 'B' : 'E');
+                break;
+            }
+
+            case TRACE_PHASE:
+            {
+                printf(",\n{\"name\":");
+                EventNamePrint(g_ppcPhaseNames, "phase", ulId);
+                printf(",\"cat\":\"phase\",\"ph\":\"X\",\"dur\":%.3f",
+                       TRACE_ARG(ulInfo) / dCyclesPerUs);
+                break;
+            }
+
+            case TRACE_SSI:
+            {
+                printf(",\n{\"name\":\"ssi bytes\",\"ph\":\"C\","
+                       "\"args\":{\"bytes\":%lu}", TRACE_ARG(ulInfo));
+                break;
+            }
+
+            case TRACE_STACK:
+            {
+                printf(",\n{\"name\":\"stack bytes\",\"ph\":\"C\","
+                       "\"args\":{\"bytes\":%lu}", TRACE_ARG(ulInfo));
+                break;
+            }
+
+            case TRACE_LOAD:
+            {
+                printf(",\n{\"name\":\"cpu load\",\"ph\":\"C\","
+                       "\"args\":{\"percent\":%.1f}",
+                       TRACE_ARG(ulInfo) / 10.0);
+                break;
+            }
+
+            case TRACE_CLOCK:
+            {
+                if(TRACE_ARG(ulInfo) == 0)
+                {
+                    continue;
+                }
+                ullBase = psEvents[ulIdx].ullTime;
+                dBaseUs = dUs;
+                dCyclesPerUs = TRACE_ARG(ulInfo) / 1000.0;
+                printf(",\n{\"name\":\"clock\",\"ph\":\"C\","
+                       "\"args\":{\"MHz\":%.3f}", dCyclesPerUs);
+                break;
+            }
+
+            case TRACE_INPUT:
+            {
+                printf(",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                       "\"args\":{\"buttons\":%lu}", ulId ? "input dropped" :
+                       "input", TRACE_ARG(ulInfo));
+                break;
+            }
+
+            default:
+            {
+                continue;
+            }
+        }
+
+        printf(",\"ts\":%.3f,\"pid\":1,\"tid\":1}", dUs);
+    }
+
+    printf("\n]}\n");
+
+    free(psEvents);
+
+    return(0);
+}
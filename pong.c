@@ -19,16 +19,14 @@
 //
 //*****************************************************************************
 
-#include "inc/hw_ints.h"
-#include "inc/hw_memmap.h"
-#include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
-#include "driverlib/debug.h"
-#include "driverlib/gpio.h"
-#include "driverlib/interrupt.h"
-#include "driverlib/systick.h"
-#include "driverlib/sysctl.h"
 #include "stdio.h"
+#include "hal.h"
+#include "boot.h"
+#include "clock.h"
+#include "pong.h"
+#include "profile.h"
+#include "trace.h"
 #include "drivers/rit128x96x4.h"
 #include "utils/ustdlib.h"
 
@@ -36,69 +34,354 @@
 // Pong Global Constants
 ////////////////////////
 
-// Grid
-#define X_MIN 0
-#define X_MAX 120
-#define Y_MIN 0
-#define Y_MAX 88
-#define X_WALL_SPACER 5
-
-// Bounce boards
-#define BOARD_TOLERANCE 7
-#define BOARD_SHALLOW_ANGLE_OFFSET 3
-
-// Ball
-#define BALL_DIRECTION_UP 0
-#define BALL_DIRECTION_DOWN 1
-#define BALL_DIRECTION_LEFT 0
-#define BALL_DIRECTION_RIGHT 1
-
-#define BALL_X_ORIGIN 60
-#define BALL_Y_ORIGIN 44.0
+// Difficulty profiles
+// Each entry of the profile table is built from one of the OPPONENT_*_ODDS lists in pong.h, with the thresholds
+// worked out by the compiler.
+#define OPPONENT_PROFILE_ENTRY(odds) OPPONENT_PROFILE_THRESHOLDS(odds)
+#define OPPONENT_PROFILE_THRESHOLDS(invincible, linear, band) \
+	{ OPPONENT_THRESHOLD(invincible), OPPONENT_THRESHOLD((linear) + 1), (band) }
+
+// Predicting opponent
+// What the predicting opponent has to work out again on its next move: its target, because the ball bounced off a
+// wall, or also its aim and reaction, because the ball was hit or served.
+#define OPPONENT_AIM_REFINE 1
+#define OPPONENT_AIM_NEW 2
+
+// Input
+#define INPUT_QUEUE_SIZE 16 // must be a power of two
+
+// Frame deadline
+// The game ticks TICKS_PER_SECOND times a second. A tick that starts more than half a period late means that
+// ticks were lost; the game is stepped once more for each of them (up to MAX_CATCHUP_STEPS), so it never slows down.
+// A frame that takes longer than a tick to draw, or that is replaced before it is drawn, has overrun; the next
+// DEGRADE_FRAMES frames then leave out the score and text redraws, which are the least important part of a frame.
+// They are drawn again from the latest state once the display has caught up.
+#define TICKS_PER_SECOND 50
+#define MAX_CATCHUP_STEPS 4
+#define DEGRADE_FRAMES 25
+
+// Stack
+// The main loop records each new high water mark of the stack in the event trace, and warns over UART0 the first
+// time that more than STACK_WARN_PERCENT of the stack has been used.
+#define STACK_WARN_PERCENT 75
+
+// Power
+// The main loop sleeps between interrupts, and the CPU load is worked out once a second from the time it slept.
+// The load is kept in tenths of a percent. Once a match has been won and the result has been shown for
+// MATCH_OVER_TICKS ticks, the display is turned off and the board goes into deep sleep until a button is pressed.
+#define MATCH_OVER_TICKS 250
+
+// Clock policy
+// The processor only runs from the PLL while a match is being played. The countdown between points runs from
+// the crystal, and the result at the end of a match from the crystal divided down, which is all they need.
+// The game's phase is given to the clock policy every tick, and the main loop switches the clock when it changes.
+#define CLOCK_PHASE_PLAY 0
+#define CLOCK_PHASE_COUNTDOWN 1
+#define CLOCK_PHASE_OVER 2
+#define CLOCK_PHASE_COUNT 3
+
+// SSI bus accounting
+// The display driver counts the bytes sent to the display for each frame, and for each section of a frame.
+// Bytes are only counted when a frame is flushed, so normally the whole frame is counted against one section.
+// Build with PROFILE_BUS defined to flush after each part of the frame instead, so that the parts are counted
+// separately. Flushing the parts separately merges fewer changes into each window, so the totals are a little
+// different from a normal build.
+#define BUS_SECTION_FRAME 0
+#define BUS_SECTION_TEXT 1
+#define BUS_SECTION_PLAYER 2
+#define BUS_SECTION_OPPONENT 3
+#define BUS_SECTION_BALL 4
+#define BUS_SECTION_SCORES 5
+
+#ifdef PROFILE_BUS
+#define BUS_SECTION(section, name) RIT128x96x4Flush(); RIT128x96x4BusSectionSet((section), (name))
+#else
+#define BUS_SECTION(section, name)
+#endif
 
-// AI
-#define OPPONENT_DIRECTION_UP 0
-#define OPPONENT_DIRECTION_DOWN 1
+// Profiling
+// The phases of the systick and PendSV handlers that are timed with the cycle counter.
+// "tick" and "draw" are the whole handlers; the draw phases include any time the systick handler
+// spends interrupting them.
+#define PROFILE_TICK 0
+#define PROFILE_COLLISION 1
+#define PROFILE_BALL_MOVEMENT 2
+#define PROFILE_OPPONENT_MOVEMENT 3
+#define PROFILE_DRAW 4
+#define PROFILE_PLAYER_ANIMATION 5
+#define PROFILE_OPPONENT_ANIMATION 6
+#define PROFILE_BALL_ANIMATION 7
+#define PROFILE_SCORES 8
+#define PROFILE_FLUSH 9
+#define PROFILE_PHASE_COUNT 10
+
+// Event trace
+// The interrupt handlers whose entry and exit are recorded in the event trace. Pressing the left button dumps
+// the trace over UART0.
+#define TRACE_ISR_SYSTICK 0
+#define TRACE_ISR_PENDSV 1
+#define TRACE_ISR_GPIOE 2
+#define TRACE_ISR_COUNT 3
 
 /////////////////
 // Pong Variables
 /////////////////
 
+// All of the game's state is HAL_THREAD_LOCAL, so that the host's tuner can play a match on each of its threads.
+// On the board it makes no difference.
+
 // Systick
-volatile unsigned long g_ulSystemClock;
+HAL_THREAD_LOCAL volatile unsigned long g_game_ticks = 0;
+
+// Input Queue
+// The button handler only records which buttons were pressed and when; the systick handler applies them.
+// The button handler is the only writer of g_input_head and the systick handler is the only writer of
+// g_input_tail, so neither needs to turn off interrupts to use the queue.
+typedef struct {
+	unsigned long tick;
+	unsigned long buttons;
+} InputEvent;
+
+HAL_THREAD_LOCAL InputEvent g_input_queue[INPUT_QUEUE_SIZE];
+HAL_THREAD_LOCAL volatile unsigned long g_input_head = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_input_tail = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_input_dropped = 0;
 
 // Player Coordinates
-volatile unsigned int g_player_x_axis_counter = X_MIN;
-volatile unsigned int g_player_y_axis_counter = Y_MAX / 2;
+HAL_THREAD_LOCAL volatile unsigned int g_player_x_axis_counter = X_MIN;
+HAL_THREAD_LOCAL volatile unsigned int g_player_y_axis_counter = Y_MAX / 2;
 
 // Opponent Coordinates
-volatile unsigned int g_opponent_x_axis_counter = X_MAX-1;
-volatile unsigned int g_opponent_y_axis_counter = Y_MAX / 2;
-volatile unsigned int g_opponent_y_direction = OPPONENT_DIRECTION_UP;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_x_axis_counter = X_MAX-1;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_y_axis_counter = Y_MAX / 2;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_y_direction = OPPONENT_DIRECTION_UP;
+
+// Difficulty profiles
+// The table is const, so it stays in flash. The names are all the same length, so that each one covers the last
+// on the screen. The lottery plays with the profile that g_opponent_profile points at, which is changed with a
+// single store, so the systick handler sees either the old profile or the new one. The host's tuner points it at
+// g_opponent_custom instead (see OpponentOddsSet).
+const OpponentProfile g_opponent_profiles[OPPONENT_PROFILE_COUNT] = {
+	OPPONENT_PROFILE_ENTRY(OPPONENT_EASY_ODDS),
+	OPPONENT_PROFILE_ENTRY(OPPONENT_NORMAL_ODDS),
+	OPPONENT_PROFILE_ENTRY(OPPONENT_HARD_ODDS),
+	OPPONENT_PROFILE_ENTRY(OPPONENT_INSANE_ODDS)
+};
+const char * const g_opponent_profile_names[OPPONENT_PROFILE_COUNT] = {
+	"  easy",
+	"normal",
+	"  hard",
+	"insane"
+};
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_level = OPPONENT_PROFILE;
+HAL_THREAD_LOCAL const OpponentProfile * volatile g_opponent_profile = &g_opponent_profiles[OPPONENT_PROFILE];
+HAL_THREAD_LOCAL OpponentProfile g_opponent_custom;
+
+// Predicting opponent
+// The bounce board is steered towards g_opponent_target_y, which is only worked out again when the ball's path
+// changes (see OpponentPredictMovement). The target is off by g_opponent_aim_offset rows, which is picked each time
+// the ball is hit, and the bounce board stays still for g_opponent_react_ticks more ticks.
+#ifdef OPPONENT_PREDICT
+HAL_THREAD_LOCAL unsigned int g_opponent_predict = 1;
+#else
+HAL_THREAD_LOCAL unsigned int g_opponent_predict = 0;
+#endif
+HAL_THREAD_LOCAL OpponentAim g_opponent_aim = {
+	OPPONENT_AIM_ERROR,
+	OPPONENT_AIM_DELAY
+};
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_aim_update = OPPONENT_AIM_NEW;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_target_y = Y_MAX / 2;
+HAL_THREAD_LOCAL volatile int g_opponent_aim_offset = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_react_ticks = 0;
 
 // Ball Coordinates
-volatile float g_ball_y_axis_counter = BALL_Y_ORIGIN;
-volatile unsigned int g_ball_x_axis_counter = BALL_X_ORIGIN;
+HAL_THREAD_LOCAL volatile int g_ball_y_axis_counter = INT_TO_FIXED(BALL_Y_ORIGIN);
+HAL_THREAD_LOCAL volatile unsigned int g_ball_x_axis_counter = BALL_X_ORIGIN;
 
 // Ball Angle
-volatile unsigned int g_ball_x_step = 0;
-volatile float g_ball_y_step = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_ball_x_step = BALL_X_SPEED;
+HAL_THREAD_LOCAL volatile int g_ball_y_step = 0;
 
 // Ball Movement
-volatile unsigned int g_ball_x_direction = BALL_DIRECTION_LEFT;
-volatile unsigned int g_ball_y_direction = BALL_DIRECTION_UP;
+HAL_THREAD_LOCAL volatile unsigned int g_ball_x_direction = BALL_DIRECTION_LEFT;
+HAL_THREAD_LOCAL volatile unsigned int g_ball_y_direction = BALL_DIRECTION_UP;
 
 // General Game State
-volatile unsigned int g_game_active = 1;
-volatile unsigned int g_game_sleep = 0;
-volatile unsigned int g_game_sleep_counter = 0;
-volatile unsigned int g_player_score = 0;
-volatile unsigned int g_opponent_score = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_game_active = 1;
+HAL_THREAD_LOCAL volatile unsigned int g_game_sleep = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_game_sleep_counter = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_player_score = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_opponent_score = 0;
+HAL_THREAD_LOCAL const char *g_winner_message = 0;
+
+// Match Statistics
+// How the current match is going, for the host simulators. A rally is the number of times the ball was hit by a
+// bounce board before a point was won.
+HAL_THREAD_LOCAL unsigned long g_match_start_tick = 0;
+HAL_THREAD_LOCAL unsigned long g_match_end_tick = 0;
+HAL_THREAD_LOCAL unsigned long g_rally_hits = 0;
+HAL_THREAD_LOCAL unsigned long g_match_rallies = 0;
+HAL_THREAD_LOCAL unsigned long g_match_hits = 0;
+HAL_THREAD_LOCAL unsigned long g_match_longest_rally = 0;
+
+// Profiling
+const char * const g_profile_names[PROFILE_PHASE_COUNT] = {
+	"tick",
+	"collision",
+	"ball",
+	"opponent",
+	"draw",
+	"player anim",
+	"opp anim",
+	"ball anim",
+	"scores",
+	"flush"
+};
+
+// Event trace
+const char * const g_trace_isr_names[TRACE_ISR_COUNT] = {
+	"systick",
+	"pendsv",
+	"gpioe"
+};
+HAL_THREAD_LOCAL volatile unsigned int g_trace_dump_requested = 0;
+
+// Sprites
+// The ball and bounce board images are the "*" and "|" characters of the display font at gray level 11.
+// They keep the full 6x8 character cell so that they cover whatever was drawn underneath them.
+#define SPRITE_WIDTH 6
+#define SPRITE_HEIGHT 8
+
+// The difficulty profile's name, which is six characters of the display font centred at the top of the screen
+#define PROFILE_NAME_X ((X_MAX / 2) - 18)
+#define PROFILE_NAME_WIDTH (6 * 6)
+#define PROFILE_NAME_HEIGHT 8
+
+const unsigned char g_ball_image[] = {
+	0x00, 0x00, 0x00,
+	0x00, 0xb0, 0x00,
+	0xb0, 0xb0, 0xb0,
+	0x0b, 0xbb, 0x00,
+	0xb0, 0xb0, 0xb0,
+	0x00, 0xb0, 0x00,
+	0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00
+};
+
+const unsigned char g_board_image[] = {
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0xb0, 0x00,
+	0x00, 0x00, 0x00
+};
+
+HAL_THREAD_LOCAL tRITSprite g_ball_sprite;
+HAL_THREAD_LOCAL tRITSprite g_player_sprite;
+HAL_THREAD_LOCAL tRITSprite g_opponent_sprite;
+
+// Game State Snapshots
+// The game runs in the systick handler, and the display is drawn in the lower priority PendSV handler so that a
+// slow frame can't hold up the game. At the end of every tick the systick handler copies what needs to be drawn
+// into a snapshot, and the PendSV handler draws from it.
+//
+// There are two snapshots: the one the PendSV handler is drawing from, and the one the systick handler fills in.
+// The systick handler always runs to completion before PendSV can continue, so it can't be caught half way through
+// a snapshot. If the display falls behind, the newest snapshot replaces one that was never drawn and that frame is
+// skipped; the game itself never waits for the display.
+typedef struct {
+	unsigned int player_x;
+	unsigned int player_y;
+	unsigned int opponent_x;
+	unsigned int opponent_y;
+	unsigned int ball_x;
+	unsigned int ball_y;
+	unsigned int ball_visible;
+	unsigned int player_score;
+	unsigned int opponent_score;
+	const char *countdown;
+	const char *winner;
+	const char *profile;
+} GameSnapshot;
+
+HAL_THREAD_LOCAL GameSnapshot g_snapshots[2];
+HAL_THREAD_LOCAL volatile unsigned int g_snapshot_latest = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_snapshot_drawing = 1;
+HAL_THREAD_LOCAL volatile unsigned int g_snapshot_pending = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_frames_skipped = 0;
+
+// The difficulty profile's name as it was last drawn, or 0 if it has to be drawn again
+HAL_THREAD_LOCAL const char *g_profile_shown = 0;
+
+// Frame deadline
+HAL_THREAD_LOCAL unsigned long g_tick_cycles = 0;
+HAL_THREAD_LOCAL unsigned long g_tick_last_start = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_tick_overruns = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_ticks_lost = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_frames_drawn = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_frames_overrun = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_frames_degraded = 0;
+HAL_THREAD_LOCAL unsigned long g_frames_skipped_seen = 0;
+HAL_THREAD_LOCAL unsigned int g_degrade_frames_left = 0;
+
+// Stack
+HAL_THREAD_LOCAL unsigned long g_stack_high_water = 0;
+HAL_THREAD_LOCAL unsigned int g_stack_warned = 0;
+
+// Power
+HAL_THREAD_LOCAL unsigned long g_load_ticks = 0;
+HAL_THREAD_LOCAL unsigned long g_load_sleep_last = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_cpu_load = 0;
+HAL_THREAD_LOCAL volatile unsigned long g_cpu_load_peak = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_match_over_ticks = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_deep_sleep_requested = 0;
+HAL_THREAD_LOCAL volatile unsigned int g_tick_resync = 0;
+HAL_THREAD_LOCAL unsigned long g_deep_sleeps = 0;
+
+// Clock policy
+const unsigned long g_clock_phase_levels[CLOCK_PHASE_COUNT] = {
+	HAL_CLOCK_FULL,
+	HAL_CLOCK_LOW,
+	HAL_CLOCK_MIN
+};
 
 //////////////////////
 // Pong Game Functions
 //////////////////////
 
+// Moves the player bounce board for every button press that happened before the current tick started.
+// A press always takes effect on the first tick that starts after it, which keeps the input delay the same
+// no matter where in the tick the press lands.
+void ProcessInput(void) {
+	while (g_input_tail != g_input_head) {
+		InputEvent *event = &g_input_queue[g_input_tail & (INPUT_QUEUE_SIZE - 1)];
+
+		// Pressed during this tick, so it waits for the next one
+		if ((long)(g_game_ticks - event->tick) <= 0) {
+			break;
+		}
+
+		// UP
+		if (event->buttons == HAL_BUTTON_UP) {
+			if (g_player_y_axis_counter > 0) {
+				g_player_y_axis_counter = g_player_y_axis_counter - PLAYER_Y_STEP;
+			}
+		}
+		// DOWN
+		if (event->buttons == HAL_BUTTON_DOWN) {
+			if (g_player_y_axis_counter < Y_MAX-1) {
+				g_player_y_axis_counter = g_player_y_axis_counter + PLAYER_Y_STEP;
+			}
+		}
+
+		g_input_tail++;
+	}
+}
+
 // Determines which direction the ball should move after colliding with a bounce board
 int BallDirectionForBounceboardCollision(int bounceboard_y, int ball_y) {
 	int newBallDirection = 0;
@@ -126,22 +409,23 @@ int BallDirectionForBounceboardCollision(int bounceboard_y, int ball_y) {
 // Determines the angle that the ball should move at after colliding with a bounce board
 // We have set up 5 regions: bottom, middle-bottom, middle, middle-top, and top.
 // The bottom and top regions will push the ball in the the widest outgoing angles.
-float BallYBounceAngle(int bounceboard_y, int ball_y) {
+// The angle is returned as a fixed point y-axis step.
+int BallYBounceAngle(int bounceboard_y, int ball_y) {
 
-	float ball_bounce_y_angle = 0.0;
+	int ball_bounce_y_angle = 0;
 
 	// bottom
 	if (bounceboard_y + BOARD_TOLERANCE > ball_y
 		&& bounceboard_y < ball_y
 	) {
-		ball_bounce_y_angle = 0.75;
+		ball_bounce_y_angle = BALL_Y_STEP_WIDE;
 
 	}
 	// middle-bottom
 	else if (bounceboard_y + BOARD_TOLERANCE - BOARD_SHALLOW_ANGLE_OFFSET > ball_y
 			&& bounceboard_y < ball_y
 	) {
-		ball_bounce_y_angle = 0.2;
+		ball_bounce_y_angle = BALL_Y_STEP_SHALLOW;
 	}
 	// middle
 	else if (bounceboard_y == ball_y) {
@@ -150,13 +434,13 @@ float BallYBounceAngle(int bounceboard_y, int ball_y) {
 	// middle-top
 	else if (bounceboard_y - BOARD_TOLERANCE + BOARD_SHALLOW_ANGLE_OFFSET < ball_y
 			&& bounceboard_y > ball_y) {
-		ball_bounce_y_angle = 0.2;
+		ball_bounce_y_angle = BALL_Y_STEP_SHALLOW;
 	}
 	// top
 	else if (bounceboard_y - BOARD_TOLERANCE < ball_y
 		&& bounceboard_y > ball_y
 	) {
-		ball_bounce_y_angle = 0.75;
+		ball_bounce_y_angle = BALL_Y_STEP_WIDE;
 	}
 
 	return ball_bounce_y_angle;
@@ -176,22 +460,73 @@ int IsYBounceable(int bounceboard_y, int ball_y) {
 	return isBounceable;
 }
 
+// Determines whether the ball reaches an x-axis position during this tick's movement.
+// The ball's whole path for the tick is checked, so it can't skip over the position when it moves more than
+// one column per tick. With a speed of one column this is the same as the ball being at the position.
+int BallReachesX(int x) {
+	int ball_x = g_ball_x_axis_counter;
+
+	if (g_ball_x_direction == BALL_DIRECTION_LEFT) {
+		return ball_x >= x && ball_x - (int)g_ball_x_step < x;
+	}
+
+	return ball_x <= x && ball_x + (int)g_ball_x_step > x;
+}
+
+// Works out the ball's y-axis position (in whole pixels) at the moment it reaches an x-axis position during this tick.
+// The ball reaches it part of the way through its movement, so only that part of the y-axis step is applied.
+int BallYAtX(int x) {
+	int distance = g_ball_x_axis_counter - x;
+	if (distance < 0) {
+		distance = -distance;
+	}
+
+	int y_travel = (g_ball_y_step * distance) / (int)g_ball_x_step;
+
+	if (g_ball_y_direction == BALL_DIRECTION_DOWN) {
+		return FIXED_TO_INT(g_ball_y_axis_counter + y_travel);
+	}
+
+	return FIXED_TO_INT(g_ball_y_axis_counter - y_travel);
+}
+
+// Records the rally that a point has just ended.
+void RallyEnd(void) {
+	g_match_rallies++;
+	g_match_hits += g_rally_hits;
+	if (g_rally_hits > g_match_longest_rally) {
+		g_match_longest_rally = g_rally_hits;
+	}
+	g_rally_hits = 0;
+}
+
 // Determines whether the ball hits the player, opponent, or the wall
 void CollisionDetector(void) {
 
+	int player_board_x = g_player_x_axis_counter + X_WALL_SPACER;
+	int opponent_board_x = g_opponent_x_axis_counter - X_WALL_SPACER;
+
 	// Hit the player
-	if (g_ball_x_axis_counter == (g_player_x_axis_counter + X_WALL_SPACER)
+	if (BallReachesX(player_board_x)
 		&&
-		IsYBounceable(g_player_y_axis_counter, g_ball_y_axis_counter) == 1
+		IsYBounceable(g_player_y_axis_counter, BallYAtX(player_board_x)) == 1
 		&&
 		g_ball_x_direction == BALL_DIRECTION_LEFT
 	) {
 
+		int ball_y = BallYAtX(player_board_x);
+
+		// Reflect the ball's position across the bounce board. After this tick's movement the ball ends up
+		// as far in front of the board as it would otherwise have gone past it.
+		g_ball_x_axis_counter = 2 * player_board_x - g_ball_x_axis_counter;
+
 		g_ball_x_direction = BALL_DIRECTION_RIGHT;
+		g_rally_hits++;
+		g_opponent_aim_update |= OPPONENT_AIM_NEW;
 
-		g_ball_y_step = BallYBounceAngle(g_player_y_axis_counter, g_ball_y_axis_counter);
+		g_ball_y_step = BallYBounceAngle(g_player_y_axis_counter, ball_y);
 
-		float newBallDirection = BallDirectionForBounceboardCollision(g_player_y_axis_counter, g_ball_y_axis_counter);
+		int newBallDirection = BallDirectionForBounceboardCollision(g_player_y_axis_counter, ball_y);
 
 		if (newBallDirection == BALL_DIRECTION_DOWN) {
 			g_ball_y_direction = BALL_DIRECTION_DOWN;
@@ -201,17 +536,23 @@ void CollisionDetector(void) {
 		}
 	}
 	// Hit the opponent
-	else if (g_ball_x_axis_counter == g_opponent_x_axis_counter - X_WALL_SPACER
+	else if (BallReachesX(opponent_board_x)
 			&&
-			IsYBounceable(g_opponent_y_axis_counter, g_ball_y_axis_counter) == 1
+			IsYBounceable(g_opponent_y_axis_counter, BallYAtX(opponent_board_x)) == 1
 			&&
 			g_ball_x_direction == BALL_DIRECTION_RIGHT
 	) {
 
+		int ball_y = BallYAtX(opponent_board_x);
+
+		g_ball_x_axis_counter = 2 * opponent_board_x - g_ball_x_axis_counter;
+
 		g_ball_x_direction = BALL_DIRECTION_LEFT;
-		g_ball_y_step = BallYBounceAngle(g_opponent_y_axis_counter, g_ball_y_axis_counter);
+		g_rally_hits++;
+		g_opponent_aim_update |= OPPONENT_AIM_NEW;
+		g_ball_y_step = BallYBounceAngle(g_opponent_y_axis_counter, ball_y);
 
-		float newBallDirection = BallDirectionForBounceboardCollision(g_opponent_y_axis_counter, g_ball_y_axis_counter);
+		int newBallDirection = BallDirectionForBounceboardCollision(g_opponent_y_axis_counter, ball_y);
 
 		if (newBallDirection == BALL_DIRECTION_DOWN) {
 			g_ball_y_direction = BALL_DIRECTION_DOWN;
@@ -222,53 +563,55 @@ void CollisionDetector(void) {
 
 	}
 	// Hit the player wall
-	else if (g_ball_x_axis_counter == X_MIN) {
+	else if (BallReachesX(X_MIN)) {
 
 		g_ball_y_step = 0;
+		RallyEnd();
+		g_opponent_aim_update |= OPPONENT_AIM_NEW;
 
-		if (g_opponent_score == 9) {
+		if (g_opponent_score == MATCH_POINTS - 1) {
 			g_opponent_score++;
 
 			g_game_active = 0;
+			g_match_end_tick = g_game_ticks;
 
-		    RIT128x96x4StringDraw("The CPU wins!", X_MAX / 5, Y_MAX / 2, 11);
+		    g_winner_message = "The CPU wins!";
 		}
 		else {
 			g_opponent_score++;
 			g_game_active = 0;
 
-		    RIT128x96x4StringDraw(" ", g_ball_x_axis_counter, g_ball_y_axis_counter, 11);
-
 		    g_game_sleep = 1;
 
-			g_ball_y_axis_counter = BALL_Y_ORIGIN;
+			g_ball_y_axis_counter = INT_TO_FIXED(BALL_Y_ORIGIN);
 			g_ball_x_axis_counter = BALL_X_ORIGIN;
 
 			g_ball_x_direction == BALL_DIRECTION_RIGHT;
 		}
 	}
 	// Hit the opponent wall
-	else if (g_ball_x_axis_counter == X_MAX) {
+	else if (BallReachesX(X_MAX)) {
 
 		g_ball_y_step = 0;
+		RallyEnd();
+		g_opponent_aim_update |= OPPONENT_AIM_NEW;
 
-		if (g_player_score == 9) {
+		if (g_player_score == MATCH_POINTS - 1) {
 			g_player_score++;
 
 			g_game_active = 0;
+			g_match_end_tick = g_game_ticks;
 
-		    RIT128x96x4StringDraw("You win!", X_MAX / 5, Y_MAX / 2, 11);
+		    g_winner_message = "You win!";
 		}
 		else {
 			g_player_score++;
 
 			g_game_active = 0;
 
-		    RIT128x96x4StringDraw(" ", g_ball_x_axis_counter, g_ball_y_axis_counter, 11);
-
 		    g_game_sleep = 1;
 
-			g_ball_y_axis_counter = BALL_Y_ORIGIN;
+			g_ball_y_axis_counter = INT_TO_FIXED(BALL_Y_ORIGIN);
 			g_ball_x_axis_counter = BALL_X_ORIGIN;
 
 			g_ball_x_direction == BALL_DIRECTION_LEFT;
@@ -278,32 +621,159 @@ void CollisionDetector(void) {
 }
 
 // Moves the ball by incrementing its x-axis and y-axis counters. All y-axis movement will take the current angle into consideration.
+// The x-axis movement stops at the walls, which CollisionDetector will pick up on the next tick.
 void BallMovement(void) {
 	if (g_ball_x_direction == BALL_DIRECTION_LEFT) {
-		g_ball_x_axis_counter--;
+		if (g_ball_x_axis_counter >= X_MIN + g_ball_x_step) {
+			g_ball_x_axis_counter -= g_ball_x_step;
+		}
+		else {
+			g_ball_x_axis_counter = X_MIN;
+		}
 	}
 	else {
-		g_ball_x_axis_counter++;
+		if (g_ball_x_axis_counter + g_ball_x_step <= X_MAX) {
+			g_ball_x_axis_counter += g_ball_x_step;
+		}
+		else {
+			g_ball_x_axis_counter = X_MAX;
+		}
 	}
 
 	if (g_ball_y_direction == BALL_DIRECTION_DOWN) {
 
-		if (g_ball_y_axis_counter < Y_MAX-1) {
+		if (g_ball_y_axis_counter < INT_TO_FIXED(Y_MAX-1)) {
 			g_ball_y_axis_counter += g_ball_y_step;
 		}
 		else {
 			g_ball_y_direction = BALL_DIRECTION_UP;
+			g_opponent_aim_update |= OPPONENT_AIM_REFINE;
 		}
 	}
 	else {
 
-		if (g_ball_y_axis_counter > Y_MIN+1) {
+		if (g_ball_y_axis_counter > INT_TO_FIXED(Y_MIN+1)) {
 			g_ball_y_axis_counter -= g_ball_y_step;
 		}
 		else {
 			g_ball_y_direction = BALL_DIRECTION_DOWN;
+			g_opponent_aim_update |= OPPONENT_AIM_REFINE;
+		}
+	}
+}
+
+// Works out the row (in whole pixels) at which CollisionDetector will see the ball reach an x-axis position ahead of it.
+// BallMovement only moves the ball by whole steps, so every row the ball stops on is its current row plus or minus
+// a number of steps. It turns on the first of these at or past Y_MAX-1 on the way down and at or past Y_MIN+1 on the
+// way up, and spends a tick there without moving while it turns. The ball's path is a walk up and down between
+// those two rows, a step per tick with the extra tick at each end, which repeats every 2 * (steps + 1) ticks; this
+// works out where the walk has got to after the ticks before the ball reaches x, without stepping through the bounces.
+// The ball reaches x part of the way through the next tick, so that part of a step is added on, as BallYAtX does.
+int BallInterceptY(int x) {
+	int distance = x - (int)g_ball_x_axis_counter;
+	int y = g_ball_y_axis_counter;
+	int step = g_ball_y_step;
+	int down = (g_ball_y_direction == BALL_DIRECTION_DOWN);
+	int ticks, top, bottom, rows, phase;
+
+	if (distance < 0) {
+		distance = 0;
+	}
+	ticks = distance / (int)g_ball_x_step;
+	distance -= ticks * (int)g_ball_x_step;
+
+	if (step != 0) {
+		// The rows the ball turns on: the first of its rows at or past Y_MIN+1 going up, and at or past Y_MAX-1 going down
+		top = INT_TO_FIXED(Y_MIN+1) - (((INT_TO_FIXED(Y_MIN+1) - y) % step + step) % step);
+		bottom = INT_TO_FIXED(Y_MAX-1) + (((y - INT_TO_FIXED(Y_MAX-1)) % step + step) % step);
+
+		// A hit can change the step while the ball is past where it would turn with the new one, so play the ticks
+		// out until it is back between them, as BallMovement does
+		while (ticks > 0 && (y < top || y > bottom)) {
+			if (down && y < INT_TO_FIXED(Y_MAX-1)) {
+				y += step;
+			}
+			else if (!down && y > INT_TO_FIXED(Y_MIN+1)) {
+				y -= step;
+			}
+			else {
+				down = !down;
+			}
+			ticks--;
+		}
+
+		if (y >= top && y <= bottom) {
+			// Phases 0 to rows are the rows on the way down, and rows + 1 to 2 * rows + 1 the same rows on the way up
+			rows = (bottom - top) / step;
+			phase = (y - top) / step;
+			if (!down) {
+				phase = 2 * rows + 1 - phase;
+			}
+
+			phase = (phase + ticks) % (2 * (rows + 1));
+
+			down = (phase <= rows);
+			y = top + step * (down ? phase : 2 * rows + 1 - phase);
+		}
+	}
+
+	if (down) {
+		y += (step * distance) / (int)g_ball_x_step;
+	}
+	else {
+		y -= (step * distance) / (int)g_ball_x_step;
+	}
+
+	return FIXED_TO_INT(y);
+}
+
+// Works out where the predicting opponent should take its bounce board, after the ball's path has changed.
+// When the ball has been hit or served, it also picks how far off its aim will be and starts waiting to react.
+void OpponentAimUpdate(void) {
+	int target = Y_MAX / 2;
+
+	if (g_opponent_aim_update & OPPONENT_AIM_NEW) {
+		g_opponent_react_ticks = g_opponent_aim.delay;
+
+		g_opponent_aim_offset = 0;
+		if (g_opponent_aim.error != 0) {
+			g_opponent_aim_offset = (int)(HalRandom() % (2 * g_opponent_aim.error + 1)) - (int)g_opponent_aim.error;
 		}
 	}
+	g_opponent_aim_update = 0;
+
+	// Meet the ball if it's coming, or wait in the middle if it's going away
+	if (g_ball_x_direction == BALL_DIRECTION_RIGHT) {
+		target = BallInterceptY(g_opponent_x_axis_counter - X_WALL_SPACER) + g_opponent_aim_offset;
+	}
+
+	if (target < Y_MIN) {
+		target = Y_MIN;
+	}
+	if (target > Y_MAX) {
+		target = Y_MAX;
+	}
+
+	g_opponent_target_y = target;
+}
+
+// Moves the opponent board towards where the ball will reach it, instead of chasing the ball.
+// The target is only worked out again when the ball bounces, is hit or is served, so on every other tick
+// the opponent just waits out its reaction or steps one row towards the target.
+void OpponentPredictMovement(void) {
+	if (g_opponent_aim_update != 0) {
+		OpponentAimUpdate();
+	}
+
+	if (g_opponent_react_ticks != 0) {
+		g_opponent_react_ticks--;
+	}
+	else if (g_opponent_y_axis_counter < g_opponent_target_y) {
+		g_opponent_y_axis_counter++;
+	}
+	else if (g_opponent_y_axis_counter > g_opponent_target_y) {
+		g_opponent_y_axis_counter--;
+	}
 }
 
 // Moves the opponent board by invoking either an "invincible" or "linear" playing strategy.
@@ -313,20 +783,30 @@ void BallMovement(void) {
 //
 // The "linear" strategy has a second lottery vote to determine whether the board will truly move linearly,
 // or incorporate a random variation in its movement.
+// The odds of both votes, and how close the "invincible" strategy keeps the board to the ball, are the difficulty
+// profile's. The odds were turned into thresholds when the game was built, so each vote is just compared with them.
+// The predicting opponent plays instead when it has been picked (see OpponentPredictMovement).
 void OpponentMovement(void) {
 
+	if (g_opponent_predict == 1) {
+		OpponentPredictMovement();
+		return;
+	}
+
+	const OpponentProfile *profile = g_opponent_profile;
+
 	// Take the vote for "invincible" or "linear" mode
-	int invincibleVote = rand() % 100;
+	unsigned int invincibleVote = OPPONENT_VOTE(HalRandom());
 
 	// Voted for invincible mode
-	if (invincibleVote < 70) {
+	if (invincibleVote < profile->invincible) {
 
 		// Adjust the opponent movement to move its bounce board hit range to match the current ball location
-	    if (g_ball_y_axis_counter > g_opponent_y_axis_counter - 4
+	    if (g_ball_y_axis_counter > INT_TO_FIXED(g_opponent_y_axis_counter - profile->band)
 	    ) {
 			g_opponent_y_direction = OPPONENT_DIRECTION_DOWN;
 	    }
-	    else if (g_ball_y_axis_counter < g_opponent_y_axis_counter + 4
+	    else if (g_ball_y_axis_counter < INT_TO_FIXED(g_opponent_y_axis_counter + profile->band)
 	    ) {
 			g_opponent_y_direction = OPPONENT_DIRECTION_UP;
 	    }
@@ -335,10 +815,10 @@ void OpponentMovement(void) {
 	else {
 
 		// Take the vote for pure linear movement, or whether to incorporate a random variation
-		int normalMovementVote = rand() % 100;
+		unsigned int normalMovementVote = OPPONENT_VOTE(HalRandom());
 
 		// Voted for pure linear movement
-		if (normalMovementVote > 95) {
+		if (normalMovementVote >= profile->turn) {
 			if (g_opponent_y_direction == OPPONENT_DIRECTION_UP) {
 				g_opponent_y_direction = OPPONENT_DIRECTION_DOWN;
 			}
@@ -367,65 +847,163 @@ void OpponentMovement(void) {
 	}
 }
 
-// Animate ball movement by drawing the ball's current position.
-// Also cleans up space around the ball to prevent unwanted animation pixel "trails".
-// Cleanup is done by drawing blank spaces around the ball.
-void BallMovementAnimation(void) {
-
-	int i = 1;
-	for (i = 1; i <= 2; i++) {
-		RIT128x96x4StringDraw(" ", g_ball_x_axis_counter - i, g_ball_y_axis_counter - i, 11);
-		RIT128x96x4StringDraw(" ", g_ball_x_axis_counter + i, g_ball_y_axis_counter + i, 11);
+//////////////////////////
+// Pong Rendering Functions
+//////////////////////////
+
+// Animate ball movement by drawing the ball's position.
+// The display driver remembers where the ball sprite was drawn last, and erases only the part of
+// that position that the new one does not cover. This prevents unwanted animation pixel "trails".
+// The ball is taken off the screen while there is no match in play.
+void BallMovementAnimation(const GameSnapshot *snapshot) {
+	if (snapshot->ball_visible == 1) {
+		RIT128x96x4SpriteMove(&g_ball_sprite, snapshot->ball_x, snapshot->ball_y);
+	}
+	else {
+		RIT128x96x4SpriteHide(&g_ball_sprite);
 	}
-
-    RIT128x96x4StringDraw("*", g_ball_x_axis_counter, g_ball_y_axis_counter, 11);
 }
 
-// Animate player movement by drawing the player's current position.
-// Also cleans up space around the player to prevent unwanted animation pixel "trails".
-// Cleanup is done by drawing blank spaces around the player bounce board.
+// Animate player movement by drawing the player's position.
 // The player has a fairly wide movement range to help the controls stay responsive,
-// so there is quite a bit of cleanup that needs to be done.
-void PlayerMovementAnimation(void) {
-
-	int i = 1;
-	for (i = 1; i <= 6; i++) {
-		RIT128x96x4StringDraw(" ", g_player_x_axis_counter, g_player_y_axis_counter - i, 11);
-		RIT128x96x4StringDraw(" ", g_player_x_axis_counter, g_player_y_axis_counter + i, 11);
-
-	}
-
-    RIT128x96x4StringDraw(" ", g_player_x_axis_counter, g_player_y_axis_counter, 11);
-    RIT128x96x4StringDraw("|", g_player_x_axis_counter, g_player_y_axis_counter, 11);
+// so the sprite can move by several rows at once; the old position is still erased cleanly.
+void PlayerMovementAnimation(const GameSnapshot *snapshot) {
+	RIT128x96x4SpriteMove(&g_player_sprite, snapshot->player_x, snapshot->player_y);
 }
 
-// Animate opponent movement by drawing the opponent's current position.
-// Also cleans up space around the opponent to prevent unwanted animation pixel "trails".
-// Cleanup is done by drawing blank spaces around the opponent bounce board.
-void OpponentMovementAnimation(void) {
-
-	int i = 1;
-	for (i = 1; i <= 2; i++) {
-		RIT128x96x4StringDraw(" ", g_opponent_x_axis_counter, g_opponent_y_axis_counter - i, 11);
-		RIT128x96x4StringDraw(" ", g_opponent_x_axis_counter, g_opponent_y_axis_counter + i, 11);
-	}
-
-    RIT128x96x4StringDraw(" ", g_opponent_x_axis_counter, g_opponent_y_axis_counter, 11);
-    RIT128x96x4StringDraw("|", g_opponent_x_axis_counter, g_opponent_y_axis_counter, 11);
+// Animate opponent movement by drawing the opponent's position.
+void OpponentMovementAnimation(const GameSnapshot *snapshot) {
+	RIT128x96x4SpriteMove(&g_opponent_sprite, snapshot->opponent_x, snapshot->opponent_y);
 }
 
 // Displays current score values on the screen.
 // The player score appears in the top left hand corner of the screen.
 // The opponent score appears in the top right hand corner of the screen.
-void DisplayScores(void) {
+// The difficulty profile's name appears between them. It only changes with the difficulty, so it is only drawn
+// again then, or while and just after the ball's sprite is over it, since the sprite covers it and erases it again
+// as it moves on.
+void DisplayScores(const GameSnapshot *snapshot) {
 
 	char playerScoreString[10];
-	usprintf(playerScoreString, "%d", g_player_score);
+	usprintf(playerScoreString, "%d", snapshot->player_score);
 	RIT128x96x4StringDraw(playerScoreString, X_MIN + 10, 0, 15);
 
 	char opponentScoreString[10];
-	usprintf(opponentScoreString, "%d", g_opponent_score);
+	usprintf(opponentScoreString, "%d", snapshot->opponent_score);
 	RIT128x96x4StringDraw(opponentScoreString, X_MAX - 10, 0, 15);
+
+	unsigned int ball_over = snapshot->ball_visible == 1 && snapshot->ball_y < PROFILE_NAME_HEIGHT
+		&& snapshot->ball_x + SPRITE_WIDTH > PROFILE_NAME_X && snapshot->ball_x < PROFILE_NAME_X + PROFILE_NAME_WIDTH;
+
+	if (ball_over == 1 || g_profile_shown != snapshot->profile) {
+		RIT128x96x4StringDraw(snapshot->profile, PROFILE_NAME_X, 0, 11);
+		g_profile_shown = ball_over ? 0 : snapshot->profile;
+	}
+}
+
+// Checks whether a frame missed its deadline, which was the start of the next tick.
+// Either it took longer than a tick to draw, or the systick handler replaced a snapshot that was never drawn.
+// An overrun starts (or restarts) the run of degraded frames.
+void FrameDeadlineCheck(unsigned long draw_cycles) {
+	g_frames_drawn++;
+
+	unsigned long skipped = g_frames_skipped;
+	if (draw_cycles > g_tick_cycles || skipped != g_frames_skipped_seen) {
+		g_frames_overrun++;
+		g_degrade_frames_left = DEGRADE_FRAMES;
+	}
+	g_frames_skipped_seen = skipped;
+}
+
+// Draws a whole frame from a game state snapshot and sends it to the display.
+// Only the parts of the screen that changed since the last frame actually go out to the display.
+// Frames can be skipped, so anything that is drawn has to be taken off again based on the state alone.
+void DrawFrame(const GameSnapshot *snapshot) {
+
+	static unsigned int countdown_shown = 0;
+	unsigned long profile_draw = HalCycleCount();
+	unsigned long profile_start;
+
+	// Shed the low priority drawing while the display catches up after an overrun.
+	// The ball can pass over the profile's name meanwhile, so it is drawn again afterwards.
+	unsigned int degraded = 0;
+	if (g_degrade_frames_left != 0) {
+		g_degrade_frames_left--;
+		g_frames_degraded++;
+		g_profile_shown = 0;
+		degraded = 1;
+	}
+
+	BUS_SECTION(BUS_SECTION_TEXT, "text");
+
+	if (degraded == 0) {
+		if (snapshot->countdown != 0) {
+			RIT128x96x4StringDraw(snapshot->countdown, BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+			countdown_shown = 1;
+		}
+		else if (countdown_shown == 1) {
+			RIT128x96x4StringDraw(" ", BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+			countdown_shown = 0;
+		}
+
+		if (snapshot->winner != 0) {
+			RIT128x96x4StringDraw(snapshot->winner, X_MAX / 5, Y_MAX / 2, 11);
+		}
+	}
+
+	profile_start = HalCycleCount();
+	BUS_SECTION(BUS_SECTION_PLAYER, "player");
+	PlayerMovementAnimation(snapshot);
+	profile_start = ProfileRecord(PROFILE_PLAYER_ANIMATION, profile_start);
+
+	BUS_SECTION(BUS_SECTION_OPPONENT, "opponent");
+	OpponentMovementAnimation(snapshot);
+	profile_start = ProfileRecord(PROFILE_OPPONENT_ANIMATION, profile_start);
+
+	BUS_SECTION(BUS_SECTION_BALL, "ball");
+	BallMovementAnimation(snapshot);
+	profile_start = ProfileRecord(PROFILE_BALL_ANIMATION, profile_start);
+
+	BUS_SECTION(BUS_SECTION_SCORES, "scores");
+	if (degraded == 0) {
+		DisplayScores(snapshot);
+	}
+	profile_start = ProfileRecord(PROFILE_SCORES, profile_start);
+
+	RIT128x96x4Flush();
+	RIT128x96x4BusFrameEnd();
+	ProfileRecord(PROFILE_FLUSH, profile_start);
+
+	tRITBusStats bus;
+	RIT128x96x4BusStatsGet(&bus, 0, 0);
+	TraceEvent(TRACE_SSI, 0, bus.ulBytes);
+
+	unsigned long profile_end = ProfileRecord(PROFILE_DRAW, profile_draw);
+
+	FrameDeadlineCheck((profile_end - profile_draw) & 0xffffffff);
+}
+
+// Hands the current game state over to the PendSV handler to be drawn.
+// The snapshot has already been partly filled in by the systick handler; the rest is copied here.
+// If the last snapshot still hasn't been picked up, that frame is skipped.
+void PublishSnapshot(GameSnapshot *snapshot) {
+	snapshot->player_x = g_player_x_axis_counter;
+	snapshot->player_y = g_player_y_axis_counter;
+	snapshot->opponent_x = g_opponent_x_axis_counter;
+	snapshot->opponent_y = g_opponent_y_axis_counter;
+	snapshot->player_score = g_player_score;
+	snapshot->opponent_score = g_opponent_score;
+	snapshot->winner = g_winner_message;
+	snapshot->profile = g_opponent_profile_names[g_opponent_level];
+
+	if (g_snapshot_pending == 1) {
+		g_frames_skipped++;
+	}
+
+	g_snapshot_latest = snapshot - g_snapshots;
+	g_snapshot_pending = 1;
+
+	HalRenderRequest();
 }
 
 //////////////////////
@@ -434,85 +1012,411 @@ void DisplayScores(void) {
 
 // Collect player button presses.
 // Since the player bounce board can only move vertically along the y-axis, we are only interested
-// in collecting input for the "up" and "down" buttons.
+// in collecting input for the "up" and "down" buttons. The "left" button asks for the event trace to be dumped,
+// and the "right" button steps to the next difficulty profile, from insane back round to easy.
 //
-// Player animation is updated here to account for timing differences. Animation will not be smooth
-// if we have to wait for the next systick event.
+// The presses are stamped with the current tick and queued up for the systick handler, which moves the paddle.
+// If the queue is full the press is dropped.
 void GPIOEIntHandler(void) {
-	GPIOPinIntClear(GPIO_PORTE_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
 	unsigned long ulData;
+	unsigned long dropped = 0;
+
+	TraceIsrEnter(TRACE_ISR_GPIOE);
 
     //
     // Read the state of the push buttons.
     //
-    ulData = (GPIOPinRead(GPIO_PORTE_BASE, (GPIO_PIN_0 | GPIO_PIN_1  | GPIO_PIN_2 | GPIO_PIN_3))) & 0x000f;
-    ulData = ulData ^ 0x0f;
-    // UP
-    if (ulData == 1)
-    {
-    	if (g_player_y_axis_counter > 0) {
-    		g_player_y_axis_counter = g_player_y_axis_counter - 4;
+    ulData = HalInputRead();
 
-    		PlayerMovementAnimation();
+    if (ulData == HAL_BUTTON_LEFT) {
+    	// The dump is too slow for an interrupt handler, so the main loop does it
+    	g_trace_dump_requested = 1;
+    }
+    else if (ulData == HAL_BUTTON_RIGHT) {
+    	unsigned int level = g_opponent_level + 1;
+    	if (level == OPPONENT_PROFILE_COUNT) {
+    		level = 0;
     	}
+    	g_opponent_level = level;
+    	g_opponent_profile = &g_opponent_profiles[level];
     }
-    // DOWN
-    if (ulData == 2)
-    {
-    	if (g_player_y_axis_counter < Y_MAX-1) {
-    		g_player_y_axis_counter = g_player_y_axis_counter + 4;
+    else if (ulData == HAL_BUTTON_UP || ulData == HAL_BUTTON_DOWN) {
+    	if (g_input_head - g_input_tail == INPUT_QUEUE_SIZE) {
+    		g_input_dropped++;
+    		dropped = 1;
+    	}
+    	else {
+    		InputEvent *event = &g_input_queue[g_input_head & (INPUT_QUEUE_SIZE - 1)];
+    		event->tick = g_game_ticks;
+    		event->buttons = ulData;
 
-    		PlayerMovementAnimation();
+    		// Only hand the event over once it has been filled in
+    		g_input_head++;
     	}
     }
+
+    TraceEvent(TRACE_INPUT, dropped, ulData);
+    TraceIsrExit(TRACE_ISR_GPIOE);
 }
 
-// The entire game runs on systick intervals.
+// Runs the game for one tick and fills in the parts of the snapshot that the tick decides.
 // It is important to detect incoming collisions before allowing any other automated (non player) movement.
 // This helps keep the game play realistic (e.g. the ball can't fly through a bounce board, etc).
-void SysTickIntHandler(void) {
+void GameStep(GameSnapshot *snapshot) {
+
+	unsigned long profile_start;
+
+	snapshot->ball_visible = 0;
+	snapshot->countdown = 0;
+
+	// Start the next tick, and apply the button presses from before it
+	g_game_ticks++;
+	ProcessInput();
 
 	// Handle gameplay if the game is active
 	if (g_game_active == 1) {
 
+	   profile_start = HalCycleCount();
 	   CollisionDetector();
+	   profile_start = ProfileRecord(PROFILE_COLLISION, profile_start);
 
 	   BallMovement();
+	   profile_start = ProfileRecord(PROFILE_BALL_MOVEMENT, profile_start);
 
 	   OpponentMovement();
+	   ProfileRecord(PROFILE_OPPONENT_MOVEMENT, profile_start);
 
-	   PlayerMovementAnimation();
-	   OpponentMovementAnimation();
-	   BallMovementAnimation();
-
-	   DisplayScores();
+	   // The ball goes away as soon as a point is won
+	   snapshot->ball_visible = g_game_active;
+	   snapshot->ball_x = g_ball_x_axis_counter;
+	   snapshot->ball_y = FIXED_TO_INT(g_ball_y_axis_counter);
 	}
 	// Count down to the next match if the game is paused due to a point being won.
 	else if (g_game_sleep == 1) {
 		g_game_sleep_counter++;
 
 		if (g_game_sleep_counter < 30) {
-			RIT128x96x4StringDraw("3", BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+			snapshot->countdown = "3";
 		}
 		else if (
 			g_game_sleep_counter > 30
 			&& g_game_sleep_counter < 60
 		) {
-			RIT128x96x4StringDraw("2", BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+			snapshot->countdown = "2";
 		}
 		else {
-			RIT128x96x4StringDraw("1", BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+			snapshot->countdown = "1";
 		}
 
 
-		if (g_game_sleep_counter > 100) {
-			RIT128x96x4StringDraw("*", BALL_X_ORIGIN, BALL_Y_ORIGIN, 11);
+		if (g_game_sleep_counter > COUNTDOWN_TICKS) {
+			snapshot->ball_visible = 1;
+			snapshot->ball_x = BALL_X_ORIGIN;
+			snapshot->ball_y = BALL_Y_ORIGIN;
 
 			g_game_sleep_counter = 0;
 			g_game_sleep = 0;
 			g_game_active = 1;
 		}
 	}
+	// The match is over. Once the result has been on the screen for a while, the main loop puts the board to sleep.
+	else if (g_winner_message != 0) {
+		g_match_over_ticks++;
+
+		if (g_match_over_ticks == MATCH_OVER_TICKS) {
+			g_match_over_ticks = 0;
+			g_deep_sleep_requested = 1;
+		}
+	}
+}
+
+// Returns the number of ticks that were lost since the last tick started, because something held up the
+// systick handler for longer than a tick.
+unsigned long TickDeadlineCheck(unsigned long tick_start) {
+	unsigned long lost = 0;
+
+	// The tick was stopped during deep sleep, or the clock was switched, so the first tick after it has nothing
+	// to measure from
+	if (g_tick_resync == 1) {
+		g_tick_resync = 0;
+	}
+	else if (g_game_ticks != 0) {
+		unsigned long interval = (tick_start - g_tick_last_start) & 0xffffffff;
+
+		if (interval > g_tick_cycles + g_tick_cycles / 2) {
+			lost = (interval + g_tick_cycles / 2) / g_tick_cycles - 1;
+			g_tick_overruns++;
+			g_ticks_lost += lost;
+		}
+	}
+	g_tick_last_start = tick_start;
+
+	return lost;
+}
+
+// Works out the CPU load over the last second from the time the main loop spent asleep, which is everything that
+// wasn't spent in an interrupt handler.
+void CpuLoadUpdate(void) {
+	unsigned long sleep_cycles = HalSleepCycles();
+	unsigned long asleep = (sleep_cycles - g_load_sleep_last) & 0xffffffff;
+	unsigned long second = g_tick_cycles * TICKS_PER_SECOND;
+
+	g_load_sleep_last = sleep_cycles;
+
+	if (asleep > second) {
+		asleep = second;
+	}
+
+	g_cpu_load = 1000 - asleep / (second / 1000);
+	if (g_cpu_load > g_cpu_load_peak) {
+		g_cpu_load_peak = g_cpu_load;
+	}
+
+	TraceEvent(TRACE_LOAD, 0, g_cpu_load);
+}
+
+// Works out which phase the game is in, for the clock policy.
+unsigned long ClockPhase(void) {
+	if (g_game_active == 1) {
+		return CLOCK_PHASE_PLAY;
+	}
+	else if (g_game_sleep == 1) {
+		return CLOCK_PHASE_COUNTDOWN;
+	}
+
+	return CLOCK_PHASE_OVER;
+}
+
+// Catches up with a new processor clock: the cycle counter counts at a different rate from now on, so the tick
+// period in cycles is worked out again, and the interval the next tick and the CPU load are measured over start
+// again. It is called with interrupts turned off, so the next tick can't see the counts half changed.
+void ClockChanged(void) {
+	g_tick_cycles = HalClockGet() / TICKS_PER_SECOND;
+	g_tick_resync = 1;
+	g_load_ticks = 0;
+	g_load_sleep_last = HalSleepCycles();
+}
+
+// The entire game runs on systick intervals.
+// If ticks were lost, the game is stepped for them too, so that the game keeps to time; only the drawing is
+// ever skipped.
+//
+// Nothing is drawn here. The tick ends by publishing a snapshot of the game for the PendSV handler to draw.
+void SysTickIntHandler(void) {
+
+	TraceIsrEnter(TRACE_ISR_SYSTICK);
+
+	BootMark(BOOT_FIRST_TICK);
+
+	unsigned long profile_tick = HalCycleCount();
+
+	unsigned long steps = 1 + TickDeadlineCheck(profile_tick);
+	if (steps > 1 + MAX_CATCHUP_STEPS) {
+		steps = 1 + MAX_CATCHUP_STEPS;
+	}
+
+	// Fill in the snapshot that the PendSV handler isn't drawing from.
+	GameSnapshot *snapshot = &g_snapshots[1 - g_snapshot_drawing];
+
+	while (steps != 0) {
+		GameStep(snapshot);
+		steps--;
+	}
+
+	PublishSnapshot(snapshot);
+
+	ClockPolicyTick(ClockPhase());
+
+	g_load_ticks++;
+	if (g_load_ticks == TICKS_PER_SECOND) {
+		g_load_ticks = 0;
+		CpuLoadUpdate();
+	}
+
+	ProfileRecord(PROFILE_TICK, profile_tick);
+
+	TraceIsrExit(TRACE_ISR_SYSTICK);
+}
+
+// Draws the newest game state snapshot on the display.
+// This runs at the lowest interrupt priority, so the systick and button handlers can interrupt it at any time.
+void PendSVIntHandler(void) {
+
+	TraceIsrEnter(TRACE_ISR_PENDSV);
+
+	// Claim the newest snapshot. From here on the systick handler fills in the other one.
+	g_snapshot_drawing = g_snapshot_latest;
+	g_snapshot_pending = 0;
+
+	DrawFrame(&g_snapshots[g_snapshot_drawing]);
+
+	// The boot is over once the first frame is on the display. Wait for it to be sent, so that it can be timed.
+	if (!BootMarked(BOOT_FIRST_FRAME)) {
+		RIT128x96x4Wait();
+		BootMark(BOOT_FIRST_FRAME);
+	}
+
+	TraceIsrExit(TRACE_ISR_PENDSV);
+}
+
+// Prints how many frames and ticks missed their deadlines, the CPU load, the time spent at each clock, how long
+// the boot took, and how much of the stack has been used.
+// The host calls this at the end of a run; on the board it is printed with the event trace.
+void GameReport(void) {
+	HalPrintf("frames: %u drawn, %u skipped, %u overran, %u degraded\n", g_frames_drawn, g_frames_skipped,
+		g_frames_overrun, g_frames_degraded);
+	HalPrintf("ticks: %u run, %u overran, %u lost\n", g_game_ticks, g_tick_overruns, g_ticks_lost);
+
+	HalPrintf("cpu: %u.%u%% load, %u.%u%% peak, %u deep sleeps\n", g_cpu_load / 10, g_cpu_load % 10,
+		g_cpu_load_peak / 10, g_cpu_load_peak % 10, g_deep_sleeps);
+
+	ClockPolicyReport(HalPrintf);
+
+	BootReport(HalPrintf);
+
+	unsigned long stack_size;
+	unsigned long stack_used = HalStackUsed(&stack_size);
+	if (stack_size != 0) {
+		HalPrintf("stack: %u of %u bytes used\n", stack_used, stack_size);
+	}
+}
+
+// Reports how the current match is going, or how it went if it is over.
+void MatchStatsGet(MatchStats *stats) {
+	stats->over = g_winner_message != 0;
+	stats->player_score = g_player_score;
+	stats->opponent_score = g_opponent_score;
+	stats->ticks = (stats->over ? g_match_end_tick : g_game_ticks) - g_match_start_tick;
+	stats->rallies = g_match_rallies;
+	stats->hits = g_match_hits;
+	stats->longest_rally = g_match_longest_rally;
+}
+
+// Starts a new match from the next tick, with the ball and bounce boards back where they start.
+// The board only ever plays one match; the host simulators play one after another. It must not be called while
+// the systick handler could run.
+void MatchRestart(void) {
+	g_player_y_axis_counter = Y_MAX / 2;
+	g_opponent_y_axis_counter = Y_MAX / 2;
+	g_opponent_y_direction = OPPONENT_DIRECTION_UP;
+
+	g_ball_y_axis_counter = INT_TO_FIXED(BALL_Y_ORIGIN);
+	g_ball_x_axis_counter = BALL_X_ORIGIN;
+	g_ball_x_step = BALL_X_SPEED;
+	g_ball_y_step = 0;
+	g_ball_x_direction = BALL_DIRECTION_LEFT;
+	g_ball_y_direction = BALL_DIRECTION_UP;
+	g_opponent_aim_update = OPPONENT_AIM_NEW;
+	g_opponent_react_ticks = 0;
+
+	g_game_active = 1;
+	g_game_sleep = 0;
+	g_game_sleep_counter = 0;
+	g_player_score = 0;
+	g_opponent_score = 0;
+	g_winner_message = 0;
+	g_match_over_ticks = 0;
+	g_profile_shown = 0;
+	g_deep_sleep_requested = 0;
+
+	// Presses from the last match don't carry over
+	g_input_tail = g_input_head;
+
+	g_match_start_tick = g_game_ticks;
+	g_match_end_tick = 0;
+	g_rally_hits = 0;
+	g_match_rallies = 0;
+	g_match_hits = 0;
+	g_match_longest_rally = 0;
+}
+
+// Sets the opponent's lottery odds and tracking band, for the host's tuner, in place of the difficulty profile.
+// They take effect from the next tick.
+void OpponentOddsSet(const OpponentOdds *odds) {
+	OpponentProfileFromOdds(&g_opponent_custom, odds);
+	g_opponent_profile = &g_opponent_custom;
+}
+
+// Works out the thresholds that the lottery uses for the given odds, as the profile table's are worked out.
+void OpponentProfileFromOdds(OpponentProfile *profile, const OpponentOdds *odds) {
+	profile->invincible = OPPONENT_THRESHOLD(odds->invincible);
+	profile->turn = OPPONENT_THRESHOLD(odds->linear + 1);
+	profile->band = odds->band;
+}
+
+// Picks the predicting opponent with the given difficulty, or the lottery again if aim is 0. It takes effect
+// from the next tick, with the bounce board aimed afresh.
+void OpponentAimSet(const OpponentAim *aim) {
+	if (aim != 0) {
+		g_opponent_aim = *aim;
+		g_opponent_predict = 1;
+	}
+	else {
+		g_opponent_predict = 0;
+	}
+	g_opponent_aim_update = OPPONENT_AIM_NEW;
+}
+
+// Fills in what the player can see, for the host's simulated players.
+void PlayerViewGet(PlayerView *view) {
+	view->player_x = g_player_x_axis_counter + X_WALL_SPACER;
+	view->player_y = g_player_y_axis_counter;
+	view->ball_x = g_ball_x_axis_counter;
+	view->ball_y = FIXED_TO_INT(g_ball_y_axis_counter);
+	view->ball_x_step = g_ball_x_step;
+	view->ball_y_step = g_ball_y_direction == BALL_DIRECTION_UP ? -g_ball_y_step : g_ball_y_step;
+	view->ball_in_play = g_game_active;
+	view->ball_incoming = g_ball_x_direction == BALL_DIRECTION_LEFT;
+}
+
+// Keeps track of the deepest the stack has been used, which can only be found from the main loop.
+void StackCheck(void) {
+	unsigned long stack_size;
+	unsigned long stack_used = HalStackUsed(&stack_size);
+
+	if (stack_used > g_stack_high_water) {
+		g_stack_high_water = stack_used;
+		TraceEvent(TRACE_STACK, 0, stack_used);
+
+		if (g_stack_warned == 0 && stack_used * 100 > stack_size * STACK_WARN_PERCENT) {
+			g_stack_warned = 1;
+			HalPrintf("stack: %u of %u bytes used\n", stack_used, stack_size);
+		}
+	}
+}
+
+
+// Sets up everything the game keeps for itself, ready for the first tick. The host's tuner calls this on each of
+// its threads, which have their own copy of the game.
+void GameInit(void) {
+    //
+    // Set up the sprites for the ball and the bounce boards.
+    //
+    RIT128x96x4SpriteInit(&g_ball_sprite, g_ball_image, SPRITE_WIDTH, SPRITE_HEIGHT);
+    RIT128x96x4SpriteInit(&g_player_sprite, g_board_image, SPRITE_WIDTH, SPRITE_HEIGHT);
+    RIT128x96x4SpriteInit(&g_opponent_sprite, g_board_image, SPRITE_WIDTH, SPRITE_HEIGHT);
+
+    //
+    // Start timing the phases of the game from a clean slate.
+    //
+    ProfileInit(g_profile_names, PROFILE_PHASE_COUNT);
+
+    //
+    // Record the handlers and phases in the event trace.
+    //
+    TraceInit(g_trace_isr_names, TRACE_ISR_COUNT, g_profile_names, PROFILE_PHASE_COUNT);
+
+    //
+    // Pick the processor clock for each phase of the game.
+    //
+    ClockPolicyInit(g_clock_phase_levels, CLOCK_PHASE_COUNT);
+
+    //
+    // Run the game 50 times a second, and draw it at a lower priority.
+    //
+    g_tick_cycles = HalClockGet() / TICKS_PER_SECOND;
+    HalTimerInit(TICKS_PER_SECOND);
+    HalRenderInit();
 }
 
 
@@ -534,67 +1438,70 @@ __error__(char *pcFilename, unsigned long ulLine)
 //
 //*****************************************************************************
 int main(void) {
-	volatile int iDelay;
+
+    BootMark(BOOT_MAIN);
 
     //
-    // Set the clocking to run directly from the crystal.
-    //
-    //
-    // Set the clocking to /run at 50MHz from the PLL.
-    //
-    SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
-                   SYSCTL_XTAL_8MHZ);
-    //
-    // Get the system clock speed.
+    // Set the clocking to run at 50MHz from the PLL.
     //
-    g_ulSystemClock = SysCtlClockGet();
+    HalInit();
+    BootMark(BOOT_CLOCK);
 
     //
-    // Enable the peripherals used by this example.
+    // Set up the push buttons.
     //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    HalInputInit();
 
     //
-    // Configure the push button as an input and enable the pin to interrupt on
-    // the falling edge (i.e. when the push button is pressed).
+    // Initialize the OLED display.
     //
-    GPIOPinTypeGPIOInput(GPIO_PORTE_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
-    GPIOPadConfigSet(GPIO_PORTE_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3, GPIO_STRENGTH_2MA,
-                     GPIO_PIN_TYPE_STD_WPU);
-    GPIOIntTypeSet(GPIO_PORTE_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3, GPIO_FALLING_EDGE);
-    GPIOPinIntEnable(GPIO_PORTE_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
-    IntEnable(INT_GPIOE);
+    HalDisplayInit();
+    BootMark(BOOT_DISPLAY);
 
     //
-    // Initialize the OLED display and write status.
+    // Only count the SSI bus activity of the game's frames, not starting up the display.
     //
-    RIT128x96x4Init(1000000);
+    RIT128x96x4BusStatsReset();
+    RIT128x96x4BusSectionSet(BUS_SECTION_FRAME, "frame");
 
     //
-    // Set up and enable the SysTick timer.  It will be used as a reference
-    // for delay loops in the interrupt handlers.  The SysTick timer period
-    // will be set up for one second.
+    // Set up the game.
     //
-    SysTickPeriodSet(g_ulSystemClock / 50 );
-
-
-    SysTickIntEnable();
-
-    SysTickEnable();
-
+    GameInit();
 
     //
-    // Enable interrupts to the processor.
+    // Start the game.
     //
-    IntMasterEnable();
+    HalStart();
+    BootMark(BOOT_START);
 
     //
-    // Enable the interrupts.
+    // Sleep between interrupts.
     //
-    IntEnable(INT_GPIOE);
-
     while(1)
     {
+    	HalIdle();
+
+    	StackCheck();
+
+    	// Switch the clock if the game has moved to a phase that wants a different one
+    	unsigned long state = HalCriticalEnter();
+    	if (ClockPolicyApply()) {
+    		ClockChanged();
+    	}
+    	HalCriticalExit(state);
+
+    	if (g_deep_sleep_requested == 1) {
+    		g_deep_sleep_requested = 0;
+    		g_deep_sleeps++;
+    		g_tick_resync = 1;
+    		HalDeepSleep();
+    	}
 
+    	if (g_trace_dump_requested == 1) {
+    		g_trace_dump_requested = 0;
+    		GameReport();
+    		TraceDump(HalPrintf);
+    	}
     }
 }
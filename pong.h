@@ -0,0 +1,209 @@
+//*****************************************************************************
+//
+// pong.h - The parts of the game that the host simulators drive directly.
+//
+// On the board the hardware calls the interrupt handlers through the vector
+// table.  On the host they are called one after another by the simulators,
+// which also start new matches and read how each one went.  The tuner also
+// sets up a copy of the game on each of its threads with GameInit(), and
+// changes the opponent's odds.  The game's rules are here too, for the tuner's
+// batched kernel, which plays many games at once by the same rules.
+//
+//*****************************************************************************
+
+#ifndef __PONG_H__
+#define __PONG_H__
+
+//*****************************************************************************
+//
+// The rules of the game.  They are here rather than in pong.c so that the
+// host's batched kernel (see host/sim/batch.c) plays by the same ones.
+//
+//*****************************************************************************
+
+// Grid
+#define X_MIN 0
+#define X_MAX 120
+#define Y_MIN 0
+#define Y_MAX 88
+#define X_WALL_SPACER 5
+
+// Match
+// The first to win MATCH_POINTS points wins the match. The countdown between points lasts COUNTDOWN_TICKS ticks.
+#define MATCH_POINTS 10
+#define COUNTDOWN_TICKS 100
+
+// Bounce boards
+// Each button press moves the player bounce board PLAYER_Y_STEP rows.
+#define PLAYER_Y_STEP 4
+#define BOARD_TOLERANCE 7
+#define BOARD_SHALLOW_ANGLE_OFFSET 3
+
+// Ball
+#define BALL_DIRECTION_UP 0
+#define BALL_DIRECTION_DOWN 1
+#define BALL_DIRECTION_LEFT 0
+#define BALL_DIRECTION_RIGHT 1
+
+#define BALL_X_ORIGIN 60
+#define BALL_Y_ORIGIN 44
+
+// Number of columns the ball moves along the x-axis every tick.
+// Collisions are swept along the ball's whole path for the tick, so this can be raised without the ball
+// passing through a bounce board. It must not be more than X_WALL_SPACER.
+#define BALL_X_SPEED 1
+
+// Fixed point
+// The ball's y-axis position and step are kept in Q16.16 fixed point: the upper 16 bits are whole pixels
+// and the lower 16 bits are the fraction of a pixel. The LM3S8962 has no floating point unit, so this keeps
+// the compiler's software floating point routines out of the systick handler.
+#define FIXED_SHIFT 16
+#define INT_TO_FIXED(x) ((x) << FIXED_SHIFT)
+#define FIXED_TO_INT(x) ((x) >> FIXED_SHIFT)
+
+// Ball y-axis steps for the bounce angles.
+// 0.2 can't be represented exactly, so it is rounded up the same way the single precision float it replaces was.
+#define BALL_Y_STEP_WIDE 49152 // 0.75
+#define BALL_Y_STEP_SHALLOW 13108 // 0.2
+
+// AI
+#define OPPONENT_DIRECTION_UP 0
+#define OPPONENT_DIRECTION_DOWN 1
+
+// The opponent's lottery odds and tracking band, which were picked by playing the game (see OpponentMovement).
+// The host's tuner plays them against each other with OpponentOddsSet.
+#define OPPONENT_INVINCIBLE_ODDS 70
+#define OPPONENT_LINEAR_ODDS 95
+#define OPPONENT_TRACK_BAND 4
+
+// Difficulty profiles
+// Each profile is the odds of OpponentOdds (invincible, linear, band), as the host's tuner suggested them for its
+// difficulty levels with the linear odds kept at 95; for normal it suggested the odds above. Its tracking player
+// wins about 75%, 35%, 15% and 2% of the matches against them. The game starts with OPPONENT_PROFILE, and the right
+// button steps through them.
+#define OPPONENT_PROFILE_EASY 0
+#define OPPONENT_PROFILE_NORMAL 1
+#define OPPONENT_PROFILE_HARD 2
+#define OPPONENT_PROFILE_INSANE 3
+#define OPPONENT_PROFILE_COUNT 4
+
+#define OPPONENT_EASY_ODDS 62, 95, 4
+#define OPPONENT_NORMAL_ODDS OPPONENT_INVINCIBLE_ODDS, OPPONENT_LINEAR_ODDS, OPPONENT_TRACK_BAND
+#define OPPONENT_HARD_ODDS 75, 95, 4
+#define OPPONENT_INSANE_ODDS 81, 95, 4
+
+#ifndef OPPONENT_PROFILE
+#define OPPONENT_PROFILE OPPONENT_PROFILE_NORMAL
+#endif
+
+// Lottery votes
+// A vote is 8 bits of a random number, bits 7 to 14, which are the top 8 of the 15 bits that rand() always gives.
+// The odds out of 100 are turned into thresholds out of 256 when the game is built, so that taking a vote is a
+// shift, a mask and a compare. A threshold of 256 always wins, and one of 0 never does.
+#define OPPONENT_VOTE(random) ((((unsigned int)(random)) >> 7) & 0xff)
+#define OPPONENT_THRESHOLD(odds) (((odds) * 256 + 50) / 100)
+
+// The predicting opponent, which plays instead of the lottery when the game is built with OPPONENT_PREDICT
+// defined, or once OpponentAimSet is called (see OpponentPredictMovement). It aims up to OPPONENT_AIM_ERROR rows
+// away from where the ball will reach it, and waits OPPONENT_AIM_DELAY ticks after the ball is hit before it moves.
+// The board only stops the ball within 6 rows of its middle, and BallInterceptY gives exactly the row that
+// CollisionDetector checks, so an error of 6 or less never misses on its own and the delay decides how often it gets
+// there too late. With a delay of 71 it never misses; these win a little under half the matches against host/sim's
+// player.
+#define OPPONENT_AIM_ERROR 6
+#define OPPONENT_AIM_DELAY 72
+
+//*****************************************************************************
+//
+// How a match went.  A rally is the number of times the ball was hit by a
+// bounce board before a point was won.  The ticks only count the match itself,
+// up to the winning point, and not the result being shown after it.
+//
+//*****************************************************************************
+typedef struct {
+	unsigned int over;
+	unsigned int player_score;
+	unsigned int opponent_score;
+	unsigned long ticks;
+	unsigned long rallies;
+	unsigned long hits;
+	unsigned long longest_rally;
+} MatchStats;
+
+//*****************************************************************************
+//
+// The odds of the opponent's lottery votes, out of 100.  A vote below
+// invincible plays the ball perfectly, and otherwise a second vote above
+// linear turns the bounce board around.  While playing perfectly, the bounce
+// board moves towards the ball once it is more than band rows from it.
+//
+//*****************************************************************************
+typedef struct {
+	unsigned int invincible;
+	unsigned int linear;
+	unsigned int band;
+} OpponentOdds;
+
+//*****************************************************************************
+//
+// The opponent's odds as the lottery uses them, out of 256 (see
+// OPPONENT_VOTE).  A vote below invincible plays the ball perfectly, and
+// otherwise a second vote of turn or more turns the bounce board around.
+//
+//*****************************************************************************
+typedef struct {
+	unsigned short invincible;
+	unsigned short turn;
+	unsigned int band;
+} OpponentProfile;
+
+//*****************************************************************************
+//
+// The difficulty of the predicting opponent.  It works out where the ball will
+// reach it once for each bounce, and aims up to error rows away from there,
+// chosen at random each time the ball is hit.  After the ball is hit, it waits
+// delay ticks before it moves.
+//
+//*****************************************************************************
+typedef struct {
+	unsigned int error;
+	unsigned int delay;
+} OpponentAim;
+
+//*****************************************************************************
+//
+// What the player can see, for simulated players: the player bounce board and
+// the ball in whole pixels, how far the ball moves each tick, and whether it
+// is in play and coming towards the player.  ball_y_step is in Q16.16 fixed
+// point, and is negative while the ball is going up.
+//
+//*****************************************************************************
+typedef struct {
+	unsigned int player_x;
+	unsigned int player_y;
+	unsigned int ball_x;
+	unsigned int ball_y;
+	unsigned int ball_x_step;
+	int ball_y_step;
+	unsigned int ball_in_play;
+	unsigned int ball_incoming;
+} PlayerView;
+
+//*****************************************************************************
+//
+// Prototypes for the game.
+//
+//*****************************************************************************
+extern void SysTickIntHandler(void);
+extern void GPIOEIntHandler(void);
+extern void PendSVIntHandler(void);
+extern void GameInit(void);
+extern void GameReport(void);
+extern void MatchStatsGet(MatchStats *stats);
+extern void MatchRestart(void);
+extern void OpponentOddsSet(const OpponentOdds *odds);
+extern void OpponentProfileFromOdds(OpponentProfile *profile, const OpponentOdds *odds);
+extern void OpponentAimSet(const OpponentAim *aim);
+extern void PlayerViewGet(PlayerView *view);
+
+#endif // __PONG_H__
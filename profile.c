@@ -0,0 +1,164 @@
+//*****************************************************************************
+//
+// profile.c - Cycle count profiling of the phases of the game.
+//
+// Each phase is bracketed with reads of the cycle counter from HalCycleCount()
+// and recorded with ProfileRecord(), which keeps the count, the fewest, total
+// and most cycles, and a log2 histogram in SRAM.  A phase that is preempted
+// by a higher priority interrupt is charged for the cycles of the interrupt
+// too.
+//
+// ProfileRecord() returns a fresh read of the cycle counter, so that the next
+// phase can be started without charging it for the time taken to record the
+// last one:
+//
+//     ulStart = HalCycleCount();
+//     PhaseOne();
+//     ulStart = ProfileRecord(PHASE_ONE, ulStart);
+//     PhaseTwo();
+//     ProfileRecord(PHASE_TWO, ulStart);
+//
+// Every run is also recorded in the event trace (trace.c), so that the phases
+// can be seen in the order they ran.
+//
+//*****************************************************************************
+
+#include "hal.h"
+#include "profile.h"
+#include "trace.h"
+
+//*****************************************************************************
+//
+// The profile of each phase.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL tProfilePhase g_psProfile[PROFILE_PHASES];
+
+//*****************************************************************************
+//
+// Clears all of the profiles, and names the phases that will be used.
+// ppcNames holds the names of phases 0 to ulPhases - 1.
+//
+//*****************************************************************************
+void
+ProfileInit(const char * const *ppcNames, unsigned long ulPhases)
+{
+    unsigned long ulPhase, ulBucket;
+
+    for(ulPhase = 0; ulPhase < PROFILE_PHASES; ulPhase++)
+    {
+        g_psProfile[ulPhase].pcName = (ulPhase < ulPhases) ?
+                                      ppcNames[ulPhase] : 0;
+        g_psProfile[ulPhase].ulCount = 0;
+        g_psProfile[ulPhase].ulMin = 0xffffffff;
+        g_psProfile[ulPhase].ullTotal = 0;
+        g_psProfile[ulPhase].ulMax = 0;
+        for(ulBucket = 0; ulBucket < PROFILE_BUCKETS; ulBucket++)
+        {
+            g_psProfile[ulPhase].pulHistogram[ulBucket] = 0;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Records one run of a phase that started when the cycle counter read
+// ulStart.  Returns the cycle counter after the run has been recorded.
+//
+//*****************************************************************************
+unsigned long
+ProfileRecord(unsigned long ulPhase, unsigned long ulStart)
+{
+    tProfilePhase *psPhase;
+    unsigned long ulCycles, ulBucket, ulValue;
+
+    //
+    // The counter is 32 bits on the board, so take the difference in 32 bits
+    // to allow for it wrapping.
+    //
+    ulCycles = (HalCycleCount() - ulStart) & 0xffffffff;
+
+    psPhase = &g_psProfile[ulPhase];
+    psPhase->ulCount++;
+    psPhase->ullTotal += ulCycles;
+    if(ulCycles < psPhase->ulMin)
+    {
+        psPhase->ulMin = ulCycles;
+    }
+    if(ulCycles > psPhase->ulMax)
+    {
+        psPhase->ulMax = ulCycles;
+    }
+
+    //
+    // Find the histogram bucket, which is the position of the highest set
+    // bit.
+    //
+    ulBucket = 0;
+    for(ulValue = ulCycles >> 1; ulValue != 0; ulValue >>= 1)
+    {
+        ulBucket++;
+    }
+    if(ulBucket >= PROFILE_BUCKETS)
+    {
+        ulBucket = PROFILE_BUCKETS - 1;
+    }
+    psPhase->pulHistogram[ulBucket]++;
+
+    TracePhase(ulPhase, ulStart, ulCycles);
+
+    return(HalCycleCount());
+}
+
+//*****************************************************************************
+//
+// Returns the profile of a phase.
+//
+//*****************************************************************************
+const tProfilePhase *
+ProfilePhaseGet(unsigned long ulPhase)
+{
+    return(&g_psProfile[ulPhase]);
+}
+
+//*****************************************************************************
+//
+// Prints the profile of every phase that has run: the number of runs, the
+// fewest, average and most cycles, and the buckets of the histogram that are
+// not empty, each given by its lowest number of cycles.  The names are padded
+// on the right to twelve characters, the way UARTprintf() pads strings.
+//
+//*****************************************************************************
+void
+ProfileReport(tProfilePrintf pfnPrintf)
+{
+    const tProfilePhase *psPhase;
+    unsigned long ulPhase, ulBucket;
+
+    pfnPrintf("phase           count      min      avg      max\n");
+
+    for(ulPhase = 0; ulPhase < PROFILE_PHASES; ulPhase++)
+    {
+        psPhase = &g_psProfile[ulPhase];
+        if(!psPhase->pcName || (psPhase->ulCount == 0))
+        {
+            continue;
+        }
+
+        pfnPrintf("%12s %8u %8u %8u %8u\n", psPhase->pcName,
+                  psPhase->ulCount, psPhase->ulMin,
+                  (unsigned long)(psPhase->ullTotal / psPhase->ulCount),
+                  psPhase->ulMax);
+
+        pfnPrintf("%12s", "");
+        for(ulBucket = 0; ulBucket < PROFILE_BUCKETS; ulBucket++)
+        {
+            if(psPhase->pulHistogram[ulBucket] != 0)
+            {
+                pfnPrintf(" %u:%u", ulBucket ? (1UL << ulBucket) : 0,
+                          psPhase->pulHistogram[ulBucket]);
+            }
+        }
+        pfnPrintf("\n");
+    }
+}
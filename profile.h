@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// profile.h - Cycle count profiling of the phases of the game.
+//
+//*****************************************************************************
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+//*****************************************************************************
+//
+// The most phases that can be profiled, and the number of buckets in the
+// histogram of each phase.  Bucket n counts the samples of 2^n to 2^(n+1) - 1
+// cycles, except that bucket 0 also counts samples of 0 cycles and the last
+// bucket counts everything longer.
+//
+//*****************************************************************************
+#define PROFILE_PHASES          16
+#define PROFILE_BUCKETS         24
+
+//*****************************************************************************
+//
+// The profile of one phase.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The name of the phase, or 0 if it is not used.
+    //
+    const char *pcName;
+
+    //
+    // The number of times the phase ran, and the fewest, total and most
+    // cycles it took.
+    //
+    unsigned long ulCount;
+    unsigned long ulMin;
+    unsigned long long ullTotal;
+    unsigned long ulMax;
+
+    //
+    // The log2 histogram of the cycles it took.
+    //
+    unsigned long pulHistogram[PROFILE_BUCKETS];
+}
+tProfilePhase;
+
+//*****************************************************************************
+//
+// The function that the report is printed with, such as UARTprintf().  Only
+// the %s and %u conversions, with a field width, are used, and %u is passed
+// unsigned long values.
+//
+//*****************************************************************************
+typedef void (*tProfilePrintf)(const char *pcFormat, ...);
+
+//*****************************************************************************
+//
+// Prototypes for the profiler.
+//
+//*****************************************************************************
+extern void ProfileInit(const char * const *ppcNames, unsigned long ulPhases);
+extern unsigned long ProfileRecord(unsigned long ulPhase,
+                                   unsigned long ulStart);
+extern const tProfilePhase *ProfilePhaseGet(unsigned long ulPhase);
+extern void ProfileReport(tProfilePrintf pfnPrintf);
+
+#endif // __PROFILE_H__
@@ -22,6 +22,8 @@
 //
 //*****************************************************************************
 
+#include "hal.h"
+
 //*****************************************************************************
 //
 // Forward declaration of the default fault handlers.
@@ -40,13 +42,16 @@ static void IntDefaultHandler(void);
 //*****************************************************************************
 extern void _c_int00(void);
 extern void SysTickIntHandler(void);
+extern void PendSVIntHandler(void);
 extern void GPIOEIntHandler(void);
+extern void RIT128x96x4IntHandler(void);
 
 //*****************************************************************************
 //
-// Linker variable that marks the top of the stack.
+// Linker variables that mark the bottom and top of the stack.
 //
 //*****************************************************************************
+extern unsigned long __stack;
 extern unsigned long __STACK_TOP;
 
 
@@ -76,7 +81,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
+    PendSVIntHandler,                       // The PendSV handler
     SysTickIntHandler,                      // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
@@ -85,7 +90,7 @@ void (* const g_pfnVectors[])(void) =
     GPIOEIntHandler,                      // GPIO Port E
     IntDefaultHandler,                      // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
-    IntDefaultHandler,                      // SSI0 Rx and Tx
+    RIT128x96x4IntHandler,                  // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
     IntDefaultHandler,                      // PWM Fault
     IntDefaultHandler,                      // PWM Generator 0
@@ -137,6 +142,24 @@ void (* const g_pfnVectors[])(void) =
 void
 ResetISR(void)
 {
+    unsigned long *pulStack;
+
+    //
+    // Start the cycle counter, so that the boot is timed from here.
+    //
+    HalCycleCountStart();
+
+    //
+    // Paint the stack below this function's own frame, so that HalStackUsed()
+    // can find the deepest it has been used.  The address of pulStack is in
+    // that frame, and nothing below it is in use yet.
+    //
+    for(pulStack = &__stack; pulStack < (unsigned long *)&pulStack;
+        pulStack++)
+    {
+        *pulStack = HAL_STACK_PAINT;
+    }
+
     //
     // Jump to the CCS C initialization routine.
     //
@@ -0,0 +1,173 @@
+//*****************************************************************************
+//
+// trace.c - Event trace of the game's interrupt handlers and phases.
+//
+// The profile (profile.c) only keeps totals, so it can't show the order that
+// things happened in, such as the button handler preempting a half-finished
+// draw.  The trace keeps the last TRACE_EVENTS events in a ring buffer in
+// SRAM, each stamped with the cycle counter: interrupt handler entry and exit,
+// the profiled phases, the bytes flushed to the display each frame and the
+// button presses.
+//
+// Events can be recorded from any interrupt priority.  Each one takes a slot
+// in the ring with interrupts turned off for a few instructions, so an event
+// that preempts another can't take the same slot.
+//
+// TraceDump() prints the events as text that host/tools/trace2json.c turns
+// into a Chrome trace, which can be opened in Perfetto or chrome://tracing.
+// The dump looks like:
+//
+//     trace begin 512 events, 1210 lost
+//     isr 0 systick
+//     phase 0 tick
+//     00a3f1c2 10000000
+//     ...
+//     trace end
+//
+// where each event is its time then its type, ID and argument, in hex.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "hal.h"
+#include "trace.h"
+
+//*****************************************************************************
+//
+// The ring buffer of events.  g_ulTraceHead counts every event ever recorded;
+// the newest event is in the slot before it.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL tTraceEvent g_psTrace[TRACE_EVENTS];
+static HAL_THREAD_LOCAL volatile unsigned long g_ulTraceHead;
+static HAL_THREAD_LOCAL volatile tBoolean g_bTraceEnabled;
+
+//*****************************************************************************
+//
+// The names of the interrupt handlers and the phases, which are printed with
+// the dump.
+//
+//*****************************************************************************
+static HAL_THREAD_LOCAL const char * const *g_ppcTraceIsrNames;
+static HAL_THREAD_LOCAL unsigned long g_ulTraceIsrs;
+static HAL_THREAD_LOCAL const char * const *g_ppcTracePhaseNames;
+static HAL_THREAD_LOCAL unsigned long g_ulTracePhases;
+
+//*****************************************************************************
+//
+// Records one event that happened at ulTime.
+//
+//*****************************************************************************
+static void
+TraceWrite(unsigned long ulTime, unsigned long ulType, unsigned long ulId,
+           unsigned long ulArg)
+{
+    tTraceEvent *psEvent;
+    unsigned long ulState;
+
+    if(!g_bTraceEnabled)
+    {
+        return;
+    }
+
+    if(ulArg > TRACE_ARG_MAX)
+    {
+        ulArg = TRACE_ARG_MAX;
+    }
+
+    //
+    // Take the next slot and fill it in without being interrupted, so that a
+    // dump never sees a slot that is half written.
+    //
+    ulState = HalCriticalEnter();
+    psEvent = &g_psTrace[g_ulTraceHead & (TRACE_EVENTS - 1)];
+    g_ulTraceHead++;
+    psEvent->ulTime = ulTime & 0xffffffff;
+    psEvent->ulInfo = ((ulType << 28) | ((ulId & TRACE_ID_MAX) << 24) |
+                       ulArg);
+    HalCriticalExit(ulState);
+}
+
+//*****************************************************************************
+//
+// Clears the trace and starts recording.  ppcIsrNames holds the names of
+// interrupt handlers 0 to ulIsrs - 1 and ppcPhaseNames the names of phases 0
+// to ulPhases - 1.
+//
+//*****************************************************************************
+void
+TraceInit(const char * const *ppcIsrNames, unsigned long ulIsrs,
+          const char * const *ppcPhaseNames, unsigned long ulPhases)
+{
+    g_ppcTraceIsrNames = ppcIsrNames;
+    g_ulTraceIsrs = ulIsrs;
+    g_ppcTracePhaseNames = ppcPhaseNames;
+    g_ulTracePhases = ulPhases;
+
+    g_ulTraceHead = 0;
+    g_bTraceEnabled = true;
+}
+
+//*****************************************************************************
+//
+// Records an event that is happening now.
+//
+//*****************************************************************************
+void
+TraceEvent(unsigned long ulType, unsigned long ulId, unsigned long ulArg)
+{
+    TraceWrite(HalCycleCount(), ulType, ulId, ulArg);
+}
+
+//*****************************************************************************
+//
+// Records a phase that started when the cycle counter read ulStart and took
+// ulCycles cycles.  It is called from ProfileRecord(), once the phase is over.
+//
+//*****************************************************************************
+void
+TracePhase(unsigned long ulPhase, unsigned long ulStart,
+           unsigned long ulCycles)
+{
+    TraceWrite(ulStart, TRACE_PHASE, ulPhase, ulCycles);
+}
+
+//*****************************************************************************
+//
+// Prints the names and every event in the ring, oldest first, then clears the
+// trace.  Recording is paused while the events are printed, so this can be
+// called with the game running.
+//
+//*****************************************************************************
+void
+TraceDump(tTracePrintf pfnPrintf)
+{
+    unsigned long ulIdx, ulCount, ulHead;
+
+    g_bTraceEnabled = false;
+
+    ulHead = g_ulTraceHead;
+    ulCount = (ulHead < TRACE_EVENTS) ? ulHead : TRACE_EVENTS;
+
+    pfnPrintf("trace begin %u events, %u lost\n", ulCount, ulHead - ulCount);
+
+    for(ulIdx = 0; ulIdx < g_ulTraceIsrs; ulIdx++)
+    {
+        pfnPrintf("isr %u %s\n", ulIdx, g_ppcTraceIsrNames[ulIdx]);
+    }
+    for(ulIdx = 0; ulIdx < g_ulTracePhases; ulIdx++)
+    {
+        pfnPrintf("phase %u %s\n", ulIdx, g_ppcTracePhaseNames[ulIdx]);
+    }
+
+    for(ulIdx = ulHead - ulCount; ulIdx != ulHead; ulIdx++)
+    {
+        pfnPrintf("%08x %08x\n", g_psTrace[ulIdx & (TRACE_EVENTS - 1)].ulTime,
+                  g_psTrace[ulIdx & (TRACE_EVENTS - 1)].ulInfo);
+    }
+
+    pfnPrintf("trace end\n");
+
+    g_ulTraceHead = 0;
+    g_bTraceEnabled = true;
+}
@@ -0,0 +1,104 @@
+//*****************************************************************************
+//
+// trace.h - Event trace of the game's interrupt handlers and phases.
+//
+//*****************************************************************************
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+//*****************************************************************************
+//
+// The number of events kept in the trace buffer.  Once it is full, each new
+// event replaces the oldest one.  It must be a power of two.  Each event takes
+// eight bytes of SRAM on the board.
+//
+//*****************************************************************************
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS            512
+#endif
+
+//*****************************************************************************
+//
+// The types of event.  Each event has a type, an ID of up to 15 and an
+// argument of up to 24 bits.
+//
+// * TRACE_ISR_ENTER and TRACE_ISR_EXIT: interrupt handler ID was entered or
+//   left.  The argument is not used.
+// * TRACE_PHASE: profiled phase ID ran, starting at the event's time.  The
+//   argument is the number of cycles it took.
+// * TRACE_SSI: a frame was flushed to the display.  The argument is the
+//   number of bytes queued for the SSI.
+// * TRACE_INPUT: a button interrupt.  The argument is the buttons that were
+//   held down, and the ID is 1 if the press was dropped.
+// * TRACE_STACK: the stack reached a new high water mark.  The argument is the
+//   number of bytes used.
+// * TRACE_LOAD: the CPU load over the last second, in tenths of a percent.
+// * TRACE_CLOCK: the processor clock was switched to level ID.  The argument
+//   is the new clock in kHz, which the cycle counter counts at from then on.
+//
+//*****************************************************************************
+#define TRACE_ISR_ENTER         1
+#define TRACE_ISR_EXIT          2
+#define TRACE_PHASE             3
+#define TRACE_SSI               4
+#define TRACE_INPUT             5
+#define TRACE_STACK             6
+#define TRACE_LOAD              7
+#define TRACE_CLOCK             8
+
+//*****************************************************************************
+//
+// The limits of the ID and argument of an event.  Larger arguments are
+// clipped to TRACE_ARG_MAX.
+//
+//*****************************************************************************
+#define TRACE_ID_MAX            0x0f
+#define TRACE_ARG_MAX           0x00ffffff
+
+//*****************************************************************************
+//
+// One event.  ulInfo holds the type in bits 31 to 28, the ID in bits 27 to 24
+// and the argument in bits 23 to 0.  ulTime is the cycle counter when the
+// event happened, or when the phase started.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulTime;
+    unsigned long ulInfo;
+}
+tTraceEvent;
+
+//*****************************************************************************
+//
+// The function that the trace is dumped with, such as UARTprintf().  Only the
+// %s, %u and %08x conversions are used, and they are passed unsigned long
+// values.
+//
+//*****************************************************************************
+typedef void (*tTracePrintf)(const char *pcFormat, ...);
+
+//*****************************************************************************
+//
+// Marks the entry to and exit from an interrupt handler.
+//
+//*****************************************************************************
+#define TraceIsrEnter(ulIsr)    TraceEvent(TRACE_ISR_ENTER, (ulIsr), 0)
+#define TraceIsrExit(ulIsr)     TraceEvent(TRACE_ISR_EXIT, (ulIsr), 0)
+
+//*****************************************************************************
+//
+// Prototypes for the trace.
+//
+//*****************************************************************************
+extern void TraceInit(const char * const *ppcIsrNames, unsigned long ulIsrs,
+                      const char * const *ppcPhaseNames,
+                      unsigned long ulPhases);
+extern void TraceEvent(unsigned long ulType, unsigned long ulId,
+                       unsigned long ulArg);
+extern void TracePhase(unsigned long ulPhase, unsigned long ulStart,
+                       unsigned long ulCycles);
+extern void TraceDump(tTracePrintf pfnPrintf);
+
+#endif // __TRACE_H__